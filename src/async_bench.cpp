@@ -0,0 +1,150 @@
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+#include "async_task.hpp"
+
+//thread per camera against one coroutine scheduler driving all cameras:
+//async_bench [cameras] [operations per camera] [operation ms]
+//operations are simulated, each completes after a fixed camera latency, as a capture does before its download
+namespace {
+    using clock = std::chrono::steady_clock;
+    using namespace edsdk_w;
+
+    struct Result {
+        double wall_ms;
+        double cpu_ms;
+        double mean_lag_us; //from completion to the waiting code running again
+        double max_lag_us;
+        std::size_t threads;
+    };
+
+    double cpu_ms() {
+        return 1000.0 * static_cast<double>(std::clock()) / CLOCKS_PER_SEC;
+    }
+
+    Result thread_per_camera(std::size_t cameras, std::size_t operations, std::chrono::milliseconds latency) {
+        std::mutex mutex;
+        double lag_sum = 0, lag_max = 0;
+
+        auto cpu_start = cpu_ms();
+        auto start = clock::now();
+        std::vector<std::thread> threads{};
+        for (std::size_t c = 0; c < cameras; c++) {
+            threads.emplace_back([&] {
+                double sum = 0, max = 0;
+                for (std::size_t i = 0; i < operations; i++) {
+                    //blocking call returns when camera reports completion
+                    auto done_at = clock::now() + latency;
+                    std::this_thread::sleep_until(done_at);
+                    double lag = std::chrono::duration<double, std::micro>(clock::now() - done_at).count();
+                    sum += lag;
+                    max = std::max(max, lag);
+                }
+                std::lock_guard<std::mutex> lock{mutex};
+                lag_sum += sum;
+                lag_max = std::max(lag_max, max);
+            });
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+
+        auto count = static_cast<double>(cameras * operations);
+        return {std::chrono::duration<double, std::milli>(clock::now() - start).count(), cpu_ms() - cpu_start,
+                lag_sum / count, lag_max, cameras};
+    }
+
+    //stands in for the SDK: operations complete in order of their deadlines when the pump runs
+    struct SimulatedSdk {
+        struct Pending {
+            clock::time_point done_at;
+            bool *done;
+            bool operator>(const Pending &other) const { return done_at > other.done_at; }
+        };
+
+        std::priority_queue<Pending, std::vector<Pending>, std::greater<>> pending;
+
+        void pump() {
+            auto now = clock::now();
+            while (!pending.empty() && pending.top().done_at <= now) {
+                *pending.top().done = true;
+                pending.pop();
+            }
+        }
+    };
+
+    struct CameraTask {
+        double lag_sum = 0;
+        double lag_max = 0;
+    };
+
+    Task<void> drive(AsyncScheduler &scheduler, SimulatedSdk &sdk, CameraTask &stats,
+                     std::size_t operations, std::chrono::milliseconds latency) {
+        for (std::size_t i = 0; i < operations; i++) {
+            bool done = false;
+            auto done_at = clock::now() + latency;
+            sdk.pending.push({done_at, &done});
+            co_await scheduler.wait_until([&done] { return done; }, std::chrono::seconds{60});
+
+            double lag = std::chrono::duration<double, std::micro>(clock::now() - done_at).count();
+            stats.lag_sum += lag;
+            stats.lag_max = std::max(stats.lag_max, lag);
+        }
+    }
+
+    Result coroutines(std::size_t cameras, std::size_t operations, std::chrono::milliseconds latency) {
+        SimulatedSdk sdk{};
+        AsyncScheduler scheduler{[&sdk] { sdk.pump(); }};
+        std::vector<CameraTask> stats(cameras);
+
+        auto cpu_start = cpu_ms();
+        auto start = clock::now();
+        for (auto &camera : stats) {
+            scheduler.spawn(drive(scheduler, sdk, camera, operations, latency));
+        }
+        //pump interval of the batch runner
+        scheduler.run(std::chrono::microseconds{1000});
+
+        double lag_sum = 0, lag_max = 0;
+        for (const auto &camera : stats) {
+            lag_sum += camera.lag_sum;
+            lag_max = std::max(lag_max, camera.lag_max);
+        }
+        auto count = static_cast<double>(cameras * operations);
+        return {std::chrono::duration<double, std::milli>(clock::now() - start).count(), cpu_ms() - cpu_start,
+                lag_sum / count, lag_max, 1};
+    }
+
+    void print(const char *name, std::size_t cameras, std::size_t operations, const Result &res) {
+        std::cout << std::fixed << std::setprecision(1) << std::setw(18) << name << std::setw(8) << cameras
+                  << std::setw(9) << res.threads << std::setw(12) << res.wall_ms << std::setw(10) << res.cpu_ms
+                  << std::setw(12) << static_cast<double>(cameras * operations) / (res.wall_ms / 1000)
+                  << std::setw(12) << res.mean_lag_us << std::setw(12) << res.max_lag_us << std::endl;
+    }
+}
+
+int main(int argc, char **argv) {
+    std::vector<std::size_t> camera_counts{1, 8, 64, 512};
+    if (argc > 1) {
+        camera_counts = {std::stoul(argv[1])};
+    }
+    std::size_t operations = argc > 2 ? std::stoul(argv[2]) : 50;
+    std::chrono::milliseconds latency{argc > 3 ? std::stol(argv[3]) : 20};
+
+    std::cout << std::setw(18) << "driver" << std::setw(8) << "cameras" << std::setw(9) << "threads"
+              << std::setw(12) << "wall ms" << std::setw(10) << "cpu ms" << std::setw(12) << "ops/s"
+              << std::setw(12) << "lag us" << std::setw(12) << "max lag us" << std::endl;
+    for (auto cameras : camera_counts) {
+        print("thread per camera", cameras, operations, thread_per_camera(cameras, operations, latency));
+        print("coroutines", cameras, operations, coroutines(cameras, operations, latency));
+    }
+    return 0;
+}
@@ -0,0 +1,80 @@
+#include "async_camera.hpp"
+
+#include <algorithm>
+#include "image_quality.hpp"
+
+namespace edsdk_w {
+    AsyncCamera::AsyncCamera(EDSDK::Camera &camera, AsyncScheduler &scheduler) :
+            _camera{camera},
+            _scheduler{scheduler} {
+        _camera.set_download_listener([this](const std::string &path, std::uint64_t size) {
+            _downloads.push_back({path, size});
+        });
+    }
+
+    AsyncCamera::~AsyncCamera() {
+        _camera.set_download_listener(nullptr);
+    }
+
+    Task<bool> AsyncCamera::set_property(EdsPropertyID prop_id, std::uint32_t value, std::chrono::milliseconds timeout) {
+        const auto &constraints = _camera.get_property_constraints(prop_id);
+        auto it = std::find(constraints.begin(), constraints.end(), value);
+        if (it == constraints.end() ||
+            !_camera.set_property(prop_id, static_cast<std::uint32_t>(it - constraints.begin()))) {
+            co_return false;
+        }
+        co_return co_await wait_for_property(prop_id, value, timeout);
+    }
+
+    AsyncScheduler::Wait AsyncCamera::wait_for_property(EdsPropertyID prop_id,
+                                                        std::uint32_t value,
+                                                        std::chrono::milliseconds timeout) {
+        return _scheduler.wait_until([this, prop_id, value] {
+            return _camera.get_property_value(prop_id) == value;
+        }, timeout);
+    }
+
+    Task<bool> AsyncCamera::shutter_button() {
+        co_return _camera.shutter_button();
+    }
+
+    Task<std::vector<AsyncCamera::Download>> AsyncCamera::capture(std::chrono::milliseconds timeout) {
+        std::vector<Download> res{};
+        if (_camera.get_download_directory().empty()) {
+            co_return res;
+        }
+        //RAW+JPEG lands as two downloads, files of earlier shots must not be taken for this one
+        auto files = files_per_shot(_camera.get<Prop::ImageQuality>());
+        _downloads.clear();
+        if (!_camera.shutter_button()) {
+            co_return res;
+        }
+
+        auto deadline = AsyncScheduler::Clock::now() + timeout;
+        while (res.size() < files) {
+            auto download = co_await next_download(
+                    std::chrono::duration_cast<std::chrono::milliseconds>(deadline - AsyncScheduler::Clock::now()));
+            if (!download) {
+                res.clear();
+                break;
+            }
+            res.push_back(std::move(*download));
+        }
+        co_return res;
+    }
+
+    Task<std::optional<AsyncCamera::Download>> AsyncCamera::next_download(std::chrono::milliseconds timeout) {
+        //another task may take the download between wake up and resume
+        auto deadline = AsyncScheduler::Clock::now() + timeout;
+        while (_downloads.empty()) {
+            auto now = AsyncScheduler::Clock::now();
+            if (now >= deadline) {
+                co_return std::nullopt;
+            }
+            co_await _scheduler.wait_until([this] { return !_downloads.empty(); }, deadline - now);
+        }
+        auto res = std::move(_downloads.front());
+        _downloads.pop_front();
+        co_return res;
+    }
+} //namespace edsdk_w
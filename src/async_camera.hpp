@@ -0,0 +1,59 @@
+#ifndef ASYNC_CAMERA_HPP
+#define ASYNC_CAMERA_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <string>
+#include <vector>
+#include "async_task.hpp"
+#include "edsdk_wrapper.hpp"
+
+namespace edsdk_w {
+    //awaitable camera operations, completions are observed in the scheduler after EDSDK::events()
+    //
+    //SDK commands themselves stay synchronous, what no longer blocks is waiting for the camera to
+    //report the result: property change events, downloads of captures; the scheduler pump must
+    //call EDSDK::events()
+    class AsyncCamera {
+    public:
+        struct Download {
+            std::string path;
+            std::uint64_t size;
+        };
+
+        //takes over download listener of camera until destroyed
+        AsyncCamera(EDSDK::Camera &camera, AsyncScheduler &scheduler);
+
+        ~AsyncCamera();
+
+        AsyncCamera(const AsyncCamera &) = delete;
+        AsyncCamera &operator=(const AsyncCamera &) = delete;
+
+        //writes value, which must be in current constraints, and waits until cache holds it
+        Task<bool> set_property(EdsPropertyID prop_id, std::uint32_t value, std::chrono::milliseconds timeout);
+
+        [[nodiscard]] AsyncScheduler::Wait wait_for_property(EdsPropertyID prop_id,
+                                                             std::uint32_t value,
+                                                             std::chrono::milliseconds timeout);
+
+        Task<bool> shutter_button();
+
+        //shoots and waits for all files of the capture to land in download directory, which must be set;
+        //downloads left from earlier shots are dropped first, empty when a file did not come in time
+        Task<std::vector<Download>> capture(std::chrono::milliseconds timeout);
+
+        //downloads are handed out in arrival order, one per call
+        Task<std::optional<Download>> next_download(std::chrono::milliseconds timeout);
+
+        [[nodiscard]] EDSDK::Camera &camera() { return _camera; }
+
+    private:
+        EDSDK::Camera &_camera;
+        AsyncScheduler &_scheduler;
+        std::deque<Download> _downloads;
+    };
+} //namespace edsdk_w
+
+#endif //ASYNC_CAMERA_HPP
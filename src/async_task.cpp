@@ -0,0 +1,95 @@
+#include "async_task.hpp"
+
+#include <algorithm>
+#include <thread>
+
+namespace edsdk_w {
+    AsyncScheduler::Wait::Wait(AsyncScheduler &scheduler, std::function<bool()> ready, Clock::time_point deadline) :
+            _scheduler{scheduler},
+            _ready{std::move(ready)},
+            _deadline{deadline},
+            _ok{false} {}
+
+    bool AsyncScheduler::Wait::await_ready() {
+        _ok = _ready && _ready();
+        return _ok;
+    }
+
+    void AsyncScheduler::Wait::await_suspend(std::coroutine_handle<> handle) {
+        _handle = handle;
+        _scheduler._waits.push_back(this);
+    }
+
+    AsyncScheduler::AsyncScheduler(std::function<void()> pump) :
+            _pump{std::move(pump)},
+            _stats{} {}
+
+    AsyncScheduler::~AsyncScheduler() {
+        //suspended frames are destroyed with their tasks, waits inside them must be forgotten first
+        _waits.clear();
+        _tasks.clear();
+    }
+
+    void AsyncScheduler::spawn(Task<void> task) {
+        _stats.spawned++;
+        auto handle = task.handle();
+        _tasks.push_back(std::move(task));
+        handle.resume();
+    }
+
+    bool AsyncScheduler::run_once() {
+        if (_pump) {
+            _pump();
+        }
+        _stats.pumps++;
+
+        //resumed code registers new waits, they are checked on the next pump
+        auto now = Clock::now();
+        std::vector<Wait*> due{};
+        auto it = std::stable_partition(_waits.begin(), _waits.end(), [&due, now](Wait *wait) {
+            wait->_ok = wait->_ready && wait->_ready();
+            if (wait->_ok || now >= wait->_deadline) {
+                due.push_back(wait);
+                return false;
+            }
+            return true;
+        });
+        _waits.erase(it, _waits.end());
+
+        for (auto wait : due) {
+            _stats.resumed++;
+            if (!wait->_ok && wait->_ready) {
+                _stats.timeouts++;
+            }
+            wait->_handle.resume();
+        }
+
+        _tasks.erase(std::remove_if(_tasks.begin(), _tasks.end(), [](const Task<void> &task) {
+            return task.handle().done();
+        }), _tasks.end());
+        return !_tasks.empty();
+    }
+
+    void AsyncScheduler::run(std::chrono::microseconds poll_interval) {
+        while (run_once()) {
+            //sleeps never outlast the nearest deadline
+            auto wake = Clock::now() + poll_interval;
+            for (auto wait : _waits) {
+                wake = std::min(wake, wait->_deadline);
+            }
+            std::this_thread::sleep_until(wake);
+        }
+    }
+
+    AsyncScheduler::Wait AsyncScheduler::sleep_for(Clock::duration duration) {
+        return Wait{*this, {}, Clock::now() + duration};
+    }
+
+    AsyncScheduler::Wait AsyncScheduler::wait_until(std::function<bool()> ready, Clock::duration timeout) {
+        return Wait{*this, std::move(ready), Clock::now() + timeout};
+    }
+
+    AsyncScheduler::Stats AsyncScheduler::stats() const {
+        return _stats;
+    }
+} //namespace edsdk_w
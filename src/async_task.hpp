@@ -0,0 +1,169 @@
+#ifndef ASYNC_TASK_HPP
+#define ASYNC_TASK_HPP
+
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace edsdk_w {
+    //lazily started coroutine, the awaiting coroutine is resumed when it finishes;
+    //exceptions are not used in this code base, an escaping one terminates
+    template <typename T = void>
+    class [[nodiscard]] Task {
+    public:
+        struct promise_type;
+        using Handle = std::coroutine_handle<promise_type>;
+
+        struct FinalAwaiter {
+            bool await_ready() noexcept { return false; }
+
+            std::coroutine_handle<> await_suspend(Handle handle) noexcept {
+                auto continuation = handle.promise().continuation;
+                return continuation ? continuation : std::noop_coroutine();
+            }
+
+            void await_resume() noexcept {}
+        };
+
+        struct PromiseBase {
+            std::coroutine_handle<> continuation;
+
+            std::suspend_always initial_suspend() noexcept { return {}; }
+
+            FinalAwaiter final_suspend() noexcept { return {}; }
+
+            void unhandled_exception() noexcept { std::terminate(); }
+        };
+
+        struct promise_type : PromiseBase {
+            std::optional<T> value;
+
+            Task get_return_object() { return Task{Handle::from_promise(*this)}; }
+
+            void return_value(T result) { value = std::move(result); }
+        };
+
+        Task(Task &&other) noexcept : _handle{std::exchange(other._handle, {})} {}
+
+        Task &operator=(Task &&other) noexcept {
+            if (this != &other) {
+                _destroy();
+                _handle = std::exchange(other._handle, {});
+            }
+            return *this;
+        }
+
+        Task(const Task &) = delete;
+        Task &operator=(const Task &) = delete;
+
+        ~Task() { _destroy(); }
+
+        bool await_ready() const noexcept { return false; }
+
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+            _handle.promise().continuation = awaiting;
+            return _handle;
+        }
+
+        T await_resume() { return std::move(*_handle.promise().value); }
+
+        //for schedulers which start and own top level tasks
+        [[nodiscard]] Handle handle() const { return _handle; }
+
+    private:
+        explicit Task(Handle handle) : _handle{handle} {}
+
+        void _destroy() {
+            if (_handle) {
+                _handle.destroy();
+            }
+        }
+
+        Handle _handle;
+    };
+
+    template <>
+    struct Task<void>::promise_type : Task<void>::PromiseBase {
+        Task get_return_object() { return Task{Handle::from_promise(*this)}; }
+
+        void return_void() {}
+    };
+
+    template <>
+    inline void Task<void>::await_resume() {}
+
+    //runs many tasks on the calling thread, tasks wait for conditions that are checked after each pump
+    //
+    //waits register themselves in the scheduler and are resumed from run_once(), never from SDK
+    //callbacks, so resumed code may call the SDK again; one thread drives all spawned tasks
+    class AsyncScheduler {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        //awaitable of sleep_for() and wait_until(), resumes with false on timeout
+        class Wait {
+        public:
+            Wait(AsyncScheduler &scheduler, std::function<bool()> ready, Clock::time_point deadline);
+
+            bool await_ready();
+
+            void await_suspend(std::coroutine_handle<> handle);
+
+            bool await_resume() const { return _ok; }
+
+        private:
+            friend AsyncScheduler;
+
+            AsyncScheduler &_scheduler;
+            std::function<bool()> _ready;
+            Clock::time_point _deadline;
+            std::coroutine_handle<> _handle;
+            bool _ok;
+        };
+
+        struct Stats {
+            std::uint64_t spawned;
+            std::uint64_t resumed;
+            std::uint64_t timeouts;
+            std::uint64_t pumps;
+        };
+
+        //pump runs first in every run_once(), e.g. EDSDK::events()
+        explicit AsyncScheduler(std::function<void()> pump = {});
+
+        ~AsyncScheduler();
+
+        AsyncScheduler(const AsyncScheduler &) = delete;
+        AsyncScheduler &operator=(const AsyncScheduler &) = delete;
+
+        //starts task right away, scheduler owns it until it finishes
+        void spawn(Task<void> task);
+
+        //pumps once and resumes every wait that became ready or timed out,
+        //returns false when no spawned task is left
+        bool run_once();
+
+        //until all spawned tasks finish, idles between pumps for at most poll interval
+        void run(std::chrono::microseconds poll_interval = std::chrono::microseconds{1000});
+
+        [[nodiscard]] Wait sleep_for(Clock::duration duration);
+
+        //ready is evaluated after each pump until it returns true or timeout passes
+        [[nodiscard]] Wait wait_until(std::function<bool()> ready, Clock::duration timeout);
+
+        [[nodiscard]] Stats stats() const;
+
+    private:
+        std::function<void()> _pump;
+        std::vector<Task<void>> _tasks;
+        std::vector<Wait*> _waits;
+        Stats _stats;
+    };
+} //namespace edsdk_w
+
+#endif //ASYNC_TASK_HPP
@@ -0,0 +1,1054 @@
+#include "batch_runner.hpp"
+
+#include <EDSDK.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include "image_quality.hpp"
+
+namespace edsdk_w {
+    namespace {
+        constexpr std::chrono::milliseconds SET_CONFIRMATION_TIMEOUT{1000};
+        constexpr std::chrono::milliseconds DOWNLOAD_TIMEOUT = CaptureLatency::LOST_AFTER;
+        constexpr std::chrono::milliseconds IMPORT_REPORT_INTERVAL{2000};
+
+        struct PropertyName {
+            const char *name;
+            EdsPropertyID prop_id;
+        };
+
+        constexpr PropertyName PROPERTY_NAMES[] = {
+                {"image_quality", kEdsPropID_ImageQuality},
+                {"ae_mode", kEdsPropID_AEMode},
+                {"af_mode", kEdsPropID_AFMode},
+                {"white_balance", kEdsPropID_WhiteBalance},
+                {"color_temperature", kEdsPropID_ColorTemperature},
+                {"color_space", kEdsPropID_ColorSpace},
+                {"drive_mode", kEdsPropID_DriveMode},
+                {"metering_mode", kEdsPropID_MeteringMode},
+                {"iso", kEdsPropID_ISOSpeed},
+                {"av", kEdsPropID_Av},
+                {"tv", kEdsPropID_Tv},
+                {"exposure_compensation", kEdsPropID_ExposureCompensation}
+        };
+
+        struct LensStepName {
+            const char *name;
+            EdsEvfDriveLens step;
+        };
+
+        constexpr LensStepName LENS_STEP_NAMES[] = {
+                {"near1", kEdsEvfDriveLens_Near1},
+                {"near2", kEdsEvfDriveLens_Near2},
+                {"near3", kEdsEvfDriveLens_Near3},
+                {"far1", kEdsEvfDriveLens_Far1},
+                {"far2", kEdsEvfDriveLens_Far2},
+                {"far3", kEdsEvfDriveLens_Far3}
+        };
+
+        bool property_by_name(const std::string &name, EdsPropertyID &prop_id) {
+            for (const auto &property : PROPERTY_NAMES) {
+                if (name == property.name) {
+                    prop_id = property.prop_id;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        std::string rest_of_line(std::istringstream &iss) {
+            std::string rest;
+            std::getline(iss >> std::ws, rest);
+            while (!rest.empty() && std::isspace(static_cast<unsigned char>(rest.back()))) {
+                rest.pop_back();
+            }
+            return rest;
+        }
+
+        double ms_between(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to) {
+            return std::chrono::duration<double, std::milli>(to - from).count();
+        }
+    }
+
+    BatchRunner::BatchRunner() : _camera{nullptr} {}
+
+    bool BatchRunner::load(std::istream &script, std::ostream &errors) {
+        _steps.clear();
+
+        std::string line;
+        int line_number = 0;
+        while (std::getline(script, line)) {
+            line_number++;
+
+            auto comment = line.find('#');
+            if (comment != std::string::npos) {
+                line.erase(comment);
+            }
+            if (line.find_first_not_of(" \t\r") == std::string::npos) {
+                continue;
+            }
+
+            Step step{};
+            std::string error;
+            if (!_parse(line, line_number, step, error)) {
+                errors << "line " << line_number << ": " << error << std::endl;
+                return false;
+            }
+            _steps.push_back(std::move(step));
+        }
+
+        _resolve_dependencies();
+        return true;
+    }
+
+    bool BatchRunner::run() {
+        _start = std::chrono::steady_clock::now();
+        _start_wall = std::chrono::system_clock::now();
+        _attach_camera();
+
+        std::size_t next = 0;
+        while (true) {
+            bool progress = false;
+
+            //in-order issue, out-of-order completion
+            while (next < _steps.size() && _ready(_steps[next])) {
+                _issue(_steps[next++]);
+                progress = true;
+            }
+            if (next < _steps.size()) {
+                for (auto index : _steps[next].depends_on) {
+                    if (_steps[index].state == State::Failed) {
+                        _complete(_steps[next++], State::Failed, "dependency failed");
+                        progress = true;
+                        break;
+                    }
+                }
+            }
+
+            EDSDK::events();
+            for (auto &step : _steps) {
+                if (step.state == State::Issued) {
+                    _poll(step);
+                }
+            }
+
+            bool finished = next == _steps.size() &&
+                            std::none_of(_steps.begin(), _steps.end(), [](const Step &step) {
+                                return step.state == State::Issued;
+                            });
+            if (finished) {
+                break;
+            }
+            if (!progress) {
+                std::this_thread::sleep_for(std::chrono::milliseconds{1});
+            }
+        }
+
+        if (_camera) {
+            _camera->set_property_listener(nullptr);
+            _camera->set_download_listener(nullptr);
+            _camera->set_journal(nullptr);
+            _camera->set_post_processor(nullptr);
+            _camera->set_capture_writer(nullptr);
+        }
+        if (_post_processor) {
+            _post_processor->wait_idle();
+        }
+
+        return std::all_of(_steps.begin(), _steps.end(), [](const Step &step) {
+            return step.state == State::Done;
+        });
+    }
+
+    void BatchRunner::report(std::ostream &os) const {
+        double latency_sum = 0, total = 0;
+
+        os << std::fixed << std::setprecision(1)
+           << std::setw(4) << "line" << std::setw(11) << "issued ms" << std::setw(10) << "issue ms"
+           << std::setw(10) << "done ms" << std::setw(12) << "latency ms" << "  status  step\n";
+
+        for (const auto &step : _steps) {
+            bool started = step.state != State::Pending && step.issue_start != std::chrono::steady_clock::time_point{};
+            double issued_at = started ? ms_between(_start, step.issue_start) : 0;
+            double issue = started ? ms_between(step.issue_start, step.issue_end) : 0;
+            double done_at = started ? ms_between(_start, step.done) : 0;
+            double latency = started ? ms_between(step.issue_start, step.done) : 0;
+            latency_sum += latency;
+            total = std::max(total, done_at);
+
+            os << std::setw(4) << step.line << std::setw(11) << issued_at << std::setw(10) << issue
+               << std::setw(10) << done_at << std::setw(12) << latency << "  "
+               << (step.state == State::Done ? "ok    " : "FAILED") << "  " << step.text;
+            if (!step.error.empty()) {
+                os << " (" << step.error << ")";
+            }
+            os << "\n";
+        }
+
+        os << "total " << total << " ms, sum of step latencies " << latency_sum << " ms" << std::endl;
+
+        if (_camera) {
+            auto stats = _camera->get_property_refresh_stats();
+            os << "property change events " << stats.events << ", fetches " << stats.fetches
+               << " in " << stats.flushes << " flushes" << std::endl;
+
+            auto failures = _camera->get_capture_failure_stats();
+            if (failures.requested > 0) {
+                double seconds = total / 1000;
+                auto effective = failures.requested - failures.given_up;
+                os << "captures requested " << failures.requested << ", attempted " << failures.attempts
+                   << ", given up " << failures.given_up << "; " << (seconds > 0 ? effective / seconds : 0.0)
+                   << " effective vs " << (seconds > 0 ? failures.attempts / seconds : 0.0)
+                   << " attempted captures/s" << std::endl;
+                for (std::size_t i = 0; i < CAPTURE_FAILURE_CAUSE_COUNT; i++) {
+                    const auto &cause = failures.causes[i];
+                    if (cause.failures > 0) {
+                        os << "  " << to_string(static_cast<CaptureFailureCause>(i)) << ": " << cause.failures
+                           << " failures, " << cause.retries << " retries, " << cause.given_up << " given up"
+                           << std::endl;
+                    }
+                }
+            }
+        }
+
+        if (_camera) {
+            auto percentiles = [&os](const char *name, const CaptureLatency::Percentiles &p) {
+                os << "  " << std::left << std::setw(18) << name << std::right << std::setw(6) << p.count
+                   << std::setw(12) << p.p50_us / 1000 << std::setw(12) << p.p90_us / 1000
+                   << std::setw(12) << p.p99_us / 1000 << std::setw(12) << p.max_us / 1000 << "\n";
+            };
+            for (const auto &group : _camera->get_capture_latency().groups()) {
+                os << "capture latency of body " << group.body_id << ", "
+                   << EDSDK::explain_prop_value(kEdsPropID_ImageQuality, group.image_quality) << ": "
+                   << group.captures << " captures, " << group.failures << " failed\n"
+                   << "  " << std::left << std::setw(18) << "ms" << std::right << std::setw(6) << "count"
+                   << std::setw(12) << "p50" << std::setw(12) << "p90" << std::setw(12) << "p99"
+                   << std::setw(12) << "max" << "\n";
+                percentiles("shutter command", group.command);
+                percentiles("shutter to item", group.event);
+                percentiles("transfer", group.transfer);
+                percentiles("shutter to file", group.to_file);
+            }
+            os << std::flush;
+        }
+
+        if (_reconciler) {
+            auto stats = _reconciler->stats();
+            os << "property reconciler: " << stats.reads << " reads, " << stats.stale << " stale values found, "
+               << stats.over_budget << " reads postponed by budget, " << stats.busy << " by captures" << std::endl;
+        }
+
+        if (_watchdog) {
+            auto stats = _watchdog->stats();
+            os << "session watchdog: " << (stats.healthy ? "healthy" : "BROKEN") << ", " << stats.probes
+               << " probes, " << stats.failed_probes << " failed, round trip last " << stats.last_probe_us
+               << " us, p50 " << stats.p50_probe_us << " us, p99 " << stats.p99_probe_us << " us, max "
+               << stats.max_probe_us << " us, " << stats.keep_alives << " keep-alives, " << stats.reopens
+               << " reopens, " << stats.failed_reopens << " failed reopens" << std::endl;
+        }
+
+        if (_capture_writer) {
+            auto stats = _capture_writer->stats();
+            os << "capture writer (" << (_capture_writer->uses_io_uring() ? "io_uring" : "synchronous") << "): "
+               << stats.files << " files, " << stats.mb_per_second() << " MB/s, chunk latency p50 "
+               << stats.p50_latency_us << " us, p99 " << stats.p99_latency_us << " us, max "
+               << stats.max_latency_us << " us, " << stats.failed_writes << " failed writes" << std::endl;
+        }
+
+        if (_importer) {
+            auto progress = _importer->progress();
+            os << "import: " << progress.files_imported << " files, "
+               << static_cast<double>(progress.bytes_imported) / (1024 * 1024) << " MB at "
+               << progress.mb_per_second() << " MB/s, " << progress.files_skipped
+               << " already imported, " << progress.files_failed << " failed" << std::endl;
+        }
+
+        if (_focus_stacker) {
+            auto stats = _focus_stacker->stats();
+            os << "focus stack: " << stats.frames << " frames in " << stats.elapsed_seconds << " s, "
+               << stats.frames_per_minute() << " frames per minute\n"
+               << std::setw(6) << "frame" << std::setw(10) << "lens ms" << std::setw(10) << "wait ms"
+               << std::setw(13) << "capture ms" << std::setw(14) << "transfer ms" << "\n";
+            const auto &timings = _focus_stacker->timings();
+            for (std::size_t i = 0; i < timings.size() && i < stats.frames; i++) {
+                os << std::setw(6) << i << std::setw(10) << timings[i].lens_ms << std::setw(10) << timings[i].wait_ms
+                   << std::setw(13) << timings[i].capture_ms << std::setw(14);
+                if (timings[i].transfer_ms < 0) {
+                    os << "-";
+                } else {
+                    os << timings[i].transfer_ms;
+                }
+                os << "\n";
+            }
+            os << std::flush;
+        }
+
+        if (_motion_trigger) {
+            auto stats = _motion_trigger->stats();
+            os << "motion trigger: " << stats.shots << " shots, " << stats.motion_frames << " of " << stats.frames
+               << " frames with motion, " << stats.decode_failures << " not decoded, " << stats.frames_per_second()
+               << " frames/s, " << (stats.frames ? stats.analyze_ms / static_cast<double>(stats.frames) : 0.0)
+               << " ms decode and detection per frame (" << block_sads_isa() << ")" << std::endl;
+        }
+
+        if (_exposure_controller) {
+            auto stats = _exposure_controller->stats();
+            auto frames = static_cast<double>(std::max<std::uint64_t>(stats.frames, 1));
+            os << "exposure control: ";
+            if (stats.converged_ms < 0) {
+                os << "not converged";
+            } else {
+                os << "converged after " << stats.converged_ms << " ms";
+            }
+            os << ", " << stats.changes << " changes, " << stats.metered_frames << " of " << stats.frames
+               << " frames metered, " << stats.decode_failures << " not decoded, " << stats.at_limit
+               << " at Tv/ISO limit, last mean " << stats.last_mean << " (" << stats.last_error << " stops), "
+               << stats.decode_ms / frames << " + " << stats.histogram_ms / frames
+               << " ms decode and histogram per frame (" << luma_histogram_isa() << ")" << std::endl;
+        }
+
+        if (_recorder) {
+            auto stats = _recorder->stats();
+            os << "live view record: " << stats.frames << " frames, "
+               << static_cast<double>(stats.bytes) / (1024 * 1024) << " MB in " << stats.segments << " segments, "
+               << stats.dropped << " dropped for lack of buffers (at most " << stats.max_queued << " queued), "
+               << stats.not_ready << " not ready" << std::endl;
+        }
+
+        if (_post_processor) {
+            auto stats = _post_processor->stats();
+            auto stage = [&os](const char *name, const DownloadPostProcessor::StageStats &stage) {
+                double seconds = static_cast<double>(stage.busy_ns) / 1e9;
+                os << name << " " << stage.files << " files, "
+                   << (seconds > 0 ? static_cast<double>(stage.bytes) / (1024 * 1024) / seconds : 0.0)
+                   << " MB/s per thread" << std::endl;
+            };
+            stage("checksum", stats.hash);
+            stage("preview", stats.preview);
+            os << "post processing of " << stats.submitted << " files on " << _post_processor->thread_count()
+               << " threads, avg " << (stats.submitted ? static_cast<double>(stats.total_ns) / 1e6 / stats.submitted : 0.0)
+               << " ms per file, " << stats.skipped << " skipped over memory limit" << std::endl;
+        }
+    }
+
+    bool BatchRunner::_parse(const std::string &line, int line_number, Step &step, std::string &error) {
+        std::istringstream iss{line};
+        std::string command;
+        iss >> command;
+
+        step.line = line_number;
+        step.text = line.substr(line.find_first_not_of(" \t"));
+        while (!step.text.empty() && std::isspace(static_cast<unsigned char>(step.text.back()))) {
+            step.text.pop_back();
+        }
+        step.state = State::Pending;
+
+        auto read_property = [&iss, &step, &error]() {
+            std::string name;
+            iss >> name;
+            if (!property_by_name(name, step.prop_id)) {
+                error = "unknown property '" + name + "'";
+                return false;
+            }
+            return true;
+        };
+
+        if (command == "camera") {
+            step.kind = Kind::Camera;
+            if (!(iss >> step.number)) {
+                error = "camera index expected";
+                return false;
+            }
+        } else if (command == "download" || command == "journal") {
+            step.kind = command == "download" ? Kind::Download : Kind::Journal;
+            step.argument = rest_of_line(iss);
+            if (step.argument.empty()) {
+                error = "path expected";
+                return false;
+            }
+        } else if (command == "postprocess") {
+            step.kind = Kind::PostProcess;
+            if (!(iss >> step.number)) {
+                error = "thread count expected";
+                return false;
+            }
+        } else if (command == "writer") {
+            step.kind = Kind::Writer;
+            step.argument = rest_of_line(iss);
+            if (step.argument != "buffered" && step.argument != "direct") {
+                error = "buffered or direct expected";
+                return false;
+            }
+        } else if (command == "reconcile") {
+            step.kind = Kind::Reconcile;
+            if (!(iss >> step.number) || step.number == 0) {
+                error = "positive budget in bytes per second expected";
+                return false;
+            }
+        } else if (command == "watchdog") {
+            step.kind = Kind::Watchdog;
+            if (!(iss >> step.number) || step.number == 0) {
+                error = "positive probe interval in milliseconds expected";
+                return false;
+            }
+        } else if (command == "retry_policy") {
+            step.kind = Kind::RetryPolicy;
+            std::string cause, action;
+            long long delay_ms = 0;
+            if (!(iss >> cause >> action >> step.retry_rule.max_retries >> delay_ms) || delay_ms < 0) {
+                error = "cause, action, max retries and delay expected";
+                return false;
+            }
+
+            bool known_cause = false;
+            for (std::size_t i = 0; i < CAPTURE_FAILURE_CAUSE_COUNT; i++) {
+                if (to_string(static_cast<CaptureFailureCause>(i)) == cause) {
+                    step.failure_cause = static_cast<CaptureFailureCause>(i);
+                    known_cause = true;
+                }
+            }
+            if (!known_cause) {
+                error = "unknown failure cause '" + cause + "'";
+                return false;
+            }
+
+            if (action == "give_up") {
+                step.retry_rule.action = CaptureRetryPolicy::Action::GiveUp;
+            } else if (action == "retry") {
+                step.retry_rule.action = CaptureRetryPolicy::Action::Retry;
+            } else if (action == "refocus") {
+                step.retry_rule.action = CaptureRetryPolicy::Action::Refocus;
+            } else {
+                error = "give_up, retry or refocus expected";
+                return false;
+            }
+            step.retry_rule.delay = std::chrono::milliseconds{delay_ms};
+        } else if (command == "import") {
+            step.kind = Kind::Import;
+            step.argument = rest_of_line(iss);
+            if (step.argument.empty()) {
+                error = "directory expected";
+                return false;
+            }
+        } else if (command == "motion") {
+            step.kind = Kind::Motion;
+            double percent = 0;
+            long long cooldown_ms = 0, timeout_s = 0;
+            if (!(iss >> percent >> step.motion.shots >> cooldown_ms >> timeout_s) ||
+                percent <= 0 || percent > 100 || step.motion.shots == 0 || cooldown_ms < 0 || timeout_s < 0) {
+                error = "changed area percent, shot count, cooldown and timeout expected";
+                return false;
+            }
+            step.motion.detector.trigger_fraction = percent / 100;
+            step.motion.cooldown = std::chrono::milliseconds{cooldown_ms};
+            step.motion.timeout = std::chrono::seconds{timeout_s};
+        } else if (command == "exposure") {
+            step.kind = Kind::Exposure;
+            double target = 0;
+            long long seconds = 0;
+            if (!(iss >> target >> seconds) || target < 1 || target > 254 || seconds <= 0) {
+                error = "target mean luma 1-254 and duration in seconds expected";
+                return false;
+            }
+            step.exposure.target = target;
+            step.exposure.duration = std::chrono::seconds{seconds};
+        } else if (command == "record") {
+            step.kind = Kind::Record;
+            long long seconds = 0;
+            iss >> seconds;
+            step.timeout = std::chrono::seconds{seconds};
+            step.argument = rest_of_line(iss);
+            if (seconds <= 0 || step.argument.empty()) {
+                error = "duration in seconds and directory expected";
+                return false;
+            }
+        } else if (command == "profile" || command == "save_profile") {
+            step.kind = command == "profile" ? Kind::Profile : Kind::SaveProfile;
+            iss >> step.name;
+            step.argument = rest_of_line(iss);
+            if (step.name.empty() || step.argument.empty()) {
+                error = "profile name and path expected";
+                return false;
+            }
+        } else if (command == "focus_stack") {
+            step.kind = Kind::FocusStack;
+            std::string lens_step;
+            long long settle_ms = 0;
+            if (!(iss >> step.focus_stack.frames >> lens_step >> step.focus_stack.steps_per_frame >> settle_ms) ||
+                step.focus_stack.frames == 0 || settle_ms < 0) {
+                error = "frame count, lens step, steps per frame and settle time expected";
+                return false;
+            }
+            auto it = std::find_if(std::begin(LENS_STEP_NAMES), std::end(LENS_STEP_NAMES),
+                                   [&lens_step](const LensStepName &name) { return lens_step == name.name; });
+            if (it == std::end(LENS_STEP_NAMES)) {
+                error = "unknown lens step '" + lens_step + "'";
+                return false;
+            }
+            step.focus_stack.step = it->step;
+            step.focus_stack.settle = std::chrono::milliseconds{settle_ms};
+        } else if (command == "set") {
+            step.kind = Kind::Set;
+            if (!read_property()) {
+                return false;
+            }
+            step.argument = rest_of_line(iss);
+            if (step.argument.empty()) {
+                error = "value label expected";
+                return false;
+            }
+            step.timeout = SET_CONFIRMATION_TIMEOUT;
+        } else if (command == "capture") {
+            step.kind = Kind::Capture;
+            if (!(iss >> step.number) || step.number == 0) {
+                error = "positive capture count expected";
+                return false;
+            }
+            step.timeout = DOWNLOAD_TIMEOUT;
+        } else if (command == "wait") {
+            step.kind = Kind::Wait;
+            long long timeout_ms = 0;
+            if (!read_property()) {
+                return false;
+            }
+            if (!(iss >> timeout_ms) || timeout_ms < 0) {
+                error = "timeout in milliseconds expected";
+                return false;
+            }
+            step.timeout = std::chrono::milliseconds{timeout_ms};
+            step.argument = rest_of_line(iss);
+        } else if (command == "sleep_until") {
+            step.kind = Kind::SleepUntil;
+            std::string when;
+            iss >> when;
+
+            int h = 0, m = 0, s = 0;
+            char sep1 = 0, sep2 = 0;
+            std::istringstream time_iss{when};
+            if (!when.empty() && when[0] == '+') {
+                char *end = nullptr;
+                auto ms = std::strtoll(when.c_str() + 1, &end, 10);
+                if (end == when.c_str() + 1 || *end != '\0' || ms < 0) {
+                    error = "+<ms> expected";
+                    return false;
+                }
+                step.relative_deadline = true;
+                step.timeout = std::chrono::milliseconds{ms};
+            } else if (time_iss >> h >> sep1 >> m >> sep2 >> s && sep1 == ':' && sep2 == ':' &&
+                       h >= 0 && h < 24 && m >= 0 && m < 60 && s >= 0 && s < 60) {
+                auto now = std::chrono::system_clock::now();
+                auto now_t = std::chrono::system_clock::to_time_t(now);
+                std::tm deadline = *std::localtime(&now_t);
+                deadline.tm_hour = h;
+                deadline.tm_min = m;
+                deadline.tm_sec = s;
+                deadline.tm_isdst = -1;
+                step.deadline = std::chrono::system_clock::from_time_t(std::mktime(&deadline));
+                //time already passed today means tomorrow, mktime normalizes the day
+                if (step.deadline <= now) {
+                    deadline.tm_mday++;
+                    deadline.tm_isdst = -1;
+                    step.deadline = std::chrono::system_clock::from_time_t(std::mktime(&deadline));
+                }
+            } else {
+                error = "+<ms> or HH:MM:SS expected";
+                return false;
+            }
+        } else {
+            error = "unknown command '" + command + "'";
+            return false;
+        }
+
+        return true;
+    }
+
+    void BatchRunner::_resolve_dependencies() {
+        constexpr auto NONE = static_cast<std::size_t>(-1);
+        std::size_t last_barrier = NONE;
+
+        for (std::size_t i = 0; i < _steps.size(); i++) {
+            auto &step = _steps[i];
+            if (last_barrier != NONE) {
+                step.depends_on.push_back(last_barrier);
+            }
+
+            for (std::size_t j = 0; j < i; j++) {
+                const auto &prev = _steps[j];
+                bool same_property = (prev.kind == Kind::Set || prev.kind == Kind::Wait) &&
+                                     (step.kind == Kind::Set || step.kind == Kind::Wait) &&
+                                     prev.prop_id == step.prop_id;
+
+                switch (step.kind) {
+                    case Kind::Camera:
+                    case Kind::Download:
+                    case Kind::Journal:
+                    case Kind::PostProcess:
+                    case Kind::Writer:
+                    case Kind::Reconcile:
+                    case Kind::Watchdog:
+                    case Kind::RetryPolicy:
+                    case Kind::Import:
+                    case Kind::FocusStack:
+                    case Kind::Motion:
+                    case Kind::Exposure:
+                    case Kind::Record:
+                    case Kind::Profile:
+                    case Kind::SaveProfile:
+                        //reconfiguring camera waits for everything in flight
+                        step.depends_on.push_back(j);
+                        break;
+                    case Kind::Set:
+                    case Kind::Wait:
+                        if (same_property) {
+                            step.depends_on.push_back(j);
+                        }
+                        break;
+                    case Kind::Capture:
+                        //settings must be applied before the shot, earlier downloads may still be running
+                        if (prev.kind == Kind::Set) {
+                            step.depends_on.push_back(j);
+                        }
+                        break;
+                    case Kind::SleepUntil:
+                        break;
+                }
+            }
+
+            if (step.kind != Kind::Set && step.kind != Kind::Capture) {
+                last_barrier = i;
+            }
+        }
+    }
+
+    bool BatchRunner::_ready(const Step &step) const {
+        return std::all_of(step.depends_on.begin(), step.depends_on.end(), [this](std::size_t index) {
+            return _steps[index].state == State::Done;
+        });
+    }
+
+    void BatchRunner::_issue(Step &step) {
+        step.state = State::Issued;
+        step.issue_start = std::chrono::steady_clock::now();
+
+        if (!_camera && step.kind != Kind::Camera && step.kind != Kind::Journal &&
+            step.kind != Kind::PostProcess && step.kind != Kind::Writer && step.kind != Kind::Reconcile &&
+            step.kind != Kind::Watchdog && step.kind != Kind::RetryPolicy && step.kind != Kind::SleepUntil) {
+            step.issue_end = step.issue_start;
+            _complete(step, State::Failed, "no camera");
+            return;
+        }
+
+        switch (step.kind) {
+            case Kind::Camera:
+                EDSDK::get_instance().reset_camera();
+                _camera = nullptr;
+                if (EDSDK::get_instance().set_camera(step.number)) {
+                    _attach_camera();
+                }
+                step.issue_end = std::chrono::steady_clock::now();
+                if (_camera) {
+                    _complete(step, State::Done);
+                } else {
+                    _complete(step, State::Failed, "camera is not available");
+                }
+                break;
+            case Kind::Download: {
+                bool res = _camera->set_download_directory(step.argument);
+                step.issue_end = std::chrono::steady_clock::now();
+                if (res) {
+                    _complete(step, State::Done);
+                } else {
+                    _complete(step, State::Failed, "camera refused to save to host");
+                }
+                break;
+            }
+            case Kind::Journal: {
+                if (_camera) {
+                    _camera->set_journal(nullptr);
+                }
+                _journal = std::make_unique<CaptureJournal>();
+                bool res = _journal->open(step.argument);
+                step.issue_end = std::chrono::steady_clock::now();
+                if (!res) {
+                    _journal.reset();
+                    _complete(step, State::Failed, "cannot open journal");
+                    break;
+                }
+
+                auto incomplete = _journal->incomplete_transfers();
+                for (const auto &record : incomplete) {
+                    std::cout << "journal: capture #" << record.sequence << " of body "
+                              << std::string(record.body_id, strnlen(record.body_id, sizeof(record.body_id)))
+                              << " was triggered but never downloaded" << std::endl;
+                }
+                if (_camera) {
+                    _camera->set_journal(_journal.get());
+                }
+                _complete(step, State::Done);
+                break;
+            }
+            case Kind::PostProcess:
+                if (_camera) {
+                    _camera->set_post_processor(nullptr);
+                }
+                _post_processor = std::make_unique<DownloadPostProcessor>(step.number);
+                if (_camera) {
+                    _camera->set_post_processor(_post_processor.get());
+                }
+                step.issue_end = std::chrono::steady_clock::now();
+                _complete(step, State::Done);
+                break;
+            case Kind::Writer: {
+                if (_camera) {
+                    _camera->set_capture_writer(nullptr);
+                }
+                CaptureWriter::Options options{};
+                options.direct_io = step.argument == "direct";
+                _capture_writer = std::make_unique<CaptureWriter>(options);
+                if (_camera) {
+                    _camera->set_capture_writer(_capture_writer.get());
+                }
+                step.issue_end = std::chrono::steady_clock::now();
+                _complete(step, State::Done);
+                break;
+            }
+            case Kind::Reconcile: {
+                if (_camera) {
+                    _camera->set_property_reconciler(nullptr);
+                }
+                PropertyReconciler::Options options{};
+                options.bytes_per_second = step.number;
+                _reconciler = std::make_unique<PropertyReconciler>(options);
+                if (_camera) {
+                    _camera->set_property_reconciler(_reconciler.get());
+                }
+                step.issue_end = std::chrono::steady_clock::now();
+                _complete(step, State::Done);
+                break;
+            }
+            case Kind::Watchdog: {
+                if (_camera) {
+                    _camera->set_session_watchdog(nullptr);
+                }
+                SessionWatchdog::Options options{};
+                options.probe_interval = std::chrono::milliseconds{step.number};
+                _watchdog = std::make_unique<SessionWatchdog>(options);
+                if (_camera) {
+                    _camera->set_session_watchdog(_watchdog.get());
+                }
+                step.issue_end = std::chrono::steady_clock::now();
+                _complete(step, State::Done);
+                break;
+            }
+            case Kind::RetryPolicy:
+                _retry_policy.set_rule(step.failure_cause, step.retry_rule);
+                if (_camera) {
+                    _camera->set_capture_retry_policy(_retry_policy);
+                }
+                step.issue_end = std::chrono::steady_clock::now();
+                _complete(step, State::Done);
+                break;
+            case Kind::Import:
+                _importer = std::make_unique<CardImporter>(*_camera, step.argument);
+                step.issue_end = std::chrono::steady_clock::now();
+                if (!_importer->start()) {
+                    _complete(step, State::Failed, "cannot open import directory or manifest");
+                }
+                _import_reported = step.issue_end;
+                break;
+            case Kind::FocusStack:
+                _focus_stacker = std::make_unique<FocusStacker>(*_camera, step.focus_stack);
+                step.issue_end = std::chrono::steady_clock::now();
+                if (!_focus_stacker->start()) {
+                    _complete(step, State::Failed, "live view is not available");
+                }
+                break;
+            case Kind::Motion:
+                _motion_trigger = std::make_unique<MotionTrigger>(*_camera, step.motion);
+                step.issue_end = std::chrono::steady_clock::now();
+                if (!_motion_trigger->start()) {
+                    _complete(step, State::Failed, MotionDetector::decoding_available()
+                                                   ? "live view is not available" : "built without jpeg decoder");
+                }
+                break;
+            case Kind::Exposure:
+                _exposure_controller = std::make_unique<ExposureController>(*_camera, step.exposure);
+                step.issue_end = std::chrono::steady_clock::now();
+                if (!_exposure_controller->start()) {
+                    _complete(step, State::Failed, LumaDecoder::available()
+                                                   ? "live view is not available" : "built without jpeg decoder");
+                }
+                break;
+            case Kind::Record:
+                _recorder = std::make_unique<LiveViewRecorder>(LiveViewRecorder::Options{});
+                step.issue_end = std::chrono::steady_clock::now();
+                _record_end = step.issue_end + step.timeout;
+                if (!_recorder->start(step.argument)) {
+                    _complete(step, State::Failed, "cannot create record directory");
+                }
+                break;
+            case Kind::Profile: {
+                std::vector<SettingsProfile> profiles{};
+                auto it = profiles.end();
+                if (load_profiles(step.argument, profiles)) {
+                    it = std::find_if(profiles.begin(), profiles.end(),
+                                      [&step](const SettingsProfile &profile) { return profile.name == step.name; });
+                }
+                if (it == profiles.end()) {
+                    step.issue_end = std::chrono::steady_clock::now();
+                    _complete(step, State::Failed, "profile not found");
+                    break;
+                }
+
+                auto res = ProfileEngine{*_camera}.apply(*it);
+                step.issue_end = std::chrono::steady_clock::now();
+                std::ostringstream summary{};
+                summary << std::fixed << std::setprecision(1) << res.writes << " writes, " << res.unchanged
+                        << " unchanged, " << res.gated << " not applicable, " << res.constraint_waits
+                        << " constraint waits in " << res.apply_ms << " ms";
+                if (res.ok) {
+                    _complete(step, State::Done, summary.str());
+                } else {
+                    _complete(step, State::Failed, res.error + "; " + summary.str());
+                }
+                break;
+            }
+            case Kind::SaveProfile: {
+                //other profiles of the file are kept, profile of the same name is replaced
+                std::vector<SettingsProfile> profiles{};
+                load_profiles(step.argument, profiles);
+                profiles.erase(std::remove_if(profiles.begin(), profiles.end(),
+                                              [&step](const SettingsProfile &profile) { return profile.name == step.name; }),
+                               profiles.end());
+                profiles.push_back(snapshot_profile(*_camera, step.name));
+                bool res = save_profiles(step.argument, profiles);
+                step.issue_end = std::chrono::steady_clock::now();
+                if (res) {
+                    _complete(step, State::Done);
+                } else {
+                    _complete(step, State::Failed, "cannot write profiles file");
+                }
+                break;
+            }
+            case Kind::Set: {
+                auto constraints = _camera->get_property_constraint_values(step.prop_id);
+                auto labels = EDSDK::explain_prop_value(step.prop_id, constraints);
+                auto it = std::find(labels.begin(), labels.end(), step.argument);
+                if (it == labels.end()) {
+                    step.issue_end = std::chrono::steady_clock::now();
+                    _complete(step, State::Failed, "value is not allowed now");
+                    break;
+                }
+
+                auto index = static_cast<std::uint32_t>(it - labels.begin());
+                step.target_value = constraints[index];
+                if (_camera->get_property_value(step.prop_id) == step.target_value) {
+                    step.issue_end = std::chrono::steady_clock::now();
+                    _complete(step, State::Done, "already set");
+                    break;
+                }
+
+                bool res = _camera->set_property(step.prop_id, index);
+                step.issue_end = std::chrono::steady_clock::now();
+                if (!res) {
+                    _complete(step, State::Failed, "camera rejected value");
+                }
+                //otherwise done once camera reports the change
+                break;
+            }
+            case Kind::Capture: {
+                bool res = true;
+                for (std::uint32_t i = 0; i < step.number && res; i++) {
+                    res = _camera->shutter_button();
+                }
+                step.issue_end = std::chrono::steady_clock::now();
+
+                if (!res) {
+                    _complete(step, State::Failed, "shutter command failed");
+                } else if (_camera->get_download_directory().empty()) {
+                    _complete(step, State::Done);
+                } else {
+                    //RAW+JPEG shots download two files each
+                    step.outstanding = step.number * files_per_shot(_camera->get<Prop::ImageQuality>());
+                }
+                break;
+            }
+            case Kind::Wait:
+            case Kind::SleepUntil:
+                step.issue_end = std::chrono::steady_clock::now();
+                if (step.kind == Kind::SleepUntil && step.relative_deadline) {
+                    step.deadline = _start_wall + step.timeout;
+                }
+                _poll(step);
+                break;
+        }
+    }
+
+    void BatchRunner::_poll(Step &step) {
+        auto now = std::chrono::steady_clock::now();
+        bool timed_out = now - step.issue_end >= step.timeout;
+
+        switch (step.kind) {
+            case Kind::Set:
+                //not every body echoes changes made by host, value has been accepted anyway
+                if (timed_out) {
+                    _complete(step, State::Done, "unconfirmed");
+                }
+                break;
+            case Kind::Capture:
+                if (timed_out) {
+                    _complete(step, State::Failed, std::to_string(step.outstanding) + " downloads missing");
+                }
+                break;
+            case Kind::Wait: {
+                auto value = _camera->get_property_value(step.prop_id);
+                if (value && EDSDK::explain_prop_value(step.prop_id, *value) == step.argument) {
+                    _complete(step, State::Done);
+                } else if (timed_out) {
+                    _complete(step, State::Failed, "timeout");
+                }
+                break;
+            }
+            case Kind::SleepUntil:
+                if (std::chrono::system_clock::now() >= step.deadline) {
+                    _complete(step, State::Done);
+                }
+                break;
+            case Kind::Import: {
+                //one file per poll keeps camera events flowing during long imports
+                bool more = _importer->step();
+                auto progress = _importer->progress();
+                if (!more) {
+                    if (progress.files_failed > 0) {
+                        _complete(step, State::Failed, std::to_string(progress.files_failed) + " files failed");
+                    } else {
+                        _complete(step, State::Done);
+                    }
+                } else if (now - _import_reported >= IMPORT_REPORT_INTERVAL) {
+                    _import_reported = now;
+                    std::cout << std::fixed << std::setprecision(1) << "import: " << progress.files_imported
+                              << "/" << progress.files_queued << (progress.listing_done ? "" : "+") << " files, "
+                              << progress.mb_per_second() << " MB/s, eta ";
+                    if (progress.eta_seconds() < 0) {
+                        std::cout << "unknown" << std::endl;
+                    } else {
+                        std::cout << (progress.listing_done ? "" : ">") << progress.eta_seconds() << " s" << std::endl;
+                    }
+                }
+                break;
+            }
+            case Kind::FocusStack:
+                if (!_focus_stacker->step()) {
+                    if (_focus_stacker->failed()) {
+                        _complete(step, State::Failed, std::to_string(_focus_stacker->stats().frames) + " frames taken");
+                    } else {
+                        _complete(step, State::Done);
+                    }
+                }
+                break;
+            case Kind::Record:
+                if (std::chrono::steady_clock::now() >= _record_end) {
+                    _recorder->stop();
+                    _camera->stop_live_view();
+                    auto stats = _recorder->stats();
+                    if (stats.write_failed || stats.frames == 0) {
+                        _complete(step, State::Failed, stats.write_failed ? "write failed" : "no live view frames");
+                    } else {
+                        _complete(step, State::Done);
+                    }
+                } else {
+                    _recorder->record(*_camera);
+                }
+                break;
+            case Kind::Motion:
+                if (!_motion_trigger->step()) {
+                    if (_motion_trigger->failed()) {
+                        _complete(step, State::Failed, std::to_string(_motion_trigger->stats().shots) + " shots taken");
+                    } else {
+                        _complete(step, State::Done);
+                    }
+                }
+                break;
+            case Kind::Exposure:
+                if (!_exposure_controller->step()) {
+                    if (_exposure_controller->failed()) {
+                        _complete(step, State::Failed, "Tv or ISO could not be set (manual exposure needed)");
+                    } else {
+                        _complete(step, State::Done);
+                    }
+                }
+                break;
+            default:
+                break;
+        }
+    }
+
+    void BatchRunner::_complete(Step &step, State state, const std::string &error) {
+        step.state = state;
+        step.done = std::chrono::steady_clock::now();
+        step.error = error;
+    }
+
+    void BatchRunner::_attach_camera() {
+        auto camera = EDSDK::get_instance().get_camera();
+        _camera = camera ? &camera->get() : nullptr;
+        if (!_camera) {
+            return;
+        }
+
+        _camera->set_property_listener([this](EdsPropertyID prop_id, std::uint32_t value) {
+            for (auto &step : _steps) {
+                if (step.state == State::Issued && step.kind == Kind::Set &&
+                    step.prop_id == prop_id && step.target_value == value) {
+                    _complete(step, State::Done);
+                }
+            }
+        });
+
+        _camera->set_download_listener([this](const std::string &, std::uint64_t) {
+            //camera reports no capture id, downloads complete captures in order
+            for (auto &step : _steps) {
+                if (step.state == State::Issued && step.kind == Kind::FocusStack) {
+                    _focus_stacker->on_downloaded();
+                    break;
+                }
+                if (step.state == State::Issued && step.kind == Kind::Capture && step.outstanding > 0) {
+                    if (--step.outstanding == 0) {
+                        _complete(step, State::Done);
+                    }
+                    break;
+                }
+            }
+        });
+
+        if (_journal) {
+            _camera->set_journal(_journal.get());
+        }
+        if (_post_processor) {
+            _camera->set_post_processor(_post_processor.get());
+        }
+        if (_capture_writer) {
+            _camera->set_capture_writer(_capture_writer.get());
+        }
+        if (_reconciler) {
+            _camera->set_property_reconciler(_reconciler.get());
+        }
+        if (_watchdog) {
+            _camera->set_session_watchdog(_watchdog.get());
+        }
+        _camera->set_capture_retry_policy(_retry_policy);
+        _camera->set_capture_failure_listener([](const CaptureFailure &failure) {
+            std::cout << "capture #" << failure.capture_id << " failed on attempt " << failure.attempt
+                      << " with error 0x" << std::hex << failure.error << std::dec << " ("
+                      << to_string(failure.cause) << (failure.reported_by_event ? ", after the shot" : "")
+                      << "), " << (failure.will_retry ? "retrying" : "giving up") << std::endl;
+        });
+    }
+} //namespace edsdk_w
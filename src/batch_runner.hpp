@@ -0,0 +1,148 @@
+#ifndef BATCH_RUNNER_HPP
+#define BATCH_RUNNER_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "capture_journal.hpp"
+#include "card_importer.hpp"
+#include "download_postprocessor.hpp"
+#include "edsdk_wrapper.hpp"
+#include "exposure_controller.hpp"
+#include "focus_stacker.hpp"
+#include "live_view_recorder.hpp"
+#include "motion_trigger.hpp"
+#include "settings_profile.hpp"
+
+namespace edsdk_w {
+    //executes a script of camera operations, one per line:
+    //  camera <index>
+    //  download <directory>
+    //  journal <path>
+    //  postprocess <threads, 0 = one per cpu>
+    //  writer <buffered|direct>
+    //  reconcile <polling budget in bytes per second>
+    //  watchdog <probe interval ms>
+    //  retry_policy <focus|busy|card|flash|other> <give_up|retry|refocus> <max retries> <delay_ms>
+    //  import <directory>
+    //  profile <name> <profiles file>
+    //  save_profile <name> <profiles file>
+    //  focus_stack <frames> <near1|near2|near3|far1|far2|far3> <lens steps per frame> <settle_ms>
+    //  motion <changed area %> <shots> <cooldown_ms> <timeout s, 0 = until all shots>
+    //  exposure <target mean luma 1-254> <seconds>
+    //  record <seconds> <directory>
+    //  set <property> <label>
+    //  capture <count>
+    //  wait <property> <timeout_ms> <label>
+    //  sleep_until <+ms from script start | HH:MM:SS, tomorrow if already past>
+    //steps are issued in order, but a step only waits for completion of earlier steps it depends on,
+    //e.g. settings of different properties are in flight together and captures do not wait for downloads
+    class BatchRunner {
+    public:
+        BatchRunner();
+
+        //returns false and reports the line on syntax error
+        bool load(std::istream &script, std::ostream &errors);
+
+        //returns true if every step completed successfully
+        bool run();
+
+        void report(std::ostream &os) const;
+
+    private:
+        enum class Kind {
+            Camera,
+            Download,
+            Journal,
+            PostProcess,
+            Writer,
+            Reconcile,
+            Watchdog,
+            RetryPolicy,
+            Import,
+            FocusStack,
+            Motion,
+            Exposure,
+            Record,
+            Profile,
+            SaveProfile,
+            Set,
+            Capture,
+            Wait,
+            SleepUntil
+        };
+
+        enum class State {
+            Pending,
+            Issued,
+            Done,
+            Failed
+        };
+
+        struct Step {
+            Kind kind;
+            int line;
+            std::string text;
+
+            std::uint32_t number;
+            EdsPropertyID prop_id;
+            std::string argument;
+            std::string name;
+            std::chrono::milliseconds timeout;
+            std::chrono::system_clock::time_point deadline;
+            bool relative_deadline;
+            FocusStacker::Options focus_stack;
+            MotionTrigger::Options motion;
+            ExposureController::Options exposure;
+            CaptureFailureCause failure_cause;
+            CaptureRetryPolicy::Rule retry_rule;
+
+            std::vector<std::size_t> depends_on;
+            State state;
+            std::uint32_t target_value;
+            std::uint32_t outstanding;
+            std::chrono::steady_clock::time_point issue_start;
+            std::chrono::steady_clock::time_point issue_end;
+            std::chrono::steady_clock::time_point done;
+            std::string error;
+        };
+
+        bool _parse(const std::string &line, int line_number, Step &step, std::string &error);
+
+        void _resolve_dependencies();
+
+        bool _ready(const Step &step) const;
+
+        void _issue(Step &step);
+
+        void _poll(Step &step);
+
+        void _complete(Step &step, State state, const std::string &error = "");
+
+        void _attach_camera();
+
+        std::vector<Step> _steps;
+        std::chrono::steady_clock::time_point _start;
+        std::chrono::system_clock::time_point _start_wall;
+        EDSDK::Camera *_camera;
+        std::unique_ptr<CaptureJournal> _journal;
+        std::unique_ptr<DownloadPostProcessor> _post_processor;
+        std::unique_ptr<CaptureWriter> _capture_writer;
+        std::unique_ptr<PropertyReconciler> _reconciler;
+        std::unique_ptr<SessionWatchdog> _watchdog;
+        CaptureRetryPolicy _retry_policy;
+        std::unique_ptr<CardImporter> _importer;
+        std::chrono::steady_clock::time_point _import_reported;
+        std::unique_ptr<FocusStacker> _focus_stacker;
+        std::unique_ptr<MotionTrigger> _motion_trigger;
+        std::unique_ptr<ExposureController> _exposure_controller;
+        std::unique_ptr<LiveViewRecorder> _recorder;
+        std::chrono::steady_clock::time_point _record_end;
+    };
+} //namespace edsdk_w
+
+#endif //BATCH_RUNNER_HPP
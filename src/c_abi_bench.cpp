@@ -0,0 +1,109 @@
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "edsdk_c.h"
+#include "edsdk_wrapper.hpp"
+
+//per-call cost of the C interface against the C++ calls it wraps, needs a connected camera:
+//c_abi_bench [calls] [live view frames]
+//both sides are linked into this binary, a host loading the shared library pays one more indirect jump per call
+namespace {
+    using clock = std::chrono::steady_clock;
+    using namespace edsdk_w;
+
+    std::uint64_t sink = 0;
+
+    template <typename F>
+    void run(const char *name, std::size_t calls, F &&call) {
+        auto start = clock::now();
+        for (std::size_t i = 0; i < calls; i++) {
+            sink += call();
+        }
+        double elapsed_ns = std::chrono::duration<double, std::nano>(clock::now() - start).count();
+        std::cout << std::fixed << std::setprecision(2)
+                  << name << ": " << elapsed_ns / static_cast<double>(calls) << " ns/call" << std::endl;
+    }
+}
+
+int main(int argc, char **argv) {
+    std::size_t calls = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    std::size_t frames = argc > 2 ? std::stoul(argv[2]) : 200;
+
+    edsw_camera *handle = nullptr;
+    if (edsw_select_camera(0, &handle) != EDSW_OK || edsw_camera_open_session(handle) != EDSW_OK) {
+        std::cerr << "no camera" << std::endl;
+        return 1;
+    }
+    auto &camera = EDSDK::get_instance().get_camera()->get();
+    EDSDK::events();
+
+    char text[256];
+    std::uint32_t values[64];
+    std::size_t length = 0;
+
+    for (int round = 0; round < 2; round++) {
+        run("c++ get<ISO>", calls, [&] { return camera.get<Prop::ISO>(); });
+        run("c++ get_property_value", calls, [&] { return camera.get_property_value(kEdsPropID_ISOSpeed).value_or(0); });
+        run("c   edsw_camera_get_property", calls, [&] {
+            std::uint32_t value = 0;
+            edsw_camera_get_property(handle, kEdsPropID_ISOSpeed, &value);
+            return value;
+        });
+
+        run("c++ get_lens_name", calls, [&] { return camera.get_lens_name().size(); });
+        run("c   edsw_camera_get_string", calls, [&] {
+            edsw_camera_get_string(handle, EDSW_LENS_NAME, text, sizeof(text), &length);
+            return length;
+        });
+
+        run("c++ get_property_constraint_values", calls, [&] {
+            return camera.get_property_constraint_values(kEdsPropID_ISOSpeed).size();
+        });
+        run("c   edsw_camera_get_constraints", calls, [&] {
+            edsw_camera_get_constraints(handle, kEdsPropID_ISOSpeed, values, 64, &length);
+            return length;
+        });
+
+        //explained lists allocate per entry on the C++ side, C callers explain only what they show
+        run("c++ get_iso_constraints", calls / 10, [&] { return camera.get_iso_constraints().size(); });
+        run("c   constraints + explain", calls / 10, [&] {
+            std::size_t count = 0, total = 0;
+            edsw_camera_get_constraints(handle, kEdsPropID_ISOSpeed, values, 64, &count);
+            for (std::size_t i = 0; i < count && i < 64; i++) {
+                edsw_explain_prop_value(kEdsPropID_ISOSpeed, values[i], text, sizeof(text), &length);
+                total += length;
+            }
+            return total;
+        });
+    }
+
+    if (frames > 0 && edsw_camera_start_live_view(handle) == EDSW_OK) {
+        //first frames are not ready while the camera starts streaming
+        std::vector<std::uint8_t> frame;
+        for (int i = 0; i < 100 && !camera.download_live_view_frame(frame); i++) {
+            EDSDK::events();
+        }
+
+        run("c++ download_live_view_frame (vector)", frames, [&] {
+            camera.download_live_view_frame(frame);
+            return frame.size();
+        });
+        run("c   acquire + release live view frame", frames, [&] {
+            edsw_buffer *buffer = nullptr;
+            const std::uint8_t *data = nullptr;
+            std::size_t size = 0;
+            if (edsw_camera_acquire_live_view_frame(handle, &buffer, &data, &size) == EDSW_OK) {
+                edsw_buffer_release(buffer);
+            }
+            return size;
+        });
+        edsw_camera_stop_live_view(handle);
+    }
+
+    std::cout << "(checksum " << sink << ")" << std::endl;
+    edsw_camera_close_session(handle);
+    edsw_reset_camera();
+    return 0;
+}
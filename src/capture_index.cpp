@@ -0,0 +1,39 @@
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include "capture_metadata.hpp"
+
+//indexes captures under a directory, one tab separated line per file:
+//capture_index <directory> [threads, 0 = one per cpu]
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        std::cerr << "usage: capture_index <directory> [threads]" << std::endl;
+        return 1;
+    }
+    std::size_t threads = argc > 2 ? std::stoul(argv[2]) : 0;
+
+    std::vector<edsdk_w::CaptureIndexEntry> entries{};
+    edsdk_w::CaptureIndexStats stats{};
+    if (!edsdk_w::index_captures(argv[1], threads, entries, stats)) {
+        std::cerr << "cannot read directory " << argv[1] << std::endl;
+        return 1;
+    }
+
+    std::cout << "path\tformat\tmodel\tbody serial\tlens\tcapture time\texposure s\tf-number\tfocal mm\tiso\n";
+    for (const auto &entry : entries) {
+        const auto &m = entry.metadata;
+        std::cout << entry.path << "\t" << edsdk_w::to_string(m.format);
+        if (entry.parsed) {
+            std::cout << "\t" << m.model << "\t" << m.body_serial << "\t" << m.lens << "\t" << m.capture_time
+                      << "\t" << m.exposure_time << "\t" << m.f_number << "\t" << m.focal_length << "\t" << m.iso;
+        }
+        std::cout << "\n";
+    }
+
+    auto seconds = std::chrono::duration<double>(stats.elapsed).count();
+    std::cerr << std::fixed << std::setprecision(1)
+              << stats.files << " files (" << stats.parsed << " parsed, "
+              << static_cast<double>(stats.bytes) / (1024 * 1024) << " MB mapped) in " << seconds * 1000 << " ms, "
+              << stats.files_per_second() << " files/s" << std::endl;
+    return 0;
+}
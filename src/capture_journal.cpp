@@ -0,0 +1,218 @@
+#include "capture_journal.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include "image_quality.hpp"
+
+namespace edsdk_w {
+    namespace {
+        constexpr char JOURNAL_MAGIC[8] = {'C', 'C', 'T', 'J', 'R', 'N', 'L', '\1'};
+        constexpr std::uint32_t JOURNAL_VERSION = 1;
+        constexpr std::size_t INITIAL_CAPACITY = 4096;
+
+        std::uint64_t elapsed_ns(std::chrono::steady_clock::time_point since) {
+            using namespace std::chrono;
+            return duration_cast<nanoseconds>(steady_clock::now() - since).count();
+        }
+    }
+
+    static_assert(sizeof(CaptureJournal::Record) == 128, "journal record must stay fixed-size");
+
+    CaptureJournal::CaptureJournal(std::size_t sync_every_records, std::chrono::milliseconds sync_interval) :
+            _capacity{0},
+            _count{0},
+            _synced_count{0},
+            _sync_every_records{sync_every_records},
+            _sync_interval{sync_interval},
+            _stats{} {}
+
+    CaptureJournal::~CaptureJournal() {
+        close();
+    }
+
+    bool CaptureJournal::open(const std::string &path) {
+        std::lock_guard lock{_mutex};
+
+        _file.close();
+        _pending.clear();
+        _stats = {};
+
+        if (!_file.open(path, utils::MappedFile::Mode::ReadWrite,
+                        sizeof(Header) + INITIAL_CAPACITY * sizeof(Record))) {
+            return false;
+        }
+
+        auto header = reinterpret_cast<Header *>(_file.data());
+        if (std::memcmp(header->magic, JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC)) != 0) {
+            //new file, ftruncate has already zeroed it
+            std::memcpy(header->magic, JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC));
+            header->version = JOURNAL_VERSION;
+            header->record_size = sizeof(Record);
+            _file.flush(0, sizeof(Header));
+        } else if (header->version != JOURNAL_VERSION || header->record_size != sizeof(Record)) {
+            _file.close();
+            return false;
+        }
+
+        _capacity = (_file.size() - sizeof(Header)) / sizeof(Record);
+        _recover();
+        _synced_count = _count;
+        _last_sync = std::chrono::steady_clock::now();
+
+        return true;
+    }
+
+    void CaptureJournal::close() {
+        std::lock_guard lock{_mutex};
+
+        if (_file.is_open()) {
+            _sync_locked();
+            _file.close();
+        }
+        _capacity = _count = _synced_count = 0;
+    }
+
+    bool CaptureJournal::append(Record record) {
+        auto start = std::chrono::steady_clock::now();
+        std::lock_guard lock{_mutex};
+
+        if (!_file.is_open()) {
+            return false;
+        }
+
+        if (_count == _capacity) {
+            _sync_locked();
+            if (!_file.resize(sizeof(Header) + 2 * _capacity * sizeof(Record))) {
+                return false;
+            }
+            _capacity *= 2;
+        }
+
+        record.sequence = _count + 1;
+        record.timestamp_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+        record.checksum = _checksum(record);
+
+        std::memcpy(_record_at(_count), &record, sizeof(Record));
+        _count++;
+        _track(record);
+
+        //periodic msync, process crash is already covered by the shared mapping
+        if (_count - _synced_count >= _sync_every_records ||
+            std::chrono::steady_clock::now() - _last_sync >= _sync_interval) {
+            _sync_locked();
+        }
+
+        auto ns = elapsed_ns(start);
+        _stats.appends++;
+        _stats.append_ns += ns;
+        _stats.max_append_ns = std::max(_stats.max_append_ns, ns);
+
+        return true;
+    }
+
+    bool CaptureJournal::sync() {
+        std::lock_guard lock{_mutex};
+        return _sync_locked();
+    }
+
+    std::vector<CaptureJournal::Record> CaptureJournal::incomplete_transfers() const {
+        std::lock_guard lock{_mutex};
+
+        std::vector<Record> res{};
+        for (const auto &[body_id, triggers] : _pending) {
+            for (const auto &trigger : triggers) {
+                res.push_back(trigger.record);
+            }
+        }
+        return res;
+    }
+
+    std::vector<CaptureJournal::Record> CaptureJournal::records() const {
+        std::lock_guard lock{_mutex};
+
+        std::vector<Record> res(_count);
+        if (_count > 0) {
+            std::memcpy(res.data(), _file.data() + sizeof(Header), _count * sizeof(Record));
+        }
+        return res;
+    }
+
+    CaptureJournal::Stats CaptureJournal::stats() const {
+        std::lock_guard lock{_mutex};
+        return _stats;
+    }
+
+    double CaptureJournal::mean_append_us() const {
+        std::lock_guard lock{_mutex};
+        return _stats.appends ? static_cast<double>(_stats.append_ns) / 1000 / static_cast<double>(_stats.appends) : 0.0;
+    }
+
+    std::uint32_t CaptureJournal::_checksum(const Record &record) {
+        //FNV-1a over everything except the checksum field itself
+        auto bytes = reinterpret_cast<const std::uint8_t *>(&record);
+        std::uint32_t hash = 2166136261u;
+        for (std::size_t i = sizeof(record.checksum); i < sizeof(Record); i++) {
+            hash = (hash ^ bytes[i]) * 16777619u;
+        }
+        return hash;
+    }
+
+    CaptureJournal::Record *CaptureJournal::_record_at(std::size_t index) {
+        return reinterpret_cast<Record *>(_file.data() + sizeof(Header)) + index;
+    }
+
+    void CaptureJournal::_recover() {
+        //records are valid up to the first empty or torn one
+        _count = 0;
+        while (_count < _capacity) {
+            Record record{};
+            std::memcpy(&record, _record_at(_count), sizeof(Record));
+            if (record.sequence != _count + 1 || record.checksum != _checksum(record)) {
+                break;
+            }
+            _track(record);
+            _count++;
+        }
+
+        //wiping a torn tail, so it is not mistaken for a record after next appends
+        if (_count < _capacity) {
+            std::memset(_record_at(_count), 0, sizeof(Record));
+        }
+    }
+
+    void CaptureJournal::_track(const Record &record) {
+        std::string body_id(record.body_id, strnlen(record.body_id, sizeof(record.body_id)));
+        auto &pending = _pending[body_id];
+
+        switch (record.type) {
+            case RecordType::Triggered:
+                pending.push_back({record, files_per_shot(record.image_quality)});
+                break;
+            case RecordType::Downloaded:
+                //camera reports no capture id, so transfers complete triggers in order, RAW+JPEG after both files
+                if (!pending.empty() && --pending.front().files_left == 0) {
+                    pending.pop_front();
+                }
+                break;
+        }
+    }
+
+    bool CaptureJournal::_sync_locked() {
+        _last_sync = std::chrono::steady_clock::now();
+        if (_synced_count == _count) {
+            return true;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        bool res = _file.flush(sizeof(Header) + _synced_count * sizeof(Record),
+                               (_count - _synced_count) * sizeof(Record));
+        if (res) {
+            _synced_count = _count;
+        }
+
+        _stats.syncs++;
+        _stats.sync_ns += elapsed_ns(start);
+        return res;
+    }
+} //namespace edsdk_w
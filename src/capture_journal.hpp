@@ -0,0 +1,116 @@
+#ifndef CAPTURE_JOURNAL_HPP
+#define CAPTURE_JOURNAL_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "mapped_file.hpp"
+
+namespace edsdk_w {
+    //append-only journal of triggered and downloaded captures, kept in a memory-mapped file
+    //so that records survive a crash of the host process
+    class CaptureJournal {
+    public:
+        enum class RecordType : std::uint16_t {
+            Triggered = 1,
+            Downloaded = 2
+        };
+
+        struct Record {
+            std::uint32_t checksum;
+            RecordType type;
+            std::uint16_t reserved;
+            std::uint64_t sequence;
+            std::int64_t timestamp_ns;
+            char body_id[32];
+
+            std::uint32_t image_quality;
+            std::uint32_t ae_mode;
+            std::uint32_t av;
+            std::uint32_t tv;
+            std::uint32_t iso;
+            std::uint32_t exposure_compensation;
+            std::uint32_t white_balance;
+            std::uint32_t drive_mode;
+
+            //filled for Downloaded records only
+            std::uint64_t file_size;
+            char file_name[32];
+        };
+
+        struct Stats {
+            std::uint64_t appends;
+            std::uint64_t syncs;
+            std::uint64_t append_ns;
+            std::uint64_t max_append_ns;
+            std::uint64_t sync_ns;
+        };
+
+        explicit CaptureJournal(std::size_t sync_every_records = 64,
+                                std::chrono::milliseconds sync_interval = std::chrono::milliseconds{1000});
+        ~CaptureJournal();
+
+        CaptureJournal(const CaptureJournal &) = delete;
+        CaptureJournal &operator=(const CaptureJournal &) = delete;
+
+        //opens or creates journal and runs recovery scan over existing records
+        bool open(const std::string &path);
+        void close();
+
+        //sequence, timestamp and checksum are filled by journal
+        bool append(Record record);
+
+        bool sync();
+
+        //Triggered records whose files have not all been matched by Downloaded records of the same body;
+        //a trigger expects one file per image of its image quality
+        [[nodiscard]] std::vector<Record> incomplete_transfers() const;
+
+        [[nodiscard]] std::vector<Record> records() const;
+
+        [[nodiscard]] Stats stats() const;
+
+        //mean time spent in append(), msync included; sustained throughput is measured by journal_bench
+        [[nodiscard]] double mean_append_us() const;
+
+    private:
+        struct Header {
+            char magic[8];
+            std::uint32_t version;
+            std::uint32_t record_size;
+            std::uint8_t reserved[48];
+        };
+
+        struct PendingTrigger {
+            Record record;
+            std::uint32_t files_left;
+        };
+
+        static std::uint32_t _checksum(const Record &record);
+
+        Record *_record_at(std::size_t index);
+
+        void _recover();
+
+        void _track(const Record &record);
+
+        bool _sync_locked();
+
+        mutable std::mutex _mutex;
+        utils::MappedFile _file;
+        std::size_t _capacity;
+        std::size_t _count;
+        std::size_t _synced_count;
+        std::size_t _sync_every_records;
+        std::chrono::milliseconds _sync_interval;
+        std::chrono::steady_clock::time_point _last_sync;
+        std::map<std::string, std::deque<PendingTrigger>> _pending;
+        Stats _stats;
+    };
+} //namespace edsdk_w
+
+#endif //CAPTURE_JOURNAL_HPP
@@ -0,0 +1,187 @@
+#include "capture_latency.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include "image_quality.hpp"
+
+namespace edsdk_w {
+    namespace {
+        constexpr std::size_t MAX_SAMPLES = 4096;
+        constexpr std::size_t MAX_RECENT = 256;
+
+        //captures whose events never came, e.g. shots the camera dropped
+        constexpr std::size_t MAX_OPEN = 64;
+
+        constexpr std::size_t stage_index(CaptureLatency::Stage stage) {
+            return static_cast<std::size_t>(stage);
+        }
+
+        std::int64_t between(const CaptureLatency::Record &record, CaptureLatency::Stage from, CaptureLatency::Stage to) {
+            auto start = record.stamps_ns[stage_index(from)], end = record.stamps_ns[stage_index(to)];
+            return start && end ? end - start : -1;
+        }
+    }
+
+    CaptureLatency::CaptureLatency() : _next_id{1} {}
+
+    std::uint64_t CaptureLatency::begin(const std::string &body_id, std::uint32_t image_quality, std::uint32_t attempt) {
+        if (_open.size() >= MAX_OPEN) {
+            finish(_open.front().id, true);
+        }
+
+        Record record{};
+        record.id = _next_id++;
+        record.body_id = body_id;
+        record.image_quality = image_quality;
+        record.attempt = attempt;
+        record.files = files_per_shot(image_quality);
+        record.stamps_ns[stage_index(Stage::Issued)] = now_ns();
+        _open.push_back(std::move(record));
+        return _open.back().id;
+    }
+
+    void CaptureLatency::mark(std::uint64_t id, Stage stage) {
+        if (auto record = _open_record(id)) {
+            _stamp(*record, stage);
+        }
+    }
+
+    std::uint64_t CaptureLatency::mark_next(Stage stage) {
+        for (auto &record : _open) {
+            if (record.files_reached[stage_index(stage)] < record.files) {
+                _stamp(record, stage);
+                return record.id;
+            }
+        }
+        return 0;
+    }
+
+    void CaptureLatency::finish(std::uint64_t id, bool failed) {
+        auto it = std::find_if(_open.begin(), _open.end(), [id](const Record &record) { return record.id == id; });
+        if (it == _open.end()) {
+            return;
+        }
+        auto record = std::move(*it);
+        _open.erase(it);
+        record.failed = record.failed || failed;
+
+        auto &group = _groups[{record.body_id, record.image_quality}];
+        group.captures++;
+        if (record.failed) {
+            group.failures++;
+        } else {
+            auto add = [&record](Samples &samples, Stage from, Stage to) {
+                auto value = between(record, from, to);
+                if (value >= 0) {
+                    samples.add(value);
+                }
+            };
+            add(group.command, Stage::Issued, Stage::Returned);
+            add(group.event, Stage::Issued, Stage::ObjectEvent);
+            add(group.transfer, Stage::TransferStart, Stage::TransferEnd);
+            add(group.to_file, Stage::Issued, Stage::TransferEnd);
+        }
+
+        _recent.push_back(std::move(record));
+        if (_recent.size() > MAX_RECENT) {
+            _recent.pop_front();
+        }
+    }
+
+    void CaptureLatency::finish_file(std::uint64_t id, Stage stage, bool failed) {
+        auto record = _open_record(id);
+        if (!record) {
+            return;
+        }
+        record->failed = record->failed || failed;
+        if (record->files_reached[stage_index(stage)] >= record->files) {
+            finish(id);
+        }
+    }
+
+    void CaptureLatency::expire_lost() {
+        auto issued_before = now_ns() - std::chrono::duration_cast<std::chrono::nanoseconds>(LOST_AFTER).count();
+        while (!_open.empty() && _open.front().stamps_ns[stage_index(Stage::Issued)] < issued_before) {
+            finish(_open.front().id, true);
+        }
+    }
+
+    std::optional<CaptureLatency::Record> CaptureLatency::fail_next() {
+        for (const auto &record : _open) {
+            if (record.stamps_ns[stage_index(Stage::ObjectEvent)] == 0) {
+                finish(record.id, true);
+                return _recent.back();
+            }
+        }
+        return std::nullopt;
+    }
+
+    std::vector<CaptureLatency::Group> CaptureLatency::groups() const {
+        std::vector<Group> res{};
+        for (const auto &[key, samples] : _groups) {
+            res.push_back({key.first, key.second, samples.captures, samples.failures,
+                           samples.command.percentiles(), samples.event.percentiles(),
+                           samples.transfer.percentiles(), samples.to_file.percentiles()});
+        }
+        return res;
+    }
+
+    std::size_t CaptureLatency::open_captures() const {
+        return _open.size();
+    }
+
+    const std::deque<CaptureLatency::Record> &CaptureLatency::recent() const {
+        return _recent;
+    }
+
+    std::int64_t CaptureLatency::now_ns() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void CaptureLatency::Samples::add(std::int64_t value) {
+        if (values.size() < MAX_SAMPLES) {
+            values.push_back(value);
+            return;
+        }
+        values[next] = value;
+        next = (next + 1) % MAX_SAMPLES;
+    }
+
+    CaptureLatency::Percentiles CaptureLatency::Samples::percentiles() const {
+        Percentiles res{};
+        res.count = values.size();
+        if (values.empty()) {
+            return res;
+        }
+
+        auto sorted = values;
+        std::sort(sorted.begin(), sorted.end());
+        auto at = [&sorted](double q) {
+            auto index = static_cast<std::size_t>(q * static_cast<double>(sorted.size() - 1) + 0.5);
+            return static_cast<double>(sorted[index]) / 1000;
+        };
+        res.p50_us = at(0.5);
+        res.p90_us = at(0.9);
+        res.p99_us = at(0.99);
+        res.max_us = static_cast<double>(sorted.back()) / 1000;
+        return res;
+    }
+
+    void CaptureLatency::_stamp(Record &record, Stage stage) {
+        //first file stamps a stage, except transfer end which waits for the last file
+        auto index = stage_index(stage);
+        if (record.files_reached[index]++ == 0 || stage == Stage::TransferEnd) {
+            record.stamps_ns[index] = now_ns();
+        }
+    }
+
+    CaptureLatency::Record *CaptureLatency::_open_record(std::uint64_t id) {
+        for (auto &record : _open) {
+            if (record.id == id) {
+                return &record;
+            }
+        }
+        return nullptr;
+    }
+} //namespace edsdk_w
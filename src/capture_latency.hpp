@@ -0,0 +1,129 @@
+#ifndef CAPTURE_LATENCY_HPP
+#define CAPTURE_LATENCY_HPP
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace edsdk_w {
+    //timestamps every capture from shutter command to downloaded file and aggregates latencies
+    //per camera body and image quality
+    //
+    //camera events carry no capture id, so events are matched to the oldest capture still missing
+    //that stage; a RAW+JPEG capture takes events of both its files, the first file stamps item and
+    //transfer start, the last one transfer end; not thread safe, used from the thread pumping EDSDK::events()
+    class CaptureLatency {
+    public:
+        enum class Stage {
+            Issued,        //shutter command sent
+            Returned,      //shutter command returned
+            ObjectEvent,   //camera reported new item
+            TransferStart,
+            TransferEnd,
+            Count
+        };
+
+        static constexpr std::size_t STAGE_COUNT = static_cast<std::size_t>(Stage::Count);
+
+        //captures not finished this long after issue are taken as lost, e.g. their events never came
+        static constexpr std::chrono::milliseconds LOST_AFTER{30000};
+
+        struct Record {
+            std::uint64_t id;
+            std::string body_id;
+            std::uint32_t image_quality;
+            std::uint32_t attempt; //retries of a failed capture get their own records
+            std::uint32_t files;   //expected from image quality
+            std::array<std::int64_t, STAGE_COUNT> stamps_ns; //steady clock, 0 for stages not reached
+            std::array<std::uint32_t, STAGE_COUNT> files_reached;
+            bool failed;
+        };
+
+        struct Percentiles {
+            std::uint64_t count;
+            double p50_us;
+            double p90_us;
+            double p99_us;
+            double max_us;
+        };
+
+        struct Group {
+            std::string body_id;
+            std::uint32_t image_quality;
+            std::uint64_t captures;
+            std::uint64_t failures;
+            Percentiles command;  //issued to returned
+            Percentiles event;    //issued to object event
+            Percentiles transfer; //transfer start to end
+            Percentiles to_file;  //issued to transfer end
+        };
+
+        CaptureLatency();
+
+        //opens a capture stamped as issued, returns its correlation id
+        std::uint64_t begin(const std::string &body_id, std::uint32_t image_quality, std::uint32_t attempt = 0);
+
+        void mark(std::uint64_t id, Stage stage);
+
+        //stamps oldest open capture that has files not at stage yet, returns its id or 0
+        std::uint64_t mark_next(Stage stage);
+
+        //closes capture and adds its latencies to its group
+        void finish(std::uint64_t id, bool failed = false);
+
+        //closes capture once all its files reached stage, a failed file fails the capture
+        void finish_file(std::uint64_t id, Stage stage, bool failed = false);
+
+        //closes captures issued more than LOST_AFTER ago as failed
+        void expire_lost();
+
+        //closes oldest capture camera has not reported an item for, returns it
+        std::optional<Record> fail_next();
+
+        [[nodiscard]] std::vector<Group> groups() const;
+
+        //captures issued and not finished yet
+        [[nodiscard]] std::size_t open_captures() const;
+
+        //most recently closed captures, oldest first
+        [[nodiscard]] const std::deque<Record> &recent() const;
+
+        static std::int64_t now_ns();
+
+    private:
+        //kept per metric, percentiles are taken over the latest samples only
+        struct Samples {
+            std::vector<std::int64_t> values;
+            std::size_t next = 0;
+
+            void add(std::int64_t value);
+            [[nodiscard]] Percentiles percentiles() const;
+        };
+
+        struct GroupSamples {
+            std::uint64_t captures;
+            std::uint64_t failures;
+            Samples command;
+            Samples event;
+            Samples transfer;
+            Samples to_file;
+        };
+
+        static void _stamp(Record &record, Stage stage);
+
+        Record *_open_record(std::uint64_t id);
+
+        std::uint64_t _next_id;
+        std::deque<Record> _open;
+        std::deque<Record> _recent;
+        std::map<std::pair<std::string, std::uint32_t>, GroupSamples> _groups;
+    };
+} //namespace edsdk_w
+
+#endif //CAPTURE_LATENCY_HPP
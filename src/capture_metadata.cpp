@@ -0,0 +1,243 @@
+#include "capture_metadata.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <mutex>
+#include "isobmff.hpp"
+#include "mapped_file.hpp"
+#include "tiff_reader.hpp"
+#include "work_stealing_pool.hpp"
+
+namespace edsdk_w {
+    namespace {
+        namespace tag {
+            constexpr std::uint16_t MAKE = 0x010f;
+            constexpr std::uint16_t MODEL = 0x0110;
+            constexpr std::uint16_t DATE_TIME = 0x0132;
+            constexpr std::uint16_t EXIF_IFD = 0x8769;
+
+            constexpr std::uint16_t EXPOSURE_TIME = 0x829a;
+            constexpr std::uint16_t F_NUMBER = 0x829d;
+            constexpr std::uint16_t ISO = 0x8827;
+            constexpr std::uint16_t DATE_TIME_ORIGINAL = 0x9003;
+            constexpr std::uint16_t FOCAL_LENGTH = 0x920a;
+            constexpr std::uint16_t MAKER_NOTE = 0x927c;
+            constexpr std::uint16_t BODY_SERIAL = 0xa431;
+            constexpr std::uint16_t LENS_MODEL = 0xa434;
+
+            //Canon maker note
+            constexpr std::uint16_t CANON_SERIAL = 0x000c;
+            constexpr std::uint16_t CANON_LENS_MODEL = 0x0095;
+        }
+
+        //uuid of CR3 box holding CMT1..CMT4 metadata boxes
+        constexpr std::uint8_t CR3_METADATA_UUID[16] = {0x85, 0xc0, 0xb6, 0x87, 0x82, 0x0f, 0x11, 0xe0,
+                                                        0x81, 0x11, 0xf4, 0xce, 0x46, 0x2b, 0x6a, 0x48};
+
+        const char *CAPTURE_EXTENSIONS[] = {".cr2", ".cr3", ".jpg", ".jpeg", ".hif", ".heic"};
+
+        //IFD0 of CR2, jpeg EXIF and CR3 CMT1; returns offset of EXIF IFD or 0
+        std::uint32_t parse_ifd0(const TiffReader &tiff, std::uint32_t ifd, CaptureMetadata &metadata) {
+            std::uint32_t exif_ifd = 0;
+            tiff.for_each_entry(ifd, [&](const TiffReader::Entry &entry) {
+                switch (entry.tag) {
+                    case tag::MAKE: metadata.make = tiff.text(entry); break;
+                    case tag::MODEL: metadata.model = tiff.text(entry); break;
+                    case tag::DATE_TIME:
+                        if (metadata.capture_time.empty()) metadata.capture_time = tiff.text(entry);
+                        break;
+                    case tag::EXIF_IFD: exif_ifd = tiff.integer(entry).value_or(0); break;
+                    default: break;
+                }
+            });
+            return exif_ifd;
+        }
+
+        //returns offset of maker note or 0
+        std::uint32_t parse_exif_ifd(const TiffReader &tiff, std::uint32_t ifd, CaptureMetadata &metadata) {
+            std::uint32_t maker_note = 0;
+            tiff.for_each_entry(ifd, [&](const TiffReader::Entry &entry) {
+                switch (entry.tag) {
+                    case tag::EXPOSURE_TIME: metadata.exposure_time = tiff.rational(entry).value_or(0); break;
+                    case tag::F_NUMBER: metadata.f_number = tiff.rational(entry).value_or(0); break;
+                    case tag::FOCAL_LENGTH: metadata.focal_length = tiff.rational(entry).value_or(0); break;
+                    case tag::ISO: metadata.iso = tiff.integer(entry).value_or(0); break;
+                    //original time wins over modification time of IFD0
+                    case tag::DATE_TIME_ORIGINAL: metadata.capture_time = tiff.text(entry); break;
+                    case tag::BODY_SERIAL: metadata.body_serial = tiff.text(entry); break;
+                    case tag::LENS_MODEL: metadata.lens = tiff.text(entry); break;
+                    case tag::MAKER_NOTE: maker_note = static_cast<std::uint32_t>(entry.value_offset); break;
+                    default: break;
+                }
+            });
+            return maker_note;
+        }
+
+        //older bodies leave EXIF serial and lens empty, Canon maker note is a plain IFD
+        void parse_canon_maker_note(const TiffReader &tiff, std::uint32_t ifd, CaptureMetadata &metadata) {
+            tiff.for_each_entry(ifd, [&](const TiffReader::Entry &entry) {
+                if (entry.tag == tag::CANON_SERIAL && metadata.body_serial.empty()) {
+                    auto serial = tiff.integer(entry);
+                    if (serial) metadata.body_serial = std::to_string(*serial);
+                } else if (entry.tag == tag::CANON_LENS_MODEL && metadata.lens.empty()) {
+                    metadata.lens = tiff.text(entry);
+                }
+            });
+        }
+
+        bool parse_tiff(const std::uint8_t *data, std::size_t size, CaptureMetadata &metadata) {
+            TiffReader tiff{data, size};
+            if (!tiff.read_header()) return false;
+
+            auto exif_ifd = parse_ifd0(tiff, tiff.first_ifd(), metadata);
+            if (exif_ifd) {
+                auto maker_note = parse_exif_ifd(tiff, exif_ifd, metadata);
+                if (maker_note && metadata.make.rfind("Canon", 0) == 0) {
+                    parse_canon_maker_note(tiff, maker_note, metadata);
+                }
+            }
+            return !metadata.model.empty() || exif_ifd;
+        }
+
+        //CMT1 is IFD0, CMT2 is EXIF IFD and CMT3 is Canon maker note, each a complete TIFF structure
+        bool parse_cr3(const std::uint8_t *data, std::size_t size, CaptureMetadata &metadata) {
+            bool found = false;
+            isobmff::for_each_box(data, 0, size, [&](const isobmff::Box &moov) {
+                if (!moov.is("moov")) return true;
+
+                isobmff::for_each_box(data, moov.payload, moov.end, [&](const isobmff::Box &uuid) {
+                    if (!isobmff::is_uuid(data, uuid, CR3_METADATA_UUID)) return true;
+
+                    isobmff::for_each_box(data, uuid.payload + 16, uuid.end, [&](const isobmff::Box &box) {
+                        TiffReader tiff{data + box.payload, box.end - box.payload};
+                        if (!(box.is("CMT1") || box.is("CMT2") || box.is("CMT3")) || !tiff.read_header()) {
+                            return true;
+                        }
+
+                        if (box.is("CMT1")) {
+                            parse_ifd0(tiff, tiff.first_ifd(), metadata);
+                            found = true;
+                        } else if (box.is("CMT2")) {
+                            parse_exif_ifd(tiff, tiff.first_ifd(), metadata);
+                            found = true;
+                        } else {
+                            parse_canon_maker_note(tiff, tiff.first_ifd(), metadata);
+                        }
+                        return true;
+                    });
+                    return false;
+                });
+                return false;
+            });
+            return found;
+        }
+
+        bool is_capture(const std::filesystem::path &path) {
+            auto extension = path.extension().string();
+            std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) {
+                return static_cast<char>(std::tolower(c));
+            });
+            return std::any_of(std::begin(CAPTURE_EXTENSIONS), std::end(CAPTURE_EXTENSIONS), [&](const char *known) {
+                return extension == known;
+            });
+        }
+    }
+
+    std::string to_string(CaptureMetadata::Format format) {
+        switch (format) {
+            case CaptureMetadata::Format::Jpeg: return "JPEG";
+            case CaptureMetadata::Format::Cr2: return "CR2";
+            case CaptureMetadata::Format::Cr3: return "CR3";
+            case CaptureMetadata::Format::Heif: return "HEIF";
+            default: return "unknown";
+        }
+    }
+
+    bool parse_capture_metadata(const std::uint8_t *data, std::size_t size, CaptureMetadata &metadata) {
+        metadata = {};
+
+        if (size >= 4 && data[0] == 0xff && data[1] == 0xd8) {
+            metadata.format = CaptureMetadata::Format::Jpeg;
+            std::size_t tiff_offset = 0, tiff_size = 0;
+            return find_jpeg_exif(data, size, tiff_offset, tiff_size) &&
+                   parse_tiff(data + tiff_offset, tiff_size, metadata);
+        }
+        if (size >= 12 && std::memcmp(data + 4, "ftypcrx ", 8) == 0) {
+            metadata.format = CaptureMetadata::Format::Cr3;
+            return parse_cr3(data, size, metadata);
+        }
+        if (size >= 12 && (std::memcmp(data + 4, "ftypheix", 8) == 0 || std::memcmp(data + 4, "ftypmif1", 8) == 0)) {
+            metadata.format = CaptureMetadata::Format::Heif;
+            return false;
+        }
+        //CR2 is TIFF with "CR" marker after the header
+        if (size >= 10 && data[8] == 'C' && data[9] == 'R') {
+            metadata.format = CaptureMetadata::Format::Cr2;
+        }
+        return parse_tiff(data, size, metadata);
+    }
+
+    bool read_capture_metadata(const std::string &path, CaptureMetadata &metadata) {
+        utils::MappedFile file{};
+        if (!file.open(path, utils::MappedFile::Mode::ReadOnly)) {
+            metadata = {};
+            return false;
+        }
+        return parse_capture_metadata(file.data(), file.size(), metadata);
+    }
+
+    double CaptureIndexStats::files_per_second() const {
+        auto seconds = std::chrono::duration<double>(elapsed).count();
+        return seconds > 0 ? static_cast<double>(files) / seconds : 0.0;
+    }
+
+    bool index_captures(const std::string &directory,
+                        std::size_t threads,
+                        std::vector<CaptureIndexEntry> &entries,
+                        CaptureIndexStats &stats) {
+        auto start = std::chrono::steady_clock::now();
+        entries.clear();
+        stats = {};
+
+        std::error_code ec{};
+        std::filesystem::recursive_directory_iterator it{directory,
+                                                         std::filesystem::directory_options::skip_permission_denied,
+                                                         ec};
+        if (ec) {
+            return false;
+        }
+
+        std::mutex mutex{};
+        {
+            utils::WorkStealingPool pool{threads};
+            for (; it != std::filesystem::recursive_directory_iterator{}; it.increment(ec)) {
+                if (ec) break;
+                const auto &file = *it;
+                if (!file.is_regular_file(ec) || !is_capture(file.path())) continue;
+
+                pool.submit([&, path = file.path().string()] {
+                    CaptureIndexEntry entry{path, 0, false, {}};
+                    utils::MappedFile mapped{};
+                    if (mapped.open(path, utils::MappedFile::Mode::ReadOnly)) {
+                        entry.size = mapped.size();
+                        entry.parsed = parse_capture_metadata(mapped.data(), mapped.size(), entry.metadata);
+                    }
+
+                    std::lock_guard lock{mutex};
+                    stats.files++;
+                    stats.parsed += entry.parsed;
+                    stats.bytes += entry.size;
+                    entries.push_back(std::move(entry));
+                });
+            }
+        }
+
+        std::sort(entries.begin(), entries.end(), [](const CaptureIndexEntry &a, const CaptureIndexEntry &b) {
+            return a.path < b.path;
+        });
+        stats.elapsed = std::chrono::steady_clock::now() - start;
+        return true;
+    }
+} //namespace edsdk_w
@@ -0,0 +1,68 @@
+#ifndef CAPTURE_METADATA_HPP
+#define CAPTURE_METADATA_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace edsdk_w {
+    struct CaptureMetadata {
+        enum class Format {
+            Unknown,
+            Jpeg,
+            Cr2,
+            Cr3,
+            Heif
+        };
+
+        Format format = Format::Unknown;
+        std::string make;
+        std::string model;
+        std::string body_serial;
+        std::string lens;
+        //"YYYY:MM:DD HH:MM:SS" as written by camera
+        std::string capture_time;
+        //seconds
+        double exposure_time = 0;
+        double f_number = 0;
+        //millimeters
+        double focal_length = 0;
+        std::uint32_t iso = 0;
+    };
+
+    std::string to_string(CaptureMetadata::Format format);
+
+    //reads EXIF of a capture held in memory, only header structures are touched;
+    //returns false for unsupported formats (HEIF included) and for files without EXIF
+    bool parse_capture_metadata(const std::uint8_t *data, std::size_t size, CaptureMetadata &metadata);
+
+    //maps file read-only, so pixel data is never read from disk
+    bool read_capture_metadata(const std::string &path, CaptureMetadata &metadata);
+
+    struct CaptureIndexEntry {
+        std::string path;
+        std::uint64_t size;
+        bool parsed;
+        CaptureMetadata metadata;
+    };
+
+    struct CaptureIndexStats {
+        std::uint64_t files;
+        std::uint64_t parsed;
+        std::uint64_t bytes;
+        std::chrono::nanoseconds elapsed;
+
+        [[nodiscard]] double files_per_second() const;
+    };
+
+    //parses every capture under directory on a work-stealing pool, 0 threads means one per cpu;
+    //entries are sorted by path
+    bool index_captures(const std::string &directory,
+                        std::size_t threads,
+                        std::vector<CaptureIndexEntry> &entries,
+                        CaptureIndexStats &stats);
+} //namespace edsdk_w
+
+#endif //CAPTURE_METADATA_HPP
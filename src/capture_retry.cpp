@@ -0,0 +1,51 @@
+#include "capture_retry.hpp"
+
+#include <EDSDKErrors.h>
+
+namespace edsdk_w {
+    CaptureFailureCause classify_capture_error(EdsError error) {
+        switch (error) {
+            case EDS_ERR_TAKE_PICTURE_AF_NG:
+                return CaptureFailureCause::Focus;
+            case EDS_ERR_DEVICE_BUSY:
+            case EDS_ERR_TAKE_PICTURE_MIRROR_UP_NG:
+            case EDS_ERR_TAKE_PICTURE_SENSOR_CLEANING_NG:
+                return CaptureFailureCause::Busy;
+            case EDS_ERR_TAKE_PICTURE_NO_CARD_NG:
+            case EDS_ERR_TAKE_PICTURE_CARD_NG:
+            case EDS_ERR_TAKE_PICTURE_CARD_PROTECT_NG:
+                return CaptureFailureCause::Card;
+            case EDS_ERR_TAKE_PICTURE_STROBO_CHARGE_NG:
+                return CaptureFailureCause::Flash;
+            default:
+                return CaptureFailureCause::Other;
+        }
+    }
+
+    std::string to_string(CaptureFailureCause cause) {
+        switch (cause) {
+            case CaptureFailureCause::Focus: return "focus";
+            case CaptureFailureCause::Busy: return "busy";
+            case CaptureFailureCause::Card: return "card";
+            case CaptureFailureCause::Flash: return "flash";
+            default: return "other";
+        }
+    }
+
+    CaptureRetryPolicy::CaptureRetryPolicy() {
+        using std::chrono::milliseconds;
+        set_rule(CaptureFailureCause::Focus, {Action::Refocus, 2, milliseconds{0}});
+        set_rule(CaptureFailureCause::Busy, {Action::Retry, 3, milliseconds{100}});
+        set_rule(CaptureFailureCause::Card, {Action::GiveUp, 0, milliseconds{0}});
+        set_rule(CaptureFailureCause::Flash, {Action::Retry, 2, milliseconds{500}});
+        set_rule(CaptureFailureCause::Other, {Action::Retry, 1, milliseconds{100}});
+    }
+
+    void CaptureRetryPolicy::set_rule(CaptureFailureCause cause, const Rule &rule) {
+        _rules[static_cast<std::size_t>(cause)] = rule;
+    }
+
+    const CaptureRetryPolicy::Rule &CaptureRetryPolicy::rule(CaptureFailureCause cause) const {
+        return _rules[static_cast<std::size_t>(cause)];
+    }
+} //namespace edsdk_w
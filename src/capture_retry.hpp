@@ -0,0 +1,75 @@
+#ifndef CAPTURE_RETRY_HPP
+#define CAPTURE_RETRY_HPP
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include "EDSDKTypes.h"
+
+namespace edsdk_w {
+    enum class CaptureFailureCause {
+        Focus,
+        Busy,
+        Card,
+        Flash,
+        Other,
+        Count
+    };
+
+    constexpr std::size_t CAPTURE_FAILURE_CAUSE_COUNT = static_cast<std::size_t>(CaptureFailureCause::Count);
+
+    //error of shutter command or parameter of capture error event
+    CaptureFailureCause classify_capture_error(EdsError error);
+
+    std::string to_string(CaptureFailureCause cause);
+
+    struct CaptureFailure {
+        std::uint64_t capture_id; //correlation id of CaptureLatency, 0 if no capture was open
+        EdsError error;
+        CaptureFailureCause cause;
+        bool reported_by_event;   //camera accepted the shot and failed it later
+        std::uint32_t attempt;    //0 for the requested shot, then retries
+        bool will_retry;
+    };
+
+    class CaptureRetryPolicy {
+    public:
+        enum class Action {
+            GiveUp,
+            Retry,
+            Refocus //half-press to acquire focus again, then retry
+        };
+
+        struct Rule {
+            Action action;
+            std::uint32_t max_retries;
+            std::chrono::milliseconds delay;
+        };
+
+        //refocus on focus failures, wait out busy camera and flash charging, give up on card errors
+        CaptureRetryPolicy();
+
+        void set_rule(CaptureFailureCause cause, const Rule &rule);
+
+        [[nodiscard]] const Rule &rule(CaptureFailureCause cause) const;
+
+    private:
+        std::array<Rule, CAPTURE_FAILURE_CAUSE_COUNT> _rules;
+    };
+
+    struct CaptureFailureStats {
+        struct Cause {
+            std::uint64_t failures;
+            std::uint64_t retries;
+            std::uint64_t given_up;
+        };
+
+        std::uint64_t requested; //shutter_button() calls
+        std::uint64_t attempts;  //shutter presses, retries included
+        std::uint64_t given_up;
+        std::array<Cause, CAPTURE_FAILURE_CAUSE_COUNT> causes;
+    };
+} //namespace edsdk_w
+
+#endif //CAPTURE_RETRY_HPP
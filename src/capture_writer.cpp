@@ -0,0 +1,471 @@
+#include "capture_writer.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <malloc.h>
+#else
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+namespace edsdk_w {
+    namespace {
+        //sector size required by direct io on every file system we write to
+        constexpr std::size_t ALIGNMENT = 4096;
+
+        std::size_t align_up(std::size_t value) {
+            return (value + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+        }
+
+        std::uint8_t *allocate_aligned(std::size_t size) {
+#ifdef _WIN32
+            return static_cast<std::uint8_t *>(_aligned_malloc(size, ALIGNMENT));
+#else
+            void *res = nullptr;
+            return posix_memalign(&res, ALIGNMENT, size) == 0 ? static_cast<std::uint8_t *>(res) : nullptr;
+#endif
+        }
+
+        void free_aligned(std::uint8_t *data) {
+#ifdef _WIN32
+            _aligned_free(data);
+#else
+            std::free(data);
+#endif
+        }
+    }
+
+    struct CaptureWriter::Buffer {
+        std::uint8_t *data;
+        std::uint64_t offset;
+        //capture bytes and bytes actually written, which differ by padding in direct io mode
+        std::size_t length;
+        std::size_t write_length;
+        std::chrono::steady_clock::time_point submitted;
+        bool held;
+        bool in_flight;
+#ifndef _WIN32
+        iovec iov;
+#endif
+    };
+
+#ifdef __linux__
+    //minimal io_uring over raw syscalls, only writev is used
+    struct CaptureWriter::Ring {
+        ~Ring() {
+            if (sqes != MAP_FAILED) munmap(sqes, sqes_size);
+            if (cq_ring != MAP_FAILED && cq_ring != sq_ring) munmap(cq_ring, cq_ring_size);
+            if (sq_ring != MAP_FAILED) munmap(sq_ring, sq_ring_size);
+            if (fd >= 0) ::close(fd);
+        }
+
+        bool init(unsigned entries) {
+            io_uring_params params{};
+            fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+            if (fd < 0) {
+                return false;
+            }
+
+            sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+            cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+            bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+            if (single_mmap) {
+                sq_ring_size = cq_ring_size = std::max(sq_ring_size, cq_ring_size);
+            }
+
+            sq_ring = mmap(nullptr, sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+            if (sq_ring == MAP_FAILED) return false;
+            cq_ring = single_mmap ? sq_ring : mmap(nullptr, cq_ring_size, PROT_READ | PROT_WRITE,
+                                                   MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+            if (cq_ring == MAP_FAILED) return false;
+            sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+            sqes = mmap(nullptr, sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+            if (sqes == MAP_FAILED) return false;
+
+            auto sq = static_cast<std::uint8_t *>(sq_ring);
+            sq_tail = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+            sq_mask = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+            sq_array = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+            auto cq = static_cast<std::uint8_t *>(cq_ring);
+            cq_head = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+            cq_tail = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+            cq_mask = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+            cqes = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+            return true;
+        }
+
+        //ring has at least as many entries as buffers, so queue is never full
+        void push_writev(int file, const iovec *iov, std::uint64_t offset, std::uint64_t user_data) {
+            unsigned tail = *sq_tail;
+            unsigned index = tail & *sq_mask;
+            auto &sqe = static_cast<io_uring_sqe *>(sqes)[index];
+            std::memset(&sqe, 0, sizeof(sqe));
+            sqe.opcode = IORING_OP_WRITEV;
+            sqe.fd = file;
+            sqe.addr = reinterpret_cast<std::uint64_t>(iov);
+            sqe.len = 1;
+            sqe.off = offset;
+            sqe.user_data = user_data;
+            sq_array[index] = index;
+            __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+            pending++;
+        }
+
+        //submits pushed entries and optionally waits for completions
+        bool enter(unsigned wait_nr) {
+            while (true) {
+                auto res = syscall(__NR_io_uring_enter, fd, pending, wait_nr, wait_nr ? IORING_ENTER_GETEVENTS : 0, nullptr, 0);
+                if (res >= 0) {
+                    pending -= static_cast<unsigned>(res);
+                    return true;
+                }
+                if (errno != EINTR) {
+                    return false;
+                }
+            }
+        }
+
+        template <typename Visitor>
+        void reap(Visitor &&visitor) {
+            unsigned head = *cq_head;
+            unsigned tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+            for (; head != tail; head++) {
+                const auto &cqe = cqes[head & *cq_mask];
+                visitor(cqe.user_data, cqe.res);
+            }
+            __atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+        }
+
+        int fd = -1;
+        void *sq_ring = MAP_FAILED;
+        std::size_t sq_ring_size = 0;
+        void *cq_ring = MAP_FAILED;
+        std::size_t cq_ring_size = 0;
+        void *sqes = MAP_FAILED;
+        std::size_t sqes_size = 0;
+        unsigned *sq_tail = nullptr;
+        unsigned *sq_mask = nullptr;
+        unsigned *sq_array = nullptr;
+        unsigned *cq_head = nullptr;
+        unsigned *cq_tail = nullptr;
+        unsigned *cq_mask = nullptr;
+        io_uring_cqe *cqes = nullptr;
+        unsigned pending = 0;
+    };
+#else
+    struct CaptureWriter::Ring {};
+#endif
+
+    double CaptureWriter::Stats::mb_per_second() const {
+        return busy_ns ? static_cast<double>(bytes) / (1024 * 1024) / (static_cast<double>(busy_ns) / 1e9) : 0.0;
+    }
+
+    CaptureWriter::CaptureWriter() : CaptureWriter(Options{}) {}
+
+    CaptureWriter::CaptureWriter(const Options &options) : _options{options},
+                                                           _file_size_hint{0},
+                                                           _next_offset{0},
+                                                           _in_flight{0},
+                                                           _file_failed{false},
+                                                           _stats{} {
+        _options.chunk_size = align_up(std::max<std::size_t>(_options.chunk_size, 1));
+        _options.buffer_count = std::max<std::size_t>(_options.buffer_count, 1);
+
+        for (std::size_t i = 0; i < _options.buffer_count; i++) {
+            auto data = allocate_aligned(_options.chunk_size);
+            if (!data) break;
+            Buffer buffer{};
+            buffer.data = data;
+            _buffers.push_back(buffer);
+        }
+
+#ifdef __linux__
+        if (_options.async_io) {
+            _ring = std::make_unique<Ring>();
+            if (!_ring->init(static_cast<unsigned>(_buffers.size()))) {
+                _ring.reset();
+            }
+        }
+#endif
+    }
+
+    CaptureWriter::~CaptureWriter() {
+        close();
+        for (auto &buffer : _buffers) {
+            free_aligned(buffer.data);
+        }
+    }
+
+    bool CaptureWriter::open(const std::string &path, std::uint64_t size) {
+        close();
+        //preallocation in _open_file reads the hint
+        _file_size_hint = size;
+        if (_buffers.empty() || !_open_file(path)) {
+            return false;
+        }
+
+        _next_offset = 0;
+        _file_failed = false;
+        _opened = std::chrono::steady_clock::now();
+        return true;
+    }
+
+    std::uint8_t *CaptureWriter::acquire_buffer() {
+#ifdef _WIN32
+        if (!_file) return nullptr;
+#else
+        if (_fd < 0) return nullptr;
+#endif
+
+        while (true) {
+            for (auto &buffer : _buffers) {
+                if (!buffer.held && !buffer.in_flight) {
+                    buffer.held = true;
+                    return buffer.data;
+                }
+            }
+            auto wait_start = std::chrono::steady_clock::now();
+            bool reaped = _in_flight > 0 && _reap(true);
+            _stats.blocked_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - wait_start).count();
+            if (!reaped) {
+                return nullptr;
+            }
+        }
+    }
+
+    bool CaptureWriter::submit(std::uint8_t *data, std::size_t length) {
+        auto buffer = _find(data);
+        if (!buffer || !buffer->held || length > _options.chunk_size) {
+            return false;
+        }
+        buffer->held = false;
+        if (length == 0) {
+            return true;
+        }
+
+        buffer->offset = _next_offset;
+        buffer->length = length;
+        buffer->write_length = _options.direct_io ? align_up(length) : length;
+        std::memset(buffer->data + length, 0, buffer->write_length - length);
+        buffer->submitted = std::chrono::steady_clock::now();
+        _next_offset += length;
+
+#ifdef __linux__
+        if (_ring) {
+            buffer->iov = {buffer->data, buffer->write_length};
+            buffer->in_flight = true;
+            _in_flight++;
+            _ring->push_writev(_fd, &buffer->iov, buffer->offset, static_cast<std::uint64_t>(buffer - _buffers.data()));
+            //if kernel refuses submission now, the entry stays queued and goes with the next enter
+            _ring->enter(0);
+            _reap(false);
+            return !_file_failed;
+        }
+#endif
+        _complete(*buffer, _write_sync(*buffer));
+        _stats.blocked_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - buffer->submitted).count();
+        return !_file_failed;
+    }
+
+    bool CaptureWriter::close() {
+#ifdef _WIN32
+        if (!_file) return false;
+#else
+        if (_fd < 0) return false;
+#endif
+
+        while (_in_flight > 0 && _reap(true)) {}
+        for (auto &buffer : _buffers) {
+            buffer.held = false;
+        }
+
+        _close_file(_next_offset);
+        _stats.files++;
+        _stats.busy_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - _opened).count();
+        return !_file_failed && _in_flight == 0;
+    }
+
+    std::size_t CaptureWriter::chunk_size() const {
+        return _options.chunk_size;
+    }
+
+    bool CaptureWriter::uses_io_uring() const {
+        return _ring != nullptr;
+    }
+
+    CaptureWriter::Stats CaptureWriter::stats() const {
+        auto res = _stats;
+        if (_latencies_us.empty()) {
+            return res;
+        }
+
+        auto latencies = _latencies_us;
+        auto percentile = [&latencies](double p) {
+            auto nth = latencies.begin() + static_cast<std::ptrdiff_t>(p * static_cast<double>(latencies.size() - 1));
+            std::nth_element(latencies.begin(), nth, latencies.end());
+            return *nth;
+        };
+        res.p50_latency_us = percentile(0.5);
+        res.p99_latency_us = percentile(0.99);
+        res.max_latency_us = *std::max_element(latencies.begin(), latencies.end());
+        return res;
+    }
+
+    CaptureWriter::Buffer *CaptureWriter::_find(const std::uint8_t *data) {
+        for (auto &buffer : _buffers) {
+            if (buffer.data == data) {
+                return &buffer;
+            }
+        }
+        return nullptr;
+    }
+
+    void CaptureWriter::_complete(Buffer &buffer, bool ok) {
+        auto latency = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - buffer.submitted).count();
+        _latencies_us.push_back(static_cast<std::uint32_t>(latency));
+        _stats.chunks++;
+        if (ok) {
+            _stats.bytes += buffer.length;
+        } else {
+            _stats.failed_writes++;
+            _file_failed = true;
+        }
+        buffer.in_flight = false;
+
+#ifdef __linux__
+        //starting writeback per chunk keeps dirty page cache of a long burst small
+        if (ok && !_options.direct_io) {
+            sync_file_range(_fd, static_cast<off_t>(buffer.offset), static_cast<off_t>(buffer.length), SYNC_FILE_RANGE_WRITE);
+        }
+#endif
+    }
+
+    bool CaptureWriter::_reap(bool wait) {
+#ifdef __linux__
+        if (!_ring || (wait && !_ring->enter(1))) {
+            return false;
+        }
+        _ring->reap([this](std::uint64_t index, std::int32_t res) {
+            auto &buffer = _buffers[index];
+            _in_flight--;
+            if (res < 0) {
+                _complete(buffer, false);
+            } else if (static_cast<std::size_t>(res) < buffer.write_length) {
+                _complete(buffer, _write_sync(buffer, static_cast<std::size_t>(res)));
+            } else {
+                _complete(buffer, true);
+            }
+        });
+        return true;
+#else
+        return false;
+#endif
+    }
+
+#ifdef _WIN32
+    bool CaptureWriter::_open_file(const std::string &path) {
+        DWORD flags = FILE_ATTRIBUTE_NORMAL | (_options.direct_io ? FILE_FLAG_NO_BUFFERING | FILE_FLAG_WRITE_THROUGH : 0);
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, flags, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+        _file = file;
+
+        FILE_ALLOCATION_INFO allocation{};
+        allocation.AllocationSize.QuadPart = static_cast<LONGLONG>(_file_size_hint);
+        SetFileInformationByHandle(file, FileAllocationInfo, &allocation, sizeof(allocation));
+        return true;
+    }
+
+    void CaptureWriter::_close_file(std::uint64_t final_size) {
+        LARGE_INTEGER size{};
+        size.QuadPart = static_cast<LONGLONG>(final_size);
+        SetFilePointerEx(_file, size, nullptr, FILE_BEGIN);
+        SetEndOfFile(_file);
+        CloseHandle(_file);
+        _file = nullptr;
+    }
+
+    bool CaptureWriter::_write_sync(Buffer &buffer, std::size_t done) {
+        while (done < buffer.write_length) {
+            OVERLAPPED overlapped{};
+            auto offset = buffer.offset + done;
+            overlapped.Offset = static_cast<DWORD>(offset);
+            overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+            DWORD written = 0;
+            if (!WriteFile(_file, buffer.data + done, static_cast<DWORD>(buffer.write_length - done), &written, &overlapped) ||
+                written == 0) {
+                return false;
+            }
+            done += written;
+        }
+        return true;
+    }
+#else
+    bool CaptureWriter::_open_file(const std::string &path) {
+        int flags = O_WRONLY | O_CREAT | O_TRUNC;
+#ifdef O_DIRECT
+        if (_options.direct_io) {
+            _fd = ::open(path.c_str(), flags | O_DIRECT, 0644);
+        }
+#endif
+        //file systems like tmpfs reject O_DIRECT, padded writes still work through page cache
+        if (_fd < 0) {
+            _fd = ::open(path.c_str(), flags, 0644);
+        }
+        if (_fd < 0) {
+            return false;
+        }
+
+#ifdef __linux__
+        //reserves extents up front, best effort as not every file system supports it
+        if (_file_size_hint > 0) {
+            fallocate(_fd, 0, 0, static_cast<off_t>(_file_size_hint));
+        }
+#endif
+        return true;
+    }
+
+    void CaptureWriter::_close_file(std::uint64_t final_size) {
+        //drops preallocated tail and direct io padding
+        if (ftruncate(_fd, static_cast<off_t>(final_size)) != 0) {
+            _file_failed = true;
+        }
+#ifdef __linux__
+        //pages already written back are released, so long sessions do not fill page cache with captures
+        if (!_options.direct_io) {
+            posix_fadvise(_fd, 0, 0, POSIX_FADV_DONTNEED);
+        }
+#endif
+        ::close(_fd);
+        _fd = -1;
+    }
+
+    bool CaptureWriter::_write_sync(Buffer &buffer, std::size_t done) {
+        while (done < buffer.write_length) {
+            auto res = pwrite(_fd, buffer.data + done, buffer.write_length - done, static_cast<off_t>(buffer.offset + done));
+            if (res < 0 && errno == EINTR) continue;
+            if (res <= 0) return false;
+            done += static_cast<std::size_t>(res);
+        }
+        return true;
+    }
+#endif
+} //namespace edsdk_w
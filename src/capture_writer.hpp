@@ -0,0 +1,106 @@
+#ifndef CAPTURE_WRITER_HPP
+#define CAPTURE_WRITER_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace edsdk_w {
+    //writes a capture file chunk by chunk from a pool of aligned buffers:
+    //file is preallocated to the size reported by camera, chunks are written asynchronously
+    //through io_uring on Linux (synchronous positional writes elsewhere or when io_uring is unavailable),
+    //direct_io bypasses page cache
+    class CaptureWriter {
+    public:
+        struct Options {
+            //rounded up to a multiple of 4 KiB
+            std::size_t chunk_size = 4 * 1024 * 1024;
+            std::size_t buffer_count = 8;
+            bool direct_io = false;
+            bool async_io = true;
+        };
+
+        struct Stats {
+            std::uint64_t files;
+            std::uint64_t bytes;
+            std::uint64_t chunks;
+            std::uint64_t failed_writes;
+            //sum of open-to-close time of files
+            std::uint64_t busy_ns;
+            //time caller spent waiting for a free buffer or a synchronous write
+            std::uint64_t blocked_ns;
+            //submit to completion of a chunk
+            std::uint32_t p50_latency_us;
+            std::uint32_t p99_latency_us;
+            std::uint32_t max_latency_us;
+
+            [[nodiscard]] double mb_per_second() const;
+        };
+
+        CaptureWriter();
+        explicit CaptureWriter(const Options &options);
+        ~CaptureWriter();
+
+        CaptureWriter(const CaptureWriter &) = delete;
+        CaptureWriter &operator=(const CaptureWriter &) = delete;
+
+        //one file at a time, size is a preallocation hint, the file ends up with the bytes actually written
+        bool open(const std::string &path, std::uint64_t size);
+
+        //free buffer of chunk_size() bytes, waits for an in-flight write when all are busy
+        std::uint8_t *acquire_buffer();
+
+        //queues buffer to be written after previously submitted chunks, buffer returns to pool once written
+        bool submit(std::uint8_t *buffer, std::size_t length);
+
+        //waits for outstanding writes, returns false if any write of the file failed
+        bool close();
+
+        [[nodiscard]] std::size_t chunk_size() const;
+
+        [[nodiscard]] bool uses_io_uring() const;
+
+        [[nodiscard]] Stats stats() const;
+
+    private:
+        struct Buffer;
+        struct Ring;
+
+        Buffer *_find(const std::uint8_t *data);
+
+        //writes the rest of buffer starting at done bytes
+        bool _write_sync(Buffer &buffer, std::size_t done = 0);
+
+        void _complete(Buffer &buffer, bool ok);
+
+        //collects finished io_uring writes, blocks for at least one if wait is set
+        bool _reap(bool wait);
+
+        bool _open_file(const std::string &path);
+        void _close_file(std::uint64_t final_size);
+
+        Options _options;
+        std::vector<Buffer> _buffers;
+        std::unique_ptr<Ring> _ring;
+
+        std::uint64_t _file_size_hint;
+        std::uint64_t _next_offset;
+        std::size_t _in_flight;
+        bool _file_failed;
+        std::chrono::steady_clock::time_point _opened;
+
+        Stats _stats;
+        std::vector<std::uint32_t> _latencies_us;
+
+#ifdef _WIN32
+        void *_file = nullptr;
+#else
+        int _fd = -1;
+#endif
+    };
+} //namespace edsdk_w
+
+#endif //CAPTURE_WRITER_HPP
@@ -0,0 +1,96 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "capture_writer.hpp"
+
+//sustained write of a continuous-drive burst:
+//capture_writer_bench <directory> [files] [file_mb] [buffered|direct] [uring|sync|stream]
+//stream is the plain buffered ofstream path used without a capture writer
+namespace {
+    using clock = std::chrono::steady_clock;
+
+    void report(const std::string &mode, std::uint64_t bytes, double seconds, std::vector<std::uint32_t> latencies) {
+        std::sort(latencies.begin(), latencies.end());
+        auto at = [&latencies](double p) {
+            return latencies.empty() ? 0u : latencies[static_cast<std::size_t>(p * static_cast<double>(latencies.size() - 1))];
+        };
+        std::cout << std::fixed << std::setprecision(1)
+                  << mode << ": " << static_cast<double>(bytes) / (1024 * 1024) / seconds << " MB/s, chunk latency p50 "
+                  << at(0.5) << " us, p99 " << at(0.99) << " us, max " << (latencies.empty() ? 0u : latencies.back()) << " us"
+                  << std::endl;
+    }
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        std::cerr << "usage: capture_writer_bench <directory> [files] [file_mb] [buffered|direct] [uring|sync|stream]" << std::endl;
+        return 1;
+    }
+    std::filesystem::path directory = argv[1];
+    int files = argc > 2 ? std::stoi(argv[2]) : 64;
+    std::size_t file_size = (argc > 3 ? std::stoul(argv[3]) : 30) * 1024 * 1024;
+    bool direct = argc > 4 && std::string{argv[4]} == "direct";
+    std::string io = argc > 5 ? argv[5] : "uring";
+
+    std::filesystem::create_directories(directory);
+    //odd size, so the last chunk of every file is partial like real captures
+    file_size += 12345;
+
+    if (io == "stream") {
+        std::vector<char> chunk(4 * 1024 * 1024, 0x5a);
+        std::vector<std::uint32_t> latencies{};
+        auto start = clock::now();
+        for (int i = 0; i < files; i++) {
+            std::ofstream file{directory / ("IMG_" + std::to_string(i) + ".CR3"), std::ios::binary | std::ios::trunc};
+            for (std::size_t done = 0; done < file_size; done += chunk.size()) {
+                auto write_start = clock::now();
+                file.write(chunk.data(), static_cast<std::streamsize>(std::min(chunk.size(), file_size - done)));
+                latencies.push_back(static_cast<std::uint32_t>(
+                        std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - write_start).count()));
+            }
+        }
+        report("ofstream", static_cast<std::uint64_t>(files) * file_size,
+               std::chrono::duration<double>(clock::now() - start).count(), latencies);
+    } else {
+        edsdk_w::CaptureWriter::Options options{};
+        options.direct_io = direct;
+        options.async_io = io == "uring";
+        edsdk_w::CaptureWriter writer{options};
+
+        for (int i = 0; i < files; i++) {
+            if (!writer.open((directory / ("IMG_" + std::to_string(i) + ".CR3")).string(), file_size)) {
+                std::cerr << "cannot open file in " << directory << std::endl;
+                return 1;
+            }
+            for (std::size_t done = 0; done < file_size; done += writer.chunk_size()) {
+                auto buffer = writer.acquire_buffer();
+                auto length = std::min(writer.chunk_size(), file_size - done);
+                std::memset(buffer, i & 0xff, length);
+                writer.submit(buffer, length);
+            }
+            if (!writer.close()) {
+                std::cerr << "write failed" << std::endl;
+                return 1;
+            }
+        }
+
+        auto stats = writer.stats();
+        std::cout << std::fixed << std::setprecision(1)
+                  << (writer.uses_io_uring() ? "io_uring" : "pwrite") << (direct ? " direct" : " buffered") << ": "
+                  << stats.mb_per_second() << " MB/s over " << stats.files << " files, chunk latency p50 "
+                  << stats.p50_latency_us << " us, p99 " << stats.p99_latency_us << " us, max " << stats.max_latency_us
+                  << " us, writer blocked " << static_cast<double>(stats.blocked_ns) * 100 / static_cast<double>(stats.busy_ns)
+                  << "% of time, failed writes " << stats.failed_writes << std::endl;
+    }
+
+    for (int i = 0; i < files; i++) {
+        std::filesystem::remove(directory / ("IMG_" + std::to_string(i) + ".CR3"));
+    }
+    return 0;
+}
@@ -0,0 +1,151 @@
+#include "card_importer.hpp"
+
+#include <filesystem>
+#include <utility>
+
+namespace edsdk_w {
+    namespace {
+        constexpr std::size_t LIST_PAGE_SIZE = 64;
+
+        //files known ahead of transfers, enough to keep queue filled between listing pages
+        constexpr std::size_t LOOKAHEAD_FILES = 128;
+    }
+
+    double CardImporter::Progress::mb_per_second() const {
+        return elapsed_seconds > 0 ? static_cast<double>(bytes_imported) / (1024 * 1024) / elapsed_seconds : 0;
+    }
+
+    double CardImporter::Progress::eta_seconds() const {
+        if (bytes_imported == 0 || elapsed_seconds <= 0) {
+            return -1;
+        }
+        auto remaining = bytes_queued - bytes_imported - bytes_failed;
+        return static_cast<double>(remaining) * elapsed_seconds / static_cast<double>(bytes_imported);
+    }
+
+    CardImporter::CardImporter(EDSDK::Camera &camera, std::string directory, std::string manifest_path) :
+            _camera{camera},
+            _directory{std::move(directory)},
+            _manifest_path{std::move(manifest_path)},
+            _progress{} {
+        if (_manifest_path.empty()) {
+            _manifest_path = (std::filesystem::path(_directory) / "import_manifest.txt").string();
+        }
+    }
+
+    bool CardImporter::start() {
+        std::error_code ec;
+        std::filesystem::create_directories(_directory, ec);
+        if (ec) {
+            return false;
+        }
+
+        //a line torn by a crash matches no entry, so that file is simply imported again
+        std::ifstream manifest{_manifest_path};
+        for (std::string line; std::getline(manifest, line);) {
+            _imported.insert(line);
+        }
+        manifest.close();
+
+        _manifest.open(_manifest_path, std::ios::app);
+        if (!_manifest) {
+            return false;
+        }
+
+        _folders.clear();
+        _files.clear();
+        _folders.push_back({"", 0});
+        _progress = {};
+        _start = std::chrono::steady_clock::now();
+        return true;
+    }
+
+    bool CardImporter::step() {
+        if (_files.size() < LOOKAHEAD_FILES && !_folders.empty()) {
+            _list_page();
+        }
+        while (_files.empty() && !_folders.empty()) {
+            _list_page();
+        }
+        if (_folders.empty()) {
+            _progress.listing_done = true;
+        }
+        if (_files.empty()) {
+            return false;
+        }
+
+        auto entry = std::move(_files.front());
+        _files.pop_front();
+        _import(entry);
+        return !_files.empty() || !_folders.empty();
+    }
+
+    CardImporter::Progress CardImporter::progress() const {
+        auto res = _progress;
+        res.elapsed_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - _start).count();
+        return res;
+    }
+
+    void CardImporter::_list_page() {
+        auto &cursor = _folders.front();
+        std::size_t total = 0;
+        if (!_camera.storage().list(cursor.path, cursor.offset, LIST_PAGE_SIZE, _page, &total)) {
+            //volume without DCIM or folder removed meanwhile
+            _folders.pop_front();
+            return;
+        }
+
+        bool volumes = cursor.path.empty();
+        for (auto &entry : _page) {
+            if (volumes) {
+                _folders.push_back({entry.path + "/DCIM", 0});
+            } else if (entry.folder) {
+                _folders.push_back({entry.path, 0});
+            } else if (_imported.count(_manifest_key(entry))) {
+                _progress.files_skipped++;
+                _progress.bytes_skipped += entry.size;
+            } else {
+                _progress.files_queued++;
+                _progress.bytes_queued += entry.size;
+                _files.push_back(std::move(entry));
+            }
+        }
+
+        cursor.offset += LIST_PAGE_SIZE;
+        if (cursor.offset >= total) {
+            _folders.pop_front();
+        }
+    }
+
+    bool CardImporter::_import(const StorageEntry &entry) {
+        auto target = std::filesystem::path(_directory) / entry.path;
+        auto partial = target;
+        partial += ".part";
+
+        //file appears under its name only when complete, leftovers of interrupted run are overwritten
+        std::error_code ec;
+        std::filesystem::create_directories(target.parent_path(), ec);
+        auto item = ec ? nullptr : _camera.storage().item(entry.path);
+        bool res = item && _camera.download_item(item, entry.size, partial.string());
+        if (res) {
+            std::filesystem::rename(partial, target, ec);
+            res = !ec;
+        }
+
+        if (!res) {
+            std::filesystem::remove(partial, ec);
+            _progress.files_failed++;
+            _progress.bytes_failed += entry.size;
+            return false;
+        }
+
+        _manifest << _manifest_key(entry) << '\n' << std::flush;
+        _progress.files_imported++;
+        _progress.bytes_imported += entry.size;
+        return true;
+    }
+
+    std::string CardImporter::_manifest_key(const StorageEntry &entry) {
+        return std::to_string(entry.size) + '\t' + std::to_string(entry.date_time) + '\t' + entry.path;
+    }
+} //namespace edsdk_w
@@ -0,0 +1,83 @@
+#ifndef CARD_IMPORTER_HPP
+#define CARD_IMPORTER_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <string>
+#include <unordered_set>
+#include "edsdk_wrapper.hpp"
+#include "storage_browser.hpp"
+
+namespace edsdk_w {
+    //copies DCIM contents of camera card into directory, keeping card layout
+    //
+    //imported files are recorded in a manifest keyed by card path, size and date, so an interrupted
+    //import continues where it stopped and a repeated one copies only new files; card listing runs
+    //ahead of transfers a page at a time instead of walking the whole card first
+    class CardImporter {
+    public:
+        struct Progress {
+            std::uint64_t files_queued;
+            std::uint64_t files_imported;
+            std::uint64_t files_skipped;
+            std::uint64_t files_failed;
+            std::uint64_t bytes_queued;
+            std::uint64_t bytes_imported;
+            std::uint64_t bytes_skipped;
+            std::uint64_t bytes_failed;
+            bool listing_done;
+            double elapsed_seconds;
+
+            [[nodiscard]] double mb_per_second() const;
+
+            //negative while nothing is transferred yet; lower bound until listing is done
+            [[nodiscard]] double eta_seconds() const;
+        };
+
+        //manifest defaults to "import_manifest.txt" inside directory
+        CardImporter(EDSDK::Camera &camera, std::string directory, std::string manifest_path = "");
+
+        CardImporter(const CardImporter &) = delete;
+        CardImporter &operator=(const CardImporter &) = delete;
+
+        //creates directory and loads manifest of earlier runs
+        bool start();
+
+        //lists ahead and imports one file, returns false when nothing is left;
+        //must be called from the thread pumping EDSDK::events()
+        bool step();
+
+        [[nodiscard]] Progress progress() const;
+
+    private:
+        struct Cursor {
+            std::string path;
+            std::size_t offset;
+        };
+
+        //lists next page of the oldest pending folder
+        void _list_page();
+
+        bool _import(const StorageEntry &entry);
+
+        static std::string _manifest_key(const StorageEntry &entry);
+
+        EDSDK::Camera &_camera;
+        std::string _directory;
+        std::string _manifest_path;
+
+        std::unordered_set<std::string> _imported;
+        std::ofstream _manifest;
+
+        std::deque<Cursor> _folders;
+        std::deque<StorageEntry> _files;
+        std::vector<StorageEntry> _page;
+
+        Progress _progress;
+        std::chrono::steady_clock::time_point _start;
+    };
+} //namespace edsdk_w
+
+#endif //CARD_IMPORTER_HPP
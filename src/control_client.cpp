@@ -0,0 +1,124 @@
+#include "control_client.hpp"
+
+#include <cerrno>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace edsdk_w::control {
+    ControlClient::~ControlClient() {
+        disconnect();
+    }
+
+    bool ControlClient::connect(const std::string &socket_path) {
+        disconnect();
+
+        sockaddr_un addr{};
+        if (socket_path.size() >= sizeof(addr.sun_path)) {
+            return false;
+        }
+        addr.sun_family = AF_UNIX;
+        socket_path.copy(addr.sun_path, socket_path.size());
+
+        _fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (_fd < 0) {
+            return false;
+        }
+        if (::connect(_fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0) {
+            disconnect();
+            return false;
+        }
+        return true;
+    }
+
+    void ControlClient::disconnect() {
+        if (_fd >= 0) {
+            ::close(_fd);
+            _fd = -1;
+        }
+    }
+
+    bool ControlClient::call(Opcode opcode,
+                             const std::vector<std::uint32_t> &args,
+                             Status &status,
+                             std::vector<std::uint8_t> &response) {
+        std::vector<std::uint8_t> payload{};
+        for (auto arg : args) {
+            put_u32(payload, arg);
+        }
+
+        std::vector<std::uint8_t> request{};
+        auto request_id = _next_request_id++;
+        encode(request, opcode, Status::Ok, request_id, payload.data(), static_cast<std::uint32_t>(payload.size()));
+
+        std::size_t sent = 0;
+        while (sent < request.size()) {
+            auto n = send(_fd, request.data() + sent, request.size() - sent, MSG_NOSIGNAL);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+            sent += n;
+        }
+
+        MessageHeader header{};
+        while (_read_message(header, response)) {
+            if (header.opcode == Opcode::PropertyChanged) {
+                _notifications.emplace_back(get_u32(response.data(), 0), get_u32(response.data(), 1));
+                continue;
+            }
+            if (header.request_id == request_id) {
+                status = header.status;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool ControlClient::wait_notifications() {
+        MessageHeader header{};
+        std::vector<std::uint8_t> payload{};
+
+        while (_notifications.empty()) {
+            if (!_read_message(header, payload)) {
+                return false;
+            }
+            if (header.opcode == Opcode::PropertyChanged) {
+                _notifications.emplace_back(get_u32(payload.data(), 0), get_u32(payload.data(), 1));
+            }
+        }
+        return true;
+    }
+
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> ControlClient::take_notifications() {
+        std::vector<std::pair<std::uint32_t, std::uint32_t>> res{};
+        res.swap(_notifications);
+        return res;
+    }
+
+    bool ControlClient::_read_message(MessageHeader &header, std::vector<std::uint8_t> &payload) {
+        if (!_read_exact(&header, sizeof(header)) || header.length > MAX_PAYLOAD_SIZE) {
+            return false;
+        }
+        payload.resize(header.length);
+        return _read_exact(payload.data(), payload.size());
+    }
+
+    bool ControlClient::_read_exact(void *data, std::size_t size) {
+        auto ptr = static_cast<std::uint8_t *>(data);
+        while (size > 0) {
+            auto n = recv(_fd, ptr, size, 0);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                return false;
+            }
+            ptr += n;
+            size -= n;
+        }
+        return true;
+    }
+} //namespace edsdk_w::control
@@ -0,0 +1,47 @@
+#ifndef CONTROL_CLIENT_HPP
+#define CONTROL_CLIENT_HPP
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include "control_protocol.hpp"
+
+namespace edsdk_w::control {
+    //blocking client of the control server, one request in flight at a time
+    class ControlClient {
+    public:
+        ControlClient() = default;
+        ~ControlClient();
+
+        ControlClient(const ControlClient &) = delete;
+        ControlClient &operator=(const ControlClient &) = delete;
+
+        bool connect(const std::string &socket_path);
+        void disconnect();
+
+        //sends request with u32 arguments and waits for its response,
+        //property change notifications received meanwhile are queued
+        bool call(Opcode opcode,
+                  const std::vector<std::uint32_t> &args,
+                  Status &status,
+                  std::vector<std::uint8_t> &response);
+
+        //blocks until at least one notification is available
+        bool wait_notifications();
+
+        //returns queued {prop_id, value} notifications
+        std::vector<std::pair<std::uint32_t, std::uint32_t>> take_notifications();
+
+    private:
+        bool _read_message(MessageHeader &header, std::vector<std::uint8_t> &payload);
+
+        bool _read_exact(void *data, std::size_t size);
+
+        int _fd = -1;
+        std::uint32_t _next_request_id = 1;
+        std::vector<std::pair<std::uint32_t, std::uint32_t>> _notifications;
+    };
+} //namespace edsdk_w::control
+
+#endif //CONTROL_CLIENT_HPP
@@ -0,0 +1,99 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "EDSDKTypes.h"
+#include "control_client.hpp"
+
+//closed-loop load generator for the control server:
+//control_loadgen <socket_path> [clients] [seconds] [ping|get|snapshot]
+int main(int argc, char **argv) {
+    using namespace edsdk_w::control;
+    using clock = std::chrono::steady_clock;
+
+    if (argc < 2) {
+        std::cerr << "usage: " << argv[0] << " <socket_path> [clients] [seconds] [ping|get|snapshot]\n";
+        return 1;
+    }
+
+    std::string socket_path = argv[1];
+    int clients = argc > 2 ? std::stoi(argv[2]) : 32;
+    int seconds = argc > 3 ? std::stoi(argv[3]) : 10;
+    std::string mode = argc > 4 ? argv[4] : "ping";
+
+    Opcode opcode = Opcode::Ping;
+    std::vector<std::uint32_t> args{};
+    if (mode == "get") {
+        opcode = Opcode::GetProperty;
+        args.push_back(kEdsPropID_ISOSpeed);
+    } else if (mode == "snapshot") {
+        opcode = Opcode::Snapshot;
+    }
+
+    std::atomic<bool> running{true};
+    std::atomic<std::uint64_t> errors{0};
+    std::vector<std::vector<std::uint64_t>> latencies(clients);
+    std::vector<std::thread> threads{};
+
+    for (int i = 0; i < clients; i++) {
+        threads.emplace_back([&, i]() {
+            ControlClient client{};
+            if (!client.connect(socket_path)) {
+                errors++;
+                return;
+            }
+
+            Status status{};
+            std::vector<std::uint8_t> response{};
+            auto &samples = latencies[i];
+            while (running.load(std::memory_order_relaxed)) {
+                auto start = clock::now();
+                if (!client.call(opcode, args, status, response)) {
+                    errors++;
+                    return;
+                }
+                samples.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count());
+                if (status != Status::Ok) {
+                    errors++;
+                }
+            }
+        });
+    }
+
+    auto start = clock::now();
+    std::this_thread::sleep_for(std::chrono::seconds{seconds});
+    running = false;
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    double elapsed = std::chrono::duration<double>(clock::now() - start).count();
+
+    std::vector<std::uint64_t> all{};
+    for (const auto &samples : latencies) {
+        all.insert(all.end(), samples.begin(), samples.end());
+    }
+    if (all.empty()) {
+        std::cerr << "no requests completed\n";
+        return 1;
+    }
+    std::sort(all.begin(), all.end());
+
+    auto percentile_us = [&all](double p) {
+        auto index = static_cast<std::size_t>(p * static_cast<double>(all.size() - 1));
+        return static_cast<double>(all[index]) / 1000.0;
+    };
+
+    std::cout << std::fixed << std::setprecision(1)
+              << "mode: " << mode << ", clients: " << clients << "\n"
+              << "requests: " << all.size() << ", errors: " << errors << "\n"
+              << "requests/sec: " << static_cast<double>(all.size()) / elapsed << "\n"
+              << "latency us: p50 " << percentile_us(0.50)
+              << ", p99 " << percentile_us(0.99)
+              << ", max " << percentile_us(1.0) << std::endl;
+
+    return errors == 0 ? 0 : 2;
+}
@@ -0,0 +1,71 @@
+#ifndef CONTROL_PROTOCOL_HPP
+#define CONTROL_PROTOCOL_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+//binary request/response protocol of the control server, both sides run on the same host,
+//so all fields are in host byte order
+namespace edsdk_w::control {
+    enum class Opcode : std::uint16_t {
+        Ping = 0,
+        GetProperty = 1,            //u32 prop_id -> u32 value
+        GetPropertyConstraints = 2, //u32 prop_id -> u32 count, u32 values[count]
+        SetProperty = 3,            //u32 prop_id, u32 index_in_constraints -> -
+        Trigger = 4,                //- -> -
+        Snapshot = 5,               //- -> u32 count, {u32 prop_id, u32 value}[count]
+        Subscribe = 6,              //- -> -, followed by PropertyChanged messages
+        PropertyChanged = 7,        //server push: u32 prop_id, u32 value
+        ListNewestFiles = 8         //u32 offset, u32 limit -> u32 count, {u64 size, u32 date_time, u32 path_length, path}[count]
+    };
+
+    enum class Status : std::uint16_t {
+        Ok = 0,
+        Error = 1,
+        BadRequest = 2,
+        UnknownOpcode = 3,
+        NoCamera = 4
+    };
+
+    struct MessageHeader {
+        std::uint32_t length; //payload size, header excluded
+        Opcode opcode;
+        Status status;        //always Ok in requests
+        std::uint32_t request_id;
+    };
+
+    static_assert(sizeof(MessageHeader) == 12, "protocol header must be packed");
+
+    constexpr std::uint32_t MAX_PAYLOAD_SIZE = 64 * 1024;
+
+    inline void put_u32(std::vector<std::uint8_t> &buffer, std::uint32_t value) {
+        auto pos = buffer.size();
+        buffer.resize(pos + sizeof(value));
+        std::memcpy(buffer.data() + pos, &value, sizeof(value));
+    }
+
+    inline std::uint32_t get_u32(const std::uint8_t *data, std::size_t index) {
+        std::uint32_t value;
+        std::memcpy(&value, data + index * sizeof(value), sizeof(value));
+        return value;
+    }
+
+    //appends header and payload to the buffer
+    inline void encode(std::vector<std::uint8_t> &buffer,
+                       Opcode opcode,
+                       Status status,
+                       std::uint32_t request_id,
+                       const std::uint8_t *payload = nullptr,
+                       std::uint32_t length = 0) {
+        MessageHeader header{length, opcode, status, request_id};
+        auto pos = buffer.size();
+        buffer.resize(pos + sizeof(header) + length);
+        std::memcpy(buffer.data() + pos, &header, sizeof(header));
+        if (length) {
+            std::memcpy(buffer.data() + pos + sizeof(header), payload, length);
+        }
+    }
+} //namespace edsdk_w::control
+
+#endif //CONTROL_PROTOCOL_HPP
@@ -0,0 +1,390 @@
+#include "control_server.hpp"
+
+#include <EDSDK.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace edsdk_w {
+    namespace {
+        constexpr int EVENTS_PUMP_INTERVAL_MS = 10;
+        constexpr std::size_t MAX_PENDING_OUTPUT = 4 * 1024 * 1024;
+
+        //keeps listing response well under max payload size
+        constexpr std::uint32_t MAX_LIST_PAGE = 256;
+
+        constexpr std::array<EdsPropertyID, 12> SNAPSHOT_PROPERTIES = {
+                kEdsPropID_ImageQuality,
+                kEdsPropID_AEMode,
+                kEdsPropID_AFMode,
+                kEdsPropID_WhiteBalance,
+                kEdsPropID_ColorTemperature,
+                kEdsPropID_ColorSpace,
+                kEdsPropID_DriveMode,
+                kEdsPropID_MeteringMode,
+                kEdsPropID_ISOSpeed,
+                kEdsPropID_Av,
+                kEdsPropID_Tv,
+                kEdsPropID_ExposureCompensation
+        };
+    }
+
+    ControlServer::ControlServer() : _epoll_fd{-1}, _listen_fd{-1}, _stop_fd{-1},
+                                     _attached_camera{nullptr}, _attached_generation{0},
+                                     _live_view_publisher{nullptr} {}
+
+    ControlServer::~ControlServer() {
+        for (auto &[fd, client] : _clients) {
+            ::close(fd);
+        }
+        if (_listen_fd >= 0) {
+            ::close(_listen_fd);
+            unlink(_socket_path.c_str());
+        }
+        if (_stop_fd >= 0) {
+            ::close(_stop_fd);
+        }
+        if (_epoll_fd >= 0) {
+            ::close(_epoll_fd);
+        }
+    }
+
+    bool ControlServer::start(const std::string &socket_path) {
+        sockaddr_un addr{};
+        if (socket_path.size() >= sizeof(addr.sun_path)) {
+            return false;
+        }
+        addr.sun_family = AF_UNIX;
+        socket_path.copy(addr.sun_path, socket_path.size());
+
+        //initializing SDK before any client can connect
+        EDSDK::get_instance();
+
+        _listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (_listen_fd < 0) {
+            return false;
+        }
+
+        unlink(socket_path.c_str());
+        if (bind(_listen_fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0 ||
+            listen(_listen_fd, SOMAXCONN) != 0) {
+            return false;
+        }
+        _socket_path = socket_path;
+
+        _epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        _stop_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (_epoll_fd < 0 || _stop_fd < 0) {
+            return false;
+        }
+
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = _listen_fd;
+        if (epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, _listen_fd, &event) != 0) {
+            return false;
+        }
+        event.data.fd = _stop_fd;
+        return epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, _stop_fd, &event) == 0;
+    }
+
+    void ControlServer::run() {
+        std::array<epoll_event, 64> events{};
+
+        while (true) {
+            _attach_camera();
+
+            int count = epoll_wait(_epoll_fd, events.data(), events.size(), EVENTS_PUMP_INTERVAL_MS);
+            if (count < 0 && errno != EINTR) {
+                return;
+            }
+
+            for (int i = 0; i < count; i++) {
+                int fd = events[i].data.fd;
+                if (fd == _stop_fd) {
+                    return;
+                }
+                if (fd == _listen_fd) {
+                    _accept();
+                    continue;
+                }
+
+                auto it = _clients.find(fd);
+                if (it == _clients.end()) {
+                    continue;
+                }
+                if (events[i].events & (EPOLLHUP | EPOLLERR)) {
+                    _close(fd);
+                    continue;
+                }
+                if ((events[i].events & EPOLLOUT) && !_flush(it->second)) {
+                    _close(fd);
+                    continue;
+                }
+                if (events[i].events & EPOLLIN) {
+                    _read(it->second);
+                }
+            }
+
+            //property callbacks are delivered here and pushed to subscribers
+            EDSDK::events();
+
+            if (_live_view_publisher && _attached_camera) {
+                _live_view_publisher->publish(*_attached_camera);
+            }
+        }
+    }
+
+    void ControlServer::stop() {
+        std::uint64_t one = 1;
+        [[maybe_unused]] auto res = write(_stop_fd, &one, sizeof(one));
+    }
+
+    void ControlServer::set_live_view_publisher(LiveViewPublisher *publisher) {
+        _live_view_publisher = publisher;
+    }
+
+    void ControlServer::_accept() {
+        while (true) {
+            int fd = accept4(_listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) {
+                return;
+            }
+
+            epoll_event event{};
+            event.events = EPOLLIN;
+            event.data.fd = fd;
+            if (epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0) {
+                ::close(fd);
+                continue;
+            }
+            _clients.emplace(fd, Client{fd, false, false, {}, {}});
+        }
+    }
+
+    void ControlServer::_read(Client &client) {
+        std::uint8_t buffer[16 * 1024];
+
+        while (true) {
+            auto n = recv(client.fd, buffer, sizeof(buffer), 0);
+            if (n > 0) {
+                client.in.insert(client.in.end(), buffer, buffer + n);
+                continue;
+            }
+            if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+                _close(client.fd);
+                return;
+            }
+            if (errno != EINTR) {
+                break;
+            }
+        }
+
+        std::size_t offset = 0;
+        while (client.in.size() - offset >= sizeof(control::MessageHeader)) {
+            control::MessageHeader header{};
+            std::memcpy(&header, client.in.data() + offset, sizeof(header));
+            if (header.length > control::MAX_PAYLOAD_SIZE) {
+                _close(client.fd);
+                return;
+            }
+            if (client.in.size() - offset < sizeof(header) + header.length) {
+                break;
+            }
+
+            _handle(client, header, client.in.data() + offset + sizeof(header));
+            offset += sizeof(header) + header.length;
+        }
+        client.in.erase(client.in.begin(), client.in.begin() + static_cast<std::ptrdiff_t>(offset));
+
+        if (!_flush(client)) {
+            _close(client.fd);
+        }
+    }
+
+    bool ControlServer::_flush(Client &client) {
+        std::size_t sent = 0;
+        while (sent < client.out.size()) {
+            auto n = send(client.fd, client.out.data() + sent, client.out.size() - sent, MSG_NOSIGNAL);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                    return false;
+                }
+                break;
+            }
+            sent += n;
+        }
+        client.out.erase(client.out.begin(), client.out.begin() + static_cast<std::ptrdiff_t>(sent));
+
+        //waiting for EPOLLOUT only while there is something left to send
+        bool writing = !client.out.empty();
+        if (writing != client.writing) {
+            epoll_event event{};
+            event.events = writing ? EPOLLIN | EPOLLOUT : EPOLLIN;
+            event.data.fd = client.fd;
+            epoll_ctl(_epoll_fd, EPOLL_CTL_MOD, client.fd, &event);
+            client.writing = writing;
+        }
+
+        return client.out.size() <= MAX_PENDING_OUTPUT;
+    }
+
+    void ControlServer::_close(int fd) {
+        epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+        ::close(fd);
+        _clients.erase(fd);
+    }
+
+    void ControlServer::_handle(Client &client, const control::MessageHeader &header, const std::uint8_t *payload) {
+        using control::Opcode;
+        using control::Status;
+
+        auto respond = [&client, &header](Status status, const std::vector<std::uint8_t> &data = {}) {
+            control::encode(client.out, header.opcode, status, header.request_id,
+                            data.data(), static_cast<std::uint32_t>(data.size()));
+        };
+
+        auto payload_words = header.length / sizeof(std::uint32_t);
+        std::vector<std::uint8_t> data{};
+
+        if (header.opcode == Opcode::Ping) {
+            respond(Status::Ok);
+            return;
+        }
+
+        auto camera = EDSDK::get_instance().get_camera();
+        if (!camera) {
+            respond(Status::NoCamera);
+            return;
+        }
+
+        switch (header.opcode) {
+            case Opcode::GetProperty: {
+                if (payload_words < 1) {
+                    respond(Status::BadRequest);
+                    break;
+                }
+                auto value = camera->get().get_property_value(control::get_u32(payload, 0));
+                if (!value) {
+                    respond(Status::BadRequest);
+                    break;
+                }
+                control::put_u32(data, *value);
+                respond(Status::Ok, data);
+                break;
+            }
+            case Opcode::GetPropertyConstraints: {
+                if (payload_words < 1) {
+                    respond(Status::BadRequest);
+                    break;
+                }
+                auto constraints = camera->get().get_property_constraint_values(control::get_u32(payload, 0));
+                control::put_u32(data, static_cast<std::uint32_t>(constraints.size()));
+                for (auto value : constraints) {
+                    control::put_u32(data, value);
+                }
+                respond(Status::Ok, data);
+                break;
+            }
+            case Opcode::SetProperty: {
+                if (payload_words < 2) {
+                    respond(Status::BadRequest);
+                    break;
+                }
+                bool res = camera->get().set_property(control::get_u32(payload, 0), control::get_u32(payload, 1));
+                respond(res ? Status::Ok : Status::Error);
+                break;
+            }
+            case Opcode::Trigger:
+                respond(camera->get().shutter_button() ? Status::Ok : Status::Error);
+                break;
+            case Opcode::Snapshot:
+                control::put_u32(data, static_cast<std::uint32_t>(SNAPSHOT_PROPERTIES.size()));
+                for (auto prop_id : SNAPSHOT_PROPERTIES) {
+                    control::put_u32(data, prop_id);
+                    control::put_u32(data, camera->get().get_property_value(prop_id).value_or(0));
+                }
+                respond(Status::Ok, data);
+                break;
+            case Opcode::Subscribe:
+                client.subscribed = true;
+                respond(Status::Ok);
+                break;
+            case Opcode::ListNewestFiles: {
+                if (payload_words < 2) {
+                    respond(Status::BadRequest);
+                    break;
+                }
+                std::vector<StorageEntry> page{};
+                if (!camera->get().storage().newest_files(control::get_u32(payload, 0),
+                                                             std::min(control::get_u32(payload, 1), MAX_LIST_PAGE),
+                                                             page)) {
+                    respond(Status::Error);
+                    break;
+                }
+                control::put_u32(data, static_cast<std::uint32_t>(page.size()));
+                for (const auto &entry : page) {
+                    control::put_u32(data, static_cast<std::uint32_t>(entry.size));
+                    control::put_u32(data, static_cast<std::uint32_t>(entry.size >> 32));
+                    control::put_u32(data, entry.date_time);
+                    control::put_u32(data, static_cast<std::uint32_t>(entry.path.size()));
+                    data.insert(data.end(), entry.path.begin(), entry.path.end());
+                }
+                respond(Status::Ok, data);
+                break;
+            }
+            default:
+                respond(Status::UnknownOpcode);
+                break;
+        }
+    }
+
+    void ControlServer::_on_property_changed(EdsPropertyID prop_id, std::uint32_t value) {
+        std::vector<std::uint8_t> data{};
+        control::put_u32(data, prop_id);
+        control::put_u32(data, value);
+
+        std::vector<int> slow_clients{};
+        for (auto &[fd, client] : _clients) {
+            if (!client.subscribed) {
+                continue;
+            }
+            control::encode(client.out, control::Opcode::PropertyChanged, control::Status::Ok, 0,
+                            data.data(), static_cast<std::uint32_t>(data.size()));
+            if (!_flush(client)) {
+                slow_clients.push_back(fd);
+            }
+        }
+
+        for (auto fd : slow_clients) {
+            _close(fd);
+        }
+    }
+
+    void ControlServer::_attach_camera() {
+        //compared by generation, a replaced camera can land at the address of the old one
+        auto &sdk = EDSDK::get_instance();
+        if (sdk.camera_generation() == _attached_generation) {
+            return;
+        }
+        auto camera = sdk.get_camera();
+        auto camera_ptr = camera ? &camera->get() : nullptr;
+
+        if (camera_ptr) {
+            camera_ptr->set_property_listener([this](EdsPropertyID prop_id, std::uint32_t value) {
+                _on_property_changed(prop_id, value);
+            });
+        }
+        _attached_camera = camera_ptr;
+        _attached_generation = sdk.camera_generation();
+    }
+} //namespace edsdk_w
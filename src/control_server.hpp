@@ -0,0 +1,68 @@
+#ifndef CONTROL_SERVER_HPP
+#define CONTROL_SERVER_HPP
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "control_protocol.hpp"
+#include "edsdk_wrapper.hpp"
+#include "live_view_publisher.hpp"
+
+namespace edsdk_w {
+    //serves control protocol over a unix domain socket, owns the single EDSDK instance
+    //and pumps its events from the same epoll loop, so the SDK is only touched from one thread
+    class ControlServer {
+    public:
+        ControlServer();
+        ~ControlServer();
+
+        ControlServer(const ControlServer &) = delete;
+        ControlServer &operator=(const ControlServer &) = delete;
+
+        bool start(const std::string &socket_path);
+
+        //blocks until stop() is called
+        void run();
+
+        //async-signal-safe
+        void stop();
+
+        //publisher is not owned, frames are published from the event loop
+        void set_live_view_publisher(LiveViewPublisher *publisher);
+
+    private:
+        struct Client {
+            int fd;
+            bool subscribed;
+            bool writing;
+            std::vector<std::uint8_t> in;
+            std::vector<std::uint8_t> out;
+        };
+
+        void _accept();
+
+        void _read(Client &client);
+
+        bool _flush(Client &client);
+
+        void _close(int fd);
+
+        void _handle(Client &client, const control::MessageHeader &header, const std::uint8_t *payload);
+
+        void _on_property_changed(EdsPropertyID prop_id, std::uint32_t value);
+
+        void _attach_camera();
+
+        int _epoll_fd;
+        int _listen_fd;
+        int _stop_fd;
+        std::string _socket_path;
+        EDSDK::Camera *_attached_camera;
+        std::uint64_t _attached_generation;
+        LiveViewPublisher *_live_view_publisher;
+        std::unordered_map<int, Client> _clients;
+    };
+} //namespace edsdk_w
+
+#endif //CONTROL_SERVER_HPP
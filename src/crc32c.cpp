@@ -0,0 +1,112 @@
+#include "crc32c.hpp"
+
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define CRC32C_X86 1
+#include <nmmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#else
+#define CRC32C_X86 0
+#endif
+
+namespace utils {
+    namespace {
+        constexpr std::uint32_t POLYNOMIAL = 0x82F63B78; //reflected Castagnoli
+
+        //slicing-by-8 tables, tables[k][b] is crc of byte b followed by k zero bytes
+        constexpr std::array<std::array<std::uint32_t, 256>, 8> make_tables() {
+            std::array<std::array<std::uint32_t, 256>, 8> res{};
+            for (std::uint32_t b = 0; b < 256; b++) {
+                std::uint32_t crc = b;
+                for (int bit = 0; bit < 8; bit++) {
+                    crc = crc & 1 ? (crc >> 1) ^ POLYNOMIAL : crc >> 1;
+                }
+                res[0][b] = crc;
+            }
+            for (std::size_t k = 1; k < 8; k++) {
+                for (std::uint32_t b = 0; b < 256; b++) {
+                    res[k][b] = (res[k - 1][b] >> 8) ^ res[0][res[k - 1][b] & 0xff];
+                }
+            }
+            return res;
+        }
+
+        constexpr auto TABLES = make_tables();
+
+        //words are loaded little-endian, as on every host EDSDK ships for
+        std::uint32_t update_scalar(const std::uint8_t *p, std::size_t size, std::uint32_t crc) {
+            for (; size >= 8; p += 8, size -= 8) {
+                std::uint32_t lo, hi;
+                std::memcpy(&lo, p, 4);
+                std::memcpy(&hi, p + 4, 4);
+                lo ^= crc;
+                crc = TABLES[7][lo & 0xff] ^ TABLES[6][(lo >> 8) & 0xff] ^
+                      TABLES[5][(lo >> 16) & 0xff] ^ TABLES[4][lo >> 24] ^
+                      TABLES[3][hi & 0xff] ^ TABLES[2][(hi >> 8) & 0xff] ^
+                      TABLES[1][(hi >> 16) & 0xff] ^ TABLES[0][hi >> 24];
+            }
+            for (; size; p++, size--) {
+                crc = (crc >> 8) ^ TABLES[0][(crc ^ *p) & 0xff];
+            }
+            return crc;
+        }
+
+#if CRC32C_X86
+#if defined(_MSC_VER)
+        bool detect_hardware() {
+            int info[4];
+            __cpuid(info, 1);
+            return (info[2] & (1 << 20)) != 0;
+        }
+
+        std::uint32_t update_sse42(const std::uint8_t *p, std::size_t size, std::uint32_t crc) {
+#else
+        bool detect_hardware() {
+            return __builtin_cpu_supports("sse4.2");
+        }
+
+        __attribute__((target("sse4.2")))
+        std::uint32_t update_sse42(const std::uint8_t *p, std::size_t size, std::uint32_t crc) {
+#endif
+            std::uint64_t crc64 = crc;
+            for (; size >= 8; p += 8, size -= 8) {
+                std::uint64_t v;
+                std::memcpy(&v, p, 8);
+                crc64 = _mm_crc32_u64(crc64, v);
+            }
+            auto res = static_cast<std::uint32_t>(crc64);
+            for (; size; p++, size--) {
+                res = _mm_crc32_u8(res, *p);
+            }
+            return res;
+        }
+#else
+        bool detect_hardware() {
+            return false;
+        }
+#endif
+
+        const bool HARDWARE = detect_hardware();
+    }
+
+    std::uint32_t crc32c(const void *data, std::size_t size, std::uint32_t crc) {
+#if CRC32C_X86
+        if (HARDWARE) {
+            return ~update_sse42(static_cast<const std::uint8_t *>(data), size, ~crc);
+        }
+#endif
+        return ~update_scalar(static_cast<const std::uint8_t *>(data), size, ~crc);
+    }
+
+    std::uint32_t crc32c_scalar(const void *data, std::size_t size, std::uint32_t crc) {
+        return ~update_scalar(static_cast<const std::uint8_t *>(data), size, ~crc);
+    }
+
+    bool crc32c_hardware_available() {
+        return HARDWARE;
+    }
+} //namespace utils
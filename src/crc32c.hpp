@@ -0,0 +1,18 @@
+#ifndef CRC32C_HPP
+#define CRC32C_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace utils {
+    //CRC-32C (Castagnoli), uses SSE4.2 crc32 instruction when the cpu has it,
+    //pass result of previous call as crc to checksum data in chunks
+    std::uint32_t crc32c(const void *data, std::size_t size, std::uint32_t crc = 0);
+
+    //table-driven fallback, exposed for benchmarks
+    std::uint32_t crc32c_scalar(const void *data, std::size_t size, std::uint32_t crc = 0);
+
+    bool crc32c_hardware_available();
+} //namespace utils
+
+#endif //CRC32C_HPP
@@ -0,0 +1,138 @@
+#include "download_postprocessor.hpp"
+
+#include <fstream>
+#include <memory>
+#include "crc32c.hpp"
+#include "embedded_preview.hpp"
+
+namespace edsdk_w {
+    namespace {
+        using clock = std::chrono::steady_clock;
+
+        std::uint64_t ns_since(clock::time_point start) {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count();
+        }
+    }
+
+    struct DownloadPostProcessor::Job {
+        Result result;
+        std::vector<std::uint8_t> data;
+        clock::time_point submitted;
+        std::atomic<int> remaining_stages;
+    };
+
+    DownloadPostProcessor::DownloadPostProcessor(std::size_t threads, std::size_t max_in_flight_bytes) :
+            _max_in_flight_bytes{max_in_flight_bytes},
+            _in_flight_bytes{0},
+            _stats{},
+            _pool{threads} {}
+
+    DownloadPostProcessor::~DownloadPostProcessor() {
+        _pool.wait_idle();
+    }
+
+    bool DownloadPostProcessor::submit(const std::string &path, std::vector<std::uint8_t> data) {
+        auto size = data.size();
+        auto in_flight = _in_flight_bytes.fetch_add(size);
+        if (in_flight != 0 && in_flight + size > _max_in_flight_bytes) {
+            _in_flight_bytes.fetch_sub(size);
+            std::lock_guard lock{_mutex};
+            _stats.skipped++;
+            return false;
+        }
+
+        {
+            std::lock_guard lock{_mutex};
+            _stats.submitted++;
+        }
+
+        auto job = std::make_shared<Job>();
+        job->result = {path, size, 0, ""};
+        job->data = std::move(data);
+        job->submitted = clock::now();
+        job->remaining_stages = 2;
+
+        _pool.submit([this, job] { _hash(*job); });
+        _pool.submit([this, job] { _extract_preview(*job); });
+        return true;
+    }
+
+    void DownloadPostProcessor::set_listener(std::function<void(const Result &)> listener) {
+        std::lock_guard lock{_mutex};
+        _listener = std::move(listener);
+    }
+
+    void DownloadPostProcessor::wait_idle() {
+        _pool.wait_idle();
+    }
+
+    DownloadPostProcessor::Stats DownloadPostProcessor::stats() const {
+        std::lock_guard lock{_mutex};
+        return _stats;
+    }
+
+    std::size_t DownloadPostProcessor::thread_count() const {
+        return _pool.thread_count();
+    }
+
+    std::string DownloadPostProcessor::preview_path(const std::string &path) {
+        return path + ".preview.jpg";
+    }
+
+    void DownloadPostProcessor::_hash(Job &job) {
+        auto start = clock::now();
+        job.result.crc32c = utils::crc32c(job.data.data(), job.data.size());
+        auto busy = ns_since(start);
+
+        {
+            std::lock_guard lock{_mutex};
+            _stats.hash.files++;
+            _stats.hash.bytes += job.data.size();
+            _stats.hash.busy_ns += busy;
+        }
+        _finish(job);
+    }
+
+    void DownloadPostProcessor::_extract_preview(Job &job) {
+        auto start = clock::now();
+        auto preview = find_embedded_preview(job.data.data(), job.data.size());
+        if (preview) {
+            auto path = preview_path(job.result.path);
+            std::ofstream file{path, std::ios::binary | std::ios::trunc};
+            file.write(reinterpret_cast<const char *>(job.data.data() + preview->offset),
+                       static_cast<std::streamsize>(preview->size));
+            if (file) {
+                job.result.preview_path = path;
+            }
+        }
+        auto busy = ns_since(start);
+
+        {
+            std::lock_guard lock{_mutex};
+            _stats.preview.files++;
+            _stats.preview.bytes += job.data.size();
+            _stats.preview.busy_ns += busy;
+        }
+        _finish(job);
+    }
+
+    void DownloadPostProcessor::_finish(Job &job) {
+        //last stage to finish reports the file and releases its memory
+        if (job.remaining_stages.fetch_sub(1) != 1) {
+            return;
+        }
+
+        std::function<void(const Result &)> listener{};
+        {
+            std::lock_guard lock{_mutex};
+            _stats.total_ns += ns_since(job.submitted);
+            listener = _listener;
+        }
+        if (listener) {
+            listener(job.result);
+        }
+
+        _in_flight_bytes.fetch_sub(job.result.size);
+        std::vector<std::uint8_t>{}.swap(job.data);
+    }
+} //namespace edsdk_w
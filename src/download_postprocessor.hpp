@@ -0,0 +1,87 @@
+#ifndef DOWNLOAD_POSTPROCESSOR_HPP
+#define DOWNLOAD_POSTPROCESSOR_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "work_stealing_pool.hpp"
+
+namespace edsdk_w {
+    //checksums downloaded captures and extracts their embedded jpeg previews
+    //while file content is still in memory, stages run in parallel on a work-stealing pool
+    class DownloadPostProcessor {
+    public:
+        struct Result {
+            std::string path;
+            std::uint64_t size;
+            std::uint32_t crc32c;
+            //empty if capture has no embedded preview
+            std::string preview_path;
+        };
+
+        struct StageStats {
+            std::uint64_t files;
+            std::uint64_t bytes;
+            std::uint64_t busy_ns;
+        };
+
+        struct Stats {
+            StageStats hash;
+            StageStats preview;
+            std::uint64_t submitted;
+            //files dropped because in-flight limit was reached
+            std::uint64_t skipped;
+            //from submit to both stages done
+            std::uint64_t total_ns;
+        };
+
+        //0 threads means one per hardware thread
+        explicit DownloadPostProcessor(std::size_t threads = 0, std::size_t max_in_flight_bytes = 512 * 1024 * 1024);
+
+        //finishes queued files
+        ~DownloadPostProcessor();
+
+        DownloadPostProcessor(const DownloadPostProcessor &) = delete;
+        DownloadPostProcessor &operator=(const DownloadPostProcessor &) = delete;
+
+        //takes file content that is already written to path, never blocks;
+        //returns false and drops data when in-flight limit would be exceeded
+        bool submit(const std::string &path, std::vector<std::uint8_t> data);
+
+        //listener is called from pool threads after both stages of a file are done
+        void set_listener(std::function<void(const Result &)> listener);
+
+        void wait_idle();
+
+        [[nodiscard]] Stats stats() const;
+
+        [[nodiscard]] std::size_t thread_count() const;
+
+        //preview of capture at path is saved next to it as path + ".preview.jpg"
+        static std::string preview_path(const std::string &path);
+
+    private:
+        struct Job;
+
+        void _hash(Job &job);
+
+        void _extract_preview(Job &job);
+
+        void _finish(Job &job);
+
+        std::size_t _max_in_flight_bytes;
+        std::atomic<std::size_t> _in_flight_bytes;
+
+        mutable std::mutex _mutex;
+        std::function<void(const Result &)> _listener;
+        Stats _stats;
+
+        utils::WorkStealingPool _pool;
+    };
+} //namespace edsdk_w
+
+#endif //DOWNLOAD_POSTPROCESSOR_HPP
@@ -0,0 +1,302 @@
+#include "edsdk_c.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "edsdk_wrapper.hpp"
+#include "mapped_file.hpp"
+
+using edsdk_w::EDSDK;
+
+struct edsw_buffer {
+    std::vector<std::uint8_t> frame; //pooled live view memory
+    utils::MappedFile file;
+};
+
+namespace {
+    //frames kept for reuse, hosts holding more than this allocate new ones
+    constexpr std::size_t MAX_POOLED_FRAMES = 8;
+
+    std::mutex pool_mutex;
+    std::vector<edsw_buffer*> frame_pool;
+
+    edsw_buffer *acquire_frame_buffer() {
+        {
+            std::lock_guard<std::mutex> lock{pool_mutex};
+            if (!frame_pool.empty()) {
+                auto buffer = frame_pool.back();
+                frame_pool.pop_back();
+                return buffer;
+            }
+        }
+        auto buffer = new edsw_buffer{};
+        buffer->frame.resize(edsdk_w::LIVE_VIEW_FRAME_CAPACITY);
+        return buffer;
+    }
+
+    //handle holds the selection generation, not an address, so stale handles of a reset or
+    //replaced camera are refused even when the new camera reuses the old address
+    edsw_camera *to_handle(std::uint64_t generation) {
+        return reinterpret_cast<edsw_camera*>(static_cast<std::uintptr_t>(generation));
+    }
+
+    EDSDK::Camera *to_camera(edsw_camera *camera) {
+        auto &sdk = EDSDK::get_instance();
+        auto current = sdk.get_camera();
+        if (!camera || !current || camera != to_handle(sdk.camera_generation())) {
+            return nullptr;
+        }
+        return &current->get();
+    }
+
+    edsw_status to_status(bool ok) {
+        return ok ? EDSW_OK : EDSW_FAILED;
+    }
+
+    edsw_status copy_string(const std::string &value, char *buffer, std::size_t capacity, std::size_t *length) {
+        if (!length || (!buffer && capacity)) {
+            return EDSW_INVALID_ARGUMENT;
+        }
+        *length = value.size();
+        if (capacity <= value.size()) {
+            return EDSW_BUFFER_TOO_SMALL;
+        }
+        std::memcpy(buffer, value.data(), value.size());
+        buffer[value.size()] = '\0';
+        return EDSW_OK;
+    }
+}
+
+extern "C" {
+    uint32_t edsw_abi_version(void) {
+        return EDSW_ABI_VERSION;
+    }
+
+    edsw_status edsw_camera_count(uint32_t *count) {
+        if (!count) {
+            return EDSW_INVALID_ARGUMENT;
+        }
+        *count = static_cast<std::uint32_t>(EDSDK::get_instance().get_available_camera_list().size());
+        return EDSW_OK;
+    }
+
+    edsw_status edsw_camera_description(uint32_t index, char *buffer, size_t capacity, size_t *length) {
+        auto cameras = EDSDK::get_instance().get_available_camera_list();
+        if (index >= cameras.size()) {
+            return EDSW_NO_CAMERA;
+        }
+        return copy_string(cameras[index], buffer, capacity, length);
+    }
+
+    edsw_status edsw_select_camera(uint32_t index, edsw_camera **camera) {
+        if (!camera) {
+            return EDSW_INVALID_ARGUMENT;
+        }
+        auto &sdk = EDSDK::get_instance();
+        sdk.reset_camera();
+        //wrapper selects by 8-bit index, no host has that many bodies attached
+        if (index > UINT8_MAX || !sdk.set_camera(static_cast<std::uint8_t>(index))) {
+            return EDSW_NO_CAMERA;
+        }
+        *camera = to_handle(sdk.camera_generation());
+        return EDSW_OK;
+    }
+
+    edsw_status edsw_reset_camera(void) {
+        return to_status(EDSDK::get_instance().reset_camera());
+    }
+
+    void edsw_events(void) {
+        EDSDK::events();
+    }
+
+    edsw_status edsw_camera_open_session(edsw_camera *camera) {
+        auto c = to_camera(camera);
+        return c ? to_status(c->open_session()) : EDSW_NO_CAMERA;
+    }
+
+    edsw_status edsw_camera_close_session(edsw_camera *camera) {
+        auto c = to_camera(camera);
+        return c ? to_status(c->close_session()) : EDSW_NO_CAMERA;
+    }
+
+    edsw_status edsw_camera_shutter_button(edsw_camera *camera) {
+        auto c = to_camera(camera);
+        return c ? to_status(c->shutter_button()) : EDSW_NO_CAMERA;
+    }
+
+    edsw_status edsw_camera_set_download_directory(edsw_camera *camera, const char *directory) {
+        auto c = to_camera(camera);
+        if (!c) {
+            return EDSW_NO_CAMERA;
+        }
+        if (!directory) {
+            return EDSW_INVALID_ARGUMENT;
+        }
+        return to_status(c->set_download_directory(directory));
+    }
+
+    edsw_status edsw_camera_get_string(edsw_camera *camera,
+                                       edsw_string_property property,
+                                       char *buffer,
+                                       size_t capacity,
+                                       size_t *length) {
+        auto c = to_camera(camera);
+        if (!c) {
+            return EDSW_NO_CAMERA;
+        }
+        switch (property) {
+            case EDSW_NAME: return copy_string(c->get_name(), buffer, capacity, length);
+            case EDSW_CURRENT_STORAGE: return copy_string(c->get_current_storage(), buffer, capacity, length);
+            case EDSW_BODY_ID: return copy_string(c->get_body_id(), buffer, capacity, length);
+            case EDSW_FIRMWARE_VERSION: return copy_string(c->get_firmware_version(), buffer, capacity, length);
+            case EDSW_LENS_NAME: return copy_string(c->get<edsdk_w::Prop::LensName>(), buffer, capacity, length);
+            case EDSW_DOWNLOAD_DIRECTORY: return copy_string(c->get_download_directory(), buffer, capacity, length);
+            default: return EDSW_INVALID_ARGUMENT;
+        }
+    }
+
+    edsw_status edsw_camera_get_property(edsw_camera *camera, uint32_t prop_id, uint32_t *value) {
+        auto c = to_camera(camera);
+        if (!c) {
+            return EDSW_NO_CAMERA;
+        }
+        if (!value) {
+            return EDSW_INVALID_ARGUMENT;
+        }
+        auto res = c->get_property_value(prop_id);
+        if (!res) {
+            return EDSW_UNKNOWN_PROPERTY;
+        }
+        *value = *res;
+        return EDSW_OK;
+    }
+
+    edsw_status edsw_camera_get_constraints(edsw_camera *camera,
+                                            uint32_t prop_id,
+                                            uint32_t *values,
+                                            size_t capacity,
+                                            size_t *count) {
+        auto c = to_camera(camera);
+        if (!c) {
+            return EDSW_NO_CAMERA;
+        }
+        if (!count || (!values && capacity)) {
+            return EDSW_INVALID_ARGUMENT;
+        }
+        if (!edsdk_w::property_table::slot_of(prop_id)) {
+            return EDSW_UNKNOWN_PROPERTY;
+        }
+
+        const auto &constraints = c->get_property_constraints(prop_id);
+        *count = constraints.size();
+        if (capacity < constraints.size()) {
+            return EDSW_BUFFER_TOO_SMALL;
+        }
+        std::copy(constraints.begin(), constraints.end(), values);
+        return EDSW_OK;
+    }
+
+    edsw_status edsw_camera_set_property(edsw_camera *camera, uint32_t prop_id, uint32_t index_in_constraints) {
+        auto c = to_camera(camera);
+        if (!c) {
+            return EDSW_NO_CAMERA;
+        }
+        if (!edsdk_w::property_table::slot_of(prop_id)) {
+            return EDSW_UNKNOWN_PROPERTY;
+        }
+        return to_status(c->set_property(prop_id, index_in_constraints));
+    }
+
+    edsw_status edsw_explain_prop_value(uint32_t prop_id,
+                                        uint32_t value,
+                                        char *buffer,
+                                        size_t capacity,
+                                        size_t *length) {
+        if (!edsdk_w::property_table::slot_of(prop_id)) {
+            return EDSW_UNKNOWN_PROPERTY;
+        }
+        return copy_string(EDSDK::explain_prop_value(prop_id, value), buffer, capacity, length);
+    }
+
+    edsw_status edsw_camera_start_live_view(edsw_camera *camera) {
+        auto c = to_camera(camera);
+        return c ? to_status(c->start_live_view()) : EDSW_NO_CAMERA;
+    }
+
+    edsw_status edsw_camera_stop_live_view(edsw_camera *camera) {
+        auto c = to_camera(camera);
+        return c ? to_status(c->stop_live_view()) : EDSW_NO_CAMERA;
+    }
+
+    edsw_status edsw_camera_acquire_live_view_frame(edsw_camera *camera,
+                                                    edsw_buffer **frame,
+                                                    const uint8_t **data,
+                                                    size_t *size) {
+        auto c = to_camera(camera);
+        if (!c) {
+            return EDSW_NO_CAMERA;
+        }
+        if (!frame || !data || !size) {
+            return EDSW_INVALID_ARGUMENT;
+        }
+
+        auto buffer = acquire_frame_buffer();
+        std::size_t frame_size = 0;
+        if (!c->download_live_view_frame(buffer->frame.data(), buffer->frame.size(), frame_size)) {
+            edsw_buffer_release(buffer);
+            return EDSW_FAILED;
+        }
+        *frame = buffer;
+        *data = buffer->frame.data();
+        *size = frame_size;
+        return EDSW_OK;
+    }
+
+    edsw_status edsw_camera_set_download_callback(edsw_camera *camera, edsw_download_callback callback, void *user) {
+        auto c = to_camera(camera);
+        if (!c) {
+            return EDSW_NO_CAMERA;
+        }
+        if (!callback) {
+            c->set_download_listener(nullptr);
+            return EDSW_OK;
+        }
+        c->set_download_listener([callback, user](const std::string &path, std::uint64_t size) {
+            callback(user, path.c_str(), size);
+        });
+        return EDSW_OK;
+    }
+
+    edsw_status edsw_map_file(const char *path, edsw_buffer **file, const uint8_t **data, size_t *size) {
+        if (!path || !file || !data || !size) {
+            return EDSW_INVALID_ARGUMENT;
+        }
+        auto buffer = new edsw_buffer{};
+        if (!buffer->file.open(path, utils::MappedFile::Mode::ReadOnly)) {
+            delete buffer;
+            return EDSW_FAILED;
+        }
+        *file = buffer;
+        *data = buffer->file.data();
+        *size = buffer->file.size();
+        return EDSW_OK;
+    }
+
+    void edsw_buffer_release(edsw_buffer *buffer) {
+        if (!buffer) {
+            return;
+        }
+        if (!buffer->frame.empty()) {
+            std::lock_guard<std::mutex> lock{pool_mutex};
+            if (frame_pool.size() < MAX_POOLED_FRAMES) {
+                frame_pool.push_back(buffer);
+                return;
+            }
+        }
+        delete buffer;
+    }
+}
@@ -0,0 +1,127 @@
+#ifndef EDSDK_C_H
+#define EDSDK_C_H
+
+/*
+ * C interface of the camera wrapper for hosts that cannot use the C++ API.
+ *
+ * Handles are opaque, strings and lists are written into caller buffers and large buffers
+ * (live view frames, downloaded files) are lent to the caller until released, so nothing
+ * is copied on the way across. Every function must be called from the thread that calls
+ * edsw_events(), except edsw_buffer_* which may be used from any thread.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(EDSW_STATIC)
+#define EDSW_API
+#elif defined(_WIN32)
+#if defined(EDSW_BUILD)
+#define EDSW_API __declspec(dllexport)
+#else
+#define EDSW_API __declspec(dllimport)
+#endif
+#else
+#define EDSW_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* bumped on every incompatible change of this header */
+#define EDSW_ABI_VERSION 1
+
+typedef enum edsw_status {
+    EDSW_OK = 0,
+    EDSW_FAILED = 1,            /* camera or SDK refused the call */
+    EDSW_NO_CAMERA = 2,
+    EDSW_INVALID_ARGUMENT = 3,
+    EDSW_BUFFER_TOO_SMALL = 4,  /* required size is reported, nothing is written */
+    EDSW_UNKNOWN_PROPERTY = 5
+} edsw_status;
+
+typedef enum edsw_string_property {
+    EDSW_NAME = 0,
+    EDSW_CURRENT_STORAGE = 1,
+    EDSW_BODY_ID = 2,
+    EDSW_FIRMWARE_VERSION = 3,
+    EDSW_LENS_NAME = 4,
+    EDSW_DOWNLOAD_DIRECTORY = 5
+} edsw_string_property;
+
+/* selected camera, valid until edsw_reset_camera() or selection of another camera;
+ * a token rather than an address, stale handles get EDSW_NO_CAMERA */
+typedef struct edsw_camera edsw_camera;
+
+/* borrowed memory, valid until edsw_buffer_release() */
+typedef struct edsw_buffer edsw_buffer;
+
+/* called from edsw_events(), path is valid during the call only */
+typedef void (*edsw_download_callback)(void *user, const char *path, uint64_t size);
+
+EDSW_API uint32_t edsw_abi_version(void);
+
+/* string outputs are NUL terminated, length excludes the terminator and is set on
+ * EDSW_OK and EDSW_BUFFER_TOO_SMALL, so callers can retry with length + 1 bytes */
+EDSW_API edsw_status edsw_camera_count(uint32_t *count);
+EDSW_API edsw_status edsw_camera_description(uint32_t index, char *buffer, size_t capacity, size_t *length);
+
+EDSW_API edsw_status edsw_select_camera(uint32_t index, edsw_camera **camera);
+EDSW_API edsw_status edsw_reset_camera(void);
+
+EDSW_API void edsw_events(void);
+
+EDSW_API edsw_status edsw_camera_open_session(edsw_camera *camera);
+EDSW_API edsw_status edsw_camera_close_session(edsw_camera *camera);
+EDSW_API edsw_status edsw_camera_shutter_button(edsw_camera *camera);
+EDSW_API edsw_status edsw_camera_set_download_directory(edsw_camera *camera, const char *directory);
+
+EDSW_API edsw_status edsw_camera_get_string(edsw_camera *camera,
+                                            edsw_string_property property,
+                                            char *buffer,
+                                            size_t capacity,
+                                            size_t *length);
+
+/* numeric properties by EDSDK property id, values are cached and cost no SDK call */
+EDSW_API edsw_status edsw_camera_get_property(edsw_camera *camera, uint32_t prop_id, uint32_t *value);
+
+/* count is set on EDSW_OK and EDSW_BUFFER_TOO_SMALL */
+EDSW_API edsw_status edsw_camera_get_constraints(edsw_camera *camera,
+                                                 uint32_t prop_id,
+                                                 uint32_t *values,
+                                                 size_t capacity,
+                                                 size_t *count);
+
+EDSW_API edsw_status edsw_camera_set_property(edsw_camera *camera, uint32_t prop_id, uint32_t index_in_constraints);
+
+EDSW_API edsw_status edsw_explain_prop_value(uint32_t prop_id,
+                                             uint32_t value,
+                                             char *buffer,
+                                             size_t capacity,
+                                             size_t *length);
+
+EDSW_API edsw_status edsw_camera_start_live_view(edsw_camera *camera);
+EDSW_API edsw_status edsw_camera_stop_live_view(edsw_camera *camera);
+
+/* SDK writes the frame straight into a pooled buffer which is lent to the caller */
+EDSW_API edsw_status edsw_camera_acquire_live_view_frame(edsw_camera *camera,
+                                                         edsw_buffer **frame,
+                                                         const uint8_t **data,
+                                                         size_t *size);
+
+/* null callback detaches */
+EDSW_API edsw_status edsw_camera_set_download_callback(edsw_camera *camera,
+                                                       edsw_download_callback callback,
+                                                       void *user);
+
+/* maps a downloaded file read-only instead of reading it into host memory */
+EDSW_API edsw_status edsw_map_file(const char *path, edsw_buffer **file, const uint8_t **data, size_t *size);
+
+EDSW_API void edsw_buffer_release(edsw_buffer *buffer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EDSDK_C_H */
@@ -4,8 +4,13 @@
 #include <EDSDKErrors.h>
 #include <EDSDKTypes.h>
 
+#include <algorithm>
 #include <cassert>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <thread>
 
 namespace edsdk_w {
     namespace utils {
@@ -389,14 +394,38 @@ namespace edsdk_w {
                 default: return "unknown";
             }
         }
+
+        std::string explain_prop_value_text(std::string value) {
+            return value;
+        }
     }//namespace edsdk_w::utils
 
+    namespace {
+        using Explainer = std::string (*)(const std::uint32_t &);
+
+        template <Prop P>
+        constexpr Explainer explainer() {
+            if constexpr (property_table::is_numeric<P>) {
+                return &PropertyTraits<P>::explain;
+            } else {
+                return nullptr;
+            }
+        }
+
+        template <std::size_t... I>
+        constexpr std::array<Explainer, PROPERTY_COUNT> make_explainers(std::index_sequence<I...>) {
+            return {explainer<static_cast<Prop>(I)>()...};
+        }
+
+        constexpr auto EXPLAINERS = make_explainers(std::make_index_sequence<PROPERTY_COUNT>{});
+    }
+
     EDSDK& EDSDK::get_instance() {
         static EDSDK instance{};
         return instance;
     }
 
-    EDSDK::EDSDK() : _camera{nullptr} {
+    EDSDK::EDSDK() : _camera{nullptr}, _camera_generation{0} {
         assert(EdsInitializeSDK() == EDS_ERR_OK && "EDSDK initialization error");
         std::cout << "SDK Initialized" << std::endl; //TODO: remove console debug
     }
@@ -459,6 +488,7 @@ namespace edsdk_w {
             err = EdsGetChildAtIndex(cameraList, index_in_list, &camera_ref);
             if (err == EDS_ERR_OK) {
                 _camera = new Camera(camera_ref);
+                _camera_generation++;
 
                 EdsSetCameraStateEventHandler(camera_ref,
                                               kEdsStateEvent_Shutdown,
@@ -485,44 +515,35 @@ namespace edsdk_w {
     bool EDSDK::reset_camera() {
         delete _camera;
         _camera = nullptr;
+        _camera_generation++;
 
         return true;
     }
 
+    std::uint64_t EDSDK::camera_generation() const {
+        return _camera_generation;
+    }
+
     void EDSDK::events() {
         EdsGetEvent();
+
+        //callbacks delivered above only mark properties, fetching happens once per pump
+        auto &instance = get_instance();
+        if (instance._camera) {
+            instance._camera->_pump_thread.store(std::this_thread::get_id(), std::memory_order_relaxed);
+            instance._camera->_flush_dirty_properties();
+            instance._camera->_reconcile_properties();
+            instance._camera->_watch_session();
+            instance._camera->_run_capture_retries();
+        }
     }
 
     std::string EDSDK::explain_prop_value(std::uint32_t prop_id, std::uint32_t value) {
-        switch (prop_id) {
-            case kEdsPropID_ImageQuality:
-                return utils::explain_prop_value_image_quality(value);
-            case kEdsPropID_WhiteBalance:
-                return utils::explain_prop_value_white_balance(value);
-            case kEdsPropID_ColorTemperature:
-                return utils::explain_prop_value_color_temperature(value);
-            case kEdsPropID_ColorSpace:
-                return utils::explain_prop_value_color_space(value);
-            case kEdsPropID_AEMode:
-                return utils::explain_prop_value_ae_mode(value);
-            case kEdsPropID_DriveMode:
-                return utils::explain_prop_value_drive_mode(value);
-            case kEdsPropID_ISOSpeed:
-                return utils::explain_prop_value_iso_speed(value);
-            case kEdsPropID_MeteringMode:
-                return utils::explain_prop_value_metering_mode(value);
-            case kEdsPropID_AFMode:
-                return utils::explain_prop_value_af_mode(value);
-            case kEdsPropID_Av:
-                return utils::explain_prop_value_av(value);
-            case kEdsPropID_Tv:
-                return utils::explain_prop_value_tv(value);
-            case kEdsPropID_ExposureCompensation:
-                return utils::explain_prop_value_exposure_compensation(value);
-            default:
-                return "unknown property";
+        auto slot = property_table::slot_of(prop_id);
+        if (!slot || !EXPLAINERS[*slot]) {
+            return "unknown property";
         }
-
+        return EXPLAINERS[*slot](value);
     }
 
     std::vector<std::string> EDSDK::explain_prop_value(std::uint32_t prop_id, const std::vector<std::uint32_t> &value) {
@@ -543,39 +564,110 @@ namespace edsdk_w {
         return eds->reset_camera();
     }
 
-    EDSDK::Camera::Camera(EdsCameraRef camera) : _camera_ref{camera}, _explicit_session_opened{false} {
+    template <Prop P>
+    void EDSDK::Camera::_refresh_property() {
+        using Type = typename PropertyTraits<P>::type;
+        std::get<property_table::slot(P)>(_properties) = _retrieve_property<Type>(PropertyTraits<P>::id);
+    }
+
+    template <Prop P>
+    bool EDSDK::Camera::_set_by_index(std::uint32_t index_in_constraints) {
+        if constexpr (PropertyTraits<P>::settable) {
+            const auto &constraints = get_constraints<P>();
+            return index_in_constraints < constraints.size() && set<P>(constraints[index_in_constraints]);
+        } else {
+            return false;
+        }
+    }
+
+    template <Prop P>
+    bool EDSDK::Camera::_poll_property(bool &stale) {
+        using Type = typename PropertyTraits<P>::type;
+        EdsError err = EDS_ERR_OK;
+        auto value = _retrieve_property<Type>(PropertyTraits<P>::id, &err);
+        if (err != EDS_ERR_OK) {
+            return false;
+        }
+
+        auto &cached = std::get<property_table::slot(P)>(_properties);
+        stale = value != cached;
+        cached = std::move(value);
+        return true;
+    }
+
+    template <Prop P>
+    std::optional<std::uint32_t> EDSDK::Camera::_numeric_value() const {
+        if constexpr (property_table::is_numeric<P>) {
+            return get<P>();
+        } else {
+            return std::nullopt;
+        }
+    }
+
+    template <Prop P>
+    std::vector<std::string> EDSDK::Camera::_explain_constraints() const {
+        std::vector<std::string> res{};
+        for (const auto &value : get_constraints<P>()) {
+            res.push_back(PropertyTraits<P>::explain(value));
+        }
+        return res;
+    }
+
+    template <std::size_t... I>
+    constexpr auto EDSDK::Camera::_make_refreshers(std::index_sequence<I...>) {
+        using Refresher = void (Camera::*)();
+        return std::array<Refresher, sizeof...(I)>{&Camera::_refresh_property<static_cast<Prop>(I)>...};
+    }
+
+    template <std::size_t... I>
+    constexpr auto EDSDK::Camera::_make_index_setters(std::index_sequence<I...>) {
+        using Setter = bool (Camera::*)(std::uint32_t);
+        return std::array<Setter, sizeof...(I)>{&Camera::_set_by_index<static_cast<Prop>(I)>...};
+    }
+
+    template <std::size_t... I>
+    constexpr auto EDSDK::Camera::_make_value_getters(std::index_sequence<I...>) {
+        using Getter = std::optional<std::uint32_t> (Camera::*)() const;
+        return std::array<Getter, sizeof...(I)>{&Camera::_numeric_value<static_cast<Prop>(I)>...};
+    }
+
+    template <std::size_t... I>
+    constexpr auto EDSDK::Camera::_make_pollers(std::index_sequence<I...>) {
+        using Poller = bool (Camera::*)(bool &);
+        return std::array<Poller, sizeof...(I)>{&Camera::_poll_property<static_cast<Prop>(I)>...};
+    }
+
+    EDSDK::Camera::Camera(EdsCameraRef camera) : _dirty_properties{0},
+                                                 _dirty_constraints{0},
+                                                 _property_events{0},
+                                                 _property_fetches{0},
+                                                 _property_flushes{0},
+                                                 _published_values{},
+                                                 _capture_failures{},
+                                                 _camera_ref{camera},
+                                                 _storage{camera},
+                                                 _explicit_session_opened{false},
+                                                 _journal{nullptr},
+                                                 _post_processor{nullptr},
+                                                 _capture_writer{nullptr},
+                                                 _reconciler{nullptr},
+                                                 _watchdog{nullptr} {
         open_session();
 
         //loading initial properties values
-        _properties.name = _retrieve_property<std::string>(kEdsPropID_ProductName);
-        _properties.current_storage = _retrieve_property<std::string>(kEdsPropID_CurrentStorage);
-        _properties.body_id = _retrieve_property<std::string>(kEdsPropID_BodyIDEx);
-        _properties.firmware_version = _retrieve_property<std::string>(kEdsPropID_FirmwareVersion);
-
-        _properties.image_quality = _retrieve_property<std::uint32_t>(kEdsPropID_ImageQuality);
-        _properties.ae_mode = _retrieve_property<std::uint32_t>(kEdsPropID_AEMode);
-        _properties.af_mode = _retrieve_property<std::uint32_t>(kEdsPropID_AFMode);
-        _properties.lens_name = _retrieve_property<std::string>(kEdsPropID_LensName);
-
-        _properties.white_balance = _retrieve_property<std::int32_t>(kEdsPropID_WhiteBalance);
-        _properties.color_temperature = _retrieve_property<std::uint32_t>(kEdsPropID_ColorTemperature);
-        _properties.color_space = _retrieve_property<std::uint32_t>(kEdsPropID_ColorSpace);
-        _properties.drive_mode = _retrieve_property<std::uint32_t>(kEdsPropID_DriveMode);
-        _properties.metering_mode = _retrieve_property<std::uint32_t>(kEdsPropID_MeteringMode);
-        _properties.iso = _retrieve_property<std::uint32_t>(kEdsPropID_ISOSpeed);
-        _properties.av = _retrieve_property<std::uint32_t>(kEdsPropID_Av);
-        _properties.tv = _retrieve_property<std::uint32_t>(kEdsPropID_Tv);
-        _properties.exposure_compensation = _retrieve_property<std::uint32_t>(kEdsPropID_ExposureCompensation);
-
-        _properties_constraints.white_balance = _retrieve_property_constraints(kEdsPropID_WhiteBalance);
-        _properties_constraints.color_temperature = _retrieve_property_constraints(kEdsPropID_ColorTemperature);
-        _properties_constraints.color_space = _retrieve_property_constraints(kEdsPropID_ColorSpace);
-        _properties_constraints.drive_mode = _retrieve_property_constraints(kEdsPropID_DriveMode);
-        _properties_constraints.metering_mode = _retrieve_property_constraints(kEdsPropID_MeteringMode);
-        _properties_constraints.iso = _retrieve_property_constraints(kEdsPropID_ISOSpeed);
-        _properties_constraints.av = _retrieve_property_constraints(kEdsPropID_Av);
-        _properties_constraints.tv = _retrieve_property_constraints(kEdsPropID_Tv);
-        _properties_constraints.exposure_compensation = _retrieve_property_constraints(kEdsPropID_ExposureCompensation);
+        _device_info.name = _retrieve_property<std::string>(kEdsPropID_ProductName);
+        _device_info.current_storage = _retrieve_property<std::string>(kEdsPropID_CurrentStorage);
+        _device_info.body_id = _retrieve_property<std::string>(kEdsPropID_BodyIDEx);
+        _device_info.firmware_version = _retrieve_property<std::string>(kEdsPropID_FirmwareVersion);
+
+        constexpr auto refreshers = _make_refreshers(std::make_index_sequence<PROPERTY_COUNT>{});
+        for (std::size_t slot = 0; slot < PROPERTY_COUNT; slot++) {
+            (this->*refreshers[slot])();
+            if (property_table::SETTABLE[slot]) {
+                _properties_constraints[slot] = _retrieve_property_constraints(property_table::IDS[slot]);
+            }
+        }
+        _publish_properties((1u << PROPERTY_COUNT) - 1);
 
         //setting callbacks
         EdsSetPropertyEventHandler(_camera_ref,
@@ -588,10 +680,16 @@ namespace edsdk_w {
                                    EDSDK::Camera::_property_desc_changed_callback,
                                    this);
 
-       EdsSetCameraStateEventHandler(_camera_ref,
-                                     kEdsStateEvent_Shutdown,
-                                     EDSDK::Camera::_shutdown_notification_callback,
-                                     this);
+        EdsSetObjectEventHandler(_camera_ref,
+                                 kEdsObjectEvent_All,
+                                 EDSDK::Camera::_object_event_callback,
+                                 this);
+
+        //shutdown event itself is handled by EDSDK as disconnection
+        EdsSetCameraStateEventHandler(_camera_ref,
+                                      kEdsStateEvent_WillSoonShutDown,
+                                      EDSDK::Camera::_shutdown_notification_callback,
+                                      this);
 
         EdsSetCameraStateEventHandler(_camera_ref,
                                       kEdsStateEvent_CaptureError,
@@ -603,6 +701,7 @@ namespace edsdk_w {
     }
 
     EDSDK::Camera::~Camera()  {
+        _storage.clear();
         close_session();
         if (_camera_ref) {
             EdsRelease(_camera_ref);
@@ -610,19 +709,20 @@ namespace edsdk_w {
     }
 
     bool EDSDK::Camera::shutter_button() {
-        return shutter_button_press() && shutter_button_release();
+        _capture_failures.requested++;
+        return _shoot(0);
     }
 
     bool EDSDK::Camera::shutter_button_press() {
-        return _shutter_button_command(kEdsCameraCommand_ShutterButton_Completely);
+        return _shutter_button_command(kEdsCameraCommand_ShutterButton_Completely) == EDS_ERR_OK;
     }
 
     bool EDSDK::Camera::shutter_button_press_halfway() {
-        return _shutter_button_command(kEdsCameraCommand_ShutterButton_Halfway);
+        return _shutter_button_command(kEdsCameraCommand_ShutterButton_Halfway) == EDS_ERR_OK;
     }
 
     bool EDSDK::Camera::shutter_button_release(bool close_session) {
-        return _shutter_button_command(kEdsCameraCommand_ShutterButton_OFF);
+        return _shutter_button_command(kEdsCameraCommand_ShutterButton_OFF) == EDS_ERR_OK;
     }
 
     bool EDSDK::Camera::open_session() {
@@ -651,182 +751,543 @@ namespace edsdk_w {
         return EdsSendStatusCommand(_camera_ref, kEdsCameraStatusCommand_UIUnLock, 0) == EDS_ERR_OK;
     }
 
+    bool EDSDK::Camera::set_download_directory(const std::string &directory) {
+        EdsError err = EDS_ERR_OK;
+        EdsUInt32 save_to = kEdsSaveTo_Host;
+
+        err = EdsSetPropertyData(_camera_ref, kEdsPropID_SaveTo, 0, sizeof(save_to), &save_to);
+        if (err == EDS_ERR_OK) {
+            //camera refuses to shoot to host until it is told there is free space
+            EdsCapacity capacity = {0x7FFFFFFF, 0x1000, 1};
+            err = EdsSetCapacity(_camera_ref, capacity);
+        }
+        if (err == EDS_ERR_OK) {
+            _download_directory = directory;
+        }
+
+        return err == EDS_ERR_OK;
+    }
+
+    std::string EDSDK::Camera::get_download_directory() const {
+        return _download_directory;
+    }
+
+    bool EDSDK::Camera::start_live_view() {
+        EdsUInt32 evf_mode = 1;
+        EdsSetPropertyData(_camera_ref, kEdsPropID_Evf_Mode, 0, sizeof(evf_mode), &evf_mode);
+
+        auto device = _retrieve_property<std::uint32_t>(kEdsPropID_Evf_OutputDevice) | kEdsEvfOutputDevice_PC;
+        return EdsSetPropertyData(_camera_ref, kEdsPropID_Evf_OutputDevice, 0, sizeof(device), &device) == EDS_ERR_OK;
+    }
+
+    bool EDSDK::Camera::stop_live_view() {
+        auto device = _retrieve_property<std::uint32_t>(kEdsPropID_Evf_OutputDevice) & ~kEdsEvfOutputDevice_PC;
+        return EdsSetPropertyData(_camera_ref, kEdsPropID_Evf_OutputDevice, 0, sizeof(device), &device) == EDS_ERR_OK;
+    }
+
+    bool EDSDK::Camera::drive_lens_evf(EdsEvfDriveLens step) {
+        return EdsSendCommand(_camera_ref, kEdsCameraCommand_DriveLensEvf, step) == EDS_ERR_OK;
+    }
+
+    bool EDSDK::Camera::download_live_view_frame(std::vector<std::uint8_t> &frame) {
+        EdsError err = EDS_ERR_OK;
+        EdsStreamRef stream = nullptr;
+        EdsEvfImageRef evf_image = nullptr;
+
+        err = EdsCreateMemoryStream(0, &stream);
+        if (err == EDS_ERR_OK) {
+            err = EdsCreateEvfImageRef(stream, &evf_image);
+        }
+        if (err == EDS_ERR_OK) {
+            //EDS_ERR_OBJECT_NOTREADY is usual while camera prepares the first frame
+            err = EdsDownloadEvfImage(_camera_ref, evf_image);
+        }
+
+        EdsVoid *data = nullptr;
+        EdsUInt64 length = 0;
+        if (err == EDS_ERR_OK) {
+            err = EdsGetPointer(stream, &data);
+        }
+        if (err == EDS_ERR_OK) {
+            err = EdsGetLength(stream, &length);
+        }
+        if (err == EDS_ERR_OK) {
+            auto bytes = static_cast<const std::uint8_t*>(data);
+            frame.assign(bytes, bytes + length);
+        }
+
+        if (evf_image) {
+            EdsRelease(evf_image);
+        }
+        if (stream) {
+            EdsRelease(stream);
+        }
+
+        return err == EDS_ERR_OK;
+    }
+
+    bool EDSDK::Camera::download_live_view_frame(std::uint8_t *buffer, std::size_t capacity, std::size_t &size) {
+        EdsError err = EDS_ERR_OK;
+        EdsStreamRef stream = nullptr;
+        EdsEvfImageRef evf_image = nullptr;
+
+        err = EdsCreateMemoryStreamFromPointer(buffer, capacity, &stream);
+        if (err == EDS_ERR_OK) {
+            err = EdsCreateEvfImageRef(stream, &evf_image);
+        }
+        if (err == EDS_ERR_OK) {
+            err = EdsDownloadEvfImage(_camera_ref, evf_image);
+        }
+
+        //stream over caller memory does not grow, its position is the frame size
+        EdsUInt64 position = 0;
+        if (err == EDS_ERR_OK) {
+            err = EdsGetPosition(stream, &position);
+        }
+        if (err == EDS_ERR_OK) {
+            size = static_cast<std::size_t>(position);
+        }
+
+        if (evf_image) {
+            EdsRelease(evf_image);
+        }
+        if (stream) {
+            EdsRelease(stream);
+        }
+
+        return err == EDS_ERR_OK;
+    }
+
+    EdsError EDSDK::Camera::_download_chunked(EdsDirectoryItemRef item,
+                                              std::uint64_t size,
+                                              const std::string &path,
+                                              std::vector<std::uint8_t> *copy) {
+        if (!_capture_writer->open(path, size)) {
+            return EDS_ERR_FILE_OPEN_ERROR;
+        }
+        if (copy) {
+            copy->reserve(size);
+        }
+
+        //SDK continues transfer where previous EdsDownload call stopped
+        EdsError err = EDS_ERR_OK;
+        for (std::uint64_t done = 0; err == EDS_ERR_OK && done < size;) {
+            auto buffer = _capture_writer->acquire_buffer();
+            auto length = static_cast<std::size_t>(std::min<std::uint64_t>(_capture_writer->chunk_size(), size - done));
+            if (!buffer) {
+                err = EDS_ERR_FILE_WRITE_ERROR;
+                break;
+            }
+
+            EdsStreamRef stream = nullptr;
+            err = EdsCreateMemoryStreamFromPointer(buffer, length, &stream);
+            if (err == EDS_ERR_OK) {
+                err = EdsDownload(item, length, stream);
+            }
+            if (stream) {
+                EdsRelease(stream);
+            }
+
+            if (err == EDS_ERR_OK && copy) {
+                copy->insert(copy->end(), buffer, buffer + length);
+            }
+            if (!_capture_writer->submit(buffer, err == EDS_ERR_OK ? length : 0) && err == EDS_ERR_OK) {
+                err = EDS_ERR_FILE_WRITE_ERROR;
+            }
+            done += length;
+        }
+
+        if (!_capture_writer->close() && err == EDS_ERR_OK) {
+            err = EDS_ERR_FILE_WRITE_ERROR;
+        }
+        return err;
+    }
+
+    const CaptureLatency &EDSDK::Camera::get_capture_latency() const {
+        return _capture_latency;
+    }
+
+    StorageBrowser &EDSDK::Camera::storage() {
+        return _storage;
+    }
+
+    bool EDSDK::Camera::download_item(EdsDirectoryItemRef item, std::uint64_t size, const std::string &path) {
+        EdsError err = EDS_ERR_OK;
+        EdsStreamRef stream = nullptr;
+
+        if (_capture_writer) {
+            err = _download_chunked(item, size, path, nullptr);
+        } else {
+            err = EdsCreateFileStream(path.c_str(),
+                                      kEdsFileCreateDisposition_CreateAlways,
+                                      kEdsAccess_ReadWrite,
+                                      &stream);
+            if (err == EDS_ERR_OK) {
+                err = EdsDownload(item, size, stream);
+            }
+        }
+
+        if (err == EDS_ERR_OK) {
+            err = EdsDownloadComplete(item);
+        } else {
+            EdsDownloadCancel(item);
+        }
+
+        if (stream) {
+            EdsRelease(stream);
+        }
+        return err == EDS_ERR_OK;
+    }
+
+    void EDSDK::Camera::set_journal(CaptureJournal *journal) {
+        _journal = journal;
+    }
+
+    void EDSDK::Camera::set_post_processor(DownloadPostProcessor *post_processor) {
+        _post_processor = post_processor;
+    }
+
+    void EDSDK::Camera::set_capture_writer(CaptureWriter *capture_writer) {
+        _capture_writer = capture_writer;
+    }
+
     std::string EDSDK::Camera::get_name() const {
-        return _properties.name;
+        return _device_info.name;
     }
 
     std::string EDSDK::Camera::get_current_storage() const {
-        return _properties.current_storage;
+        return _device_info.current_storage;
     }
 
     std::string EDSDK::Camera::get_body_id() const {
-        return _properties.body_id;
+        return _device_info.body_id;
     }
 
     std::string EDSDK::Camera::get_firmware_version() const {
-        return _properties.firmware_version;
+        return _device_info.firmware_version;
     }
 
     std::string EDSDK::Camera::get_image_quality() const {
-        return EDSDK::explain_prop_value(kEdsPropID_ImageQuality, _properties.image_quality);
+        return explain<Prop::ImageQuality>();
     }
 
     std::string EDSDK::Camera::get_ae_mode() const {
-        return EDSDK::explain_prop_value(kEdsPropID_AEMode, _properties.ae_mode);
+        return explain<Prop::AEMode>();
     }
 
     std::string EDSDK::Camera::get_af_mode() const {
-        return EDSDK::explain_prop_value(kEdsPropID_AFMode, _properties.af_mode);
+        return explain<Prop::AFMode>();
     }
 
     std::string EDSDK::Camera::get_lens_name() const {
-        return _properties.lens_name;
+        return get<Prop::LensName>();
     }
 
     std::string EDSDK::Camera::get_white_balance() const {
-        return EDSDK::explain_prop_value(kEdsPropID_WhiteBalance, _properties.white_balance);
+        return explain<Prop::WhiteBalance>();
     }
 
     std::string EDSDK::Camera::get_color_temperature() const {
-        return EDSDK::explain_prop_value(kEdsPropID_ColorTemperature, _properties.color_temperature);
+        return explain<Prop::ColorTemperature>();
     }
 
     std::string EDSDK::Camera::get_color_space() const {
-        return EDSDK::explain_prop_value(kEdsPropID_ColorSpace, _properties.color_space);
+        return explain<Prop::ColorSpace>();
     }
 
     std::string EDSDK::Camera::get_drive_mode() const {
-        return EDSDK::explain_prop_value(kEdsPropID_DriveMode, _properties.drive_mode);
+        return explain<Prop::DriveMode>();
     }
 
     std::string EDSDK::Camera::get_metering_mode() const {
-        return EDSDK::explain_prop_value(kEdsPropID_MeteringMode, _properties.metering_mode);
+        return explain<Prop::MeteringMode>();
     }
 
     std::string EDSDK::Camera::get_iso() const {
-        return EDSDK::explain_prop_value(kEdsPropID_ISOSpeed, _properties.iso);
+        return explain<Prop::ISO>();
     }
 
     std::string EDSDK::Camera::get_av() const {
-        return EDSDK::explain_prop_value(kEdsPropID_Av, _properties.av);
+        return explain<Prop::Av>();
     }
 
     std::string EDSDK::Camera::get_tv() const {
-        return EDSDK::explain_prop_value(kEdsPropID_Tv, _properties.tv);
+        return explain<Prop::Tv>();
     }
 
     std::string EDSDK::Camera::get_exposure_compensation() const {
-        return EDSDK::explain_prop_value(kEdsPropID_ExposureCompensation, _properties.exposure_compensation);
+        return explain<Prop::ExposureCompensation>();
     }
 
     std::vector<std::string> EDSDK::Camera::get_white_balance_constraints() const {
-        return EDSDK::explain_prop_value(kEdsPropID_WhiteBalance, _properties_constraints.white_balance);
+        return _explain_constraints<Prop::WhiteBalance>();
     }
 
     std::vector<std::string> EDSDK::Camera::get_color_temperature_constraints() const {
-        return EDSDK::explain_prop_value(kEdsPropID_ColorTemperature, _properties_constraints.color_temperature);
+        return _explain_constraints<Prop::ColorTemperature>();
     }
 
     std::vector<std::string> EDSDK::Camera::get_color_space_constraints() const {
-        return EDSDK::explain_prop_value(kEdsPropID_ColorSpace, _properties_constraints.color_space);
+        return _explain_constraints<Prop::ColorSpace>();
     }
 
     std::vector<std::string> EDSDK::Camera::get_drive_mode_constraints() const {
-        return EDSDK::explain_prop_value(kEdsPropID_DriveMode, _properties_constraints.drive_mode);
+        return _explain_constraints<Prop::DriveMode>();
     }
 
     std::vector<std::string> EDSDK::Camera::get_metering_mode_constraints() const {
-        return EDSDK::explain_prop_value(kEdsPropID_MeteringMode, _properties_constraints.metering_mode);
+        return _explain_constraints<Prop::MeteringMode>();
     }
 
     std::vector<std::string> EDSDK::Camera::get_iso_constraints() const {
-        return EDSDK::explain_prop_value(kEdsPropID_ISOSpeed, _properties_constraints.iso);
+        return _explain_constraints<Prop::ISO>();
     }
 
     std::vector<std::string> EDSDK::Camera::get_av_constraints() const {
-        return EDSDK::explain_prop_value(kEdsPropID_Av, _properties_constraints.av);
+        return _explain_constraints<Prop::Av>();
     }
 
     std::vector<std::string> EDSDK::Camera::get_tv_constraints() const {
-        return EDSDK::explain_prop_value(kEdsPropID_Tv, _properties_constraints.tv);
+        return _explain_constraints<Prop::Tv>();
     }
 
     std::vector<std::string> EDSDK::Camera::get_exposure_compensation_constraints() const {
-        return EDSDK::explain_prop_value(kEdsPropID_ExposureCompensation, _properties_constraints.exposure_compensation);
+        return _explain_constraints<Prop::ExposureCompensation>();
     }
 
 
     bool EDSDK::Camera::set_white_balance(std::uint32_t index_in_constraints) {
-        return _set_property(kEdsPropID_WhiteBalance,
-                             &_properties.white_balance,
-                             _properties_constraints.white_balance,
-                             index_in_constraints);
+        return _set_by_index<Prop::WhiteBalance>(index_in_constraints);
     }
 
     bool EDSDK::Camera::set_color_temperature(std::uint32_t index_in_constraints) {
-        return _set_property(kEdsPropID_ColorTemperature,
-                             &_properties.color_temperature,
-                             _properties_constraints.color_temperature,
-                             index_in_constraints);
+        return _set_by_index<Prop::ColorTemperature>(index_in_constraints);
     }
 
     bool EDSDK::Camera::set_color_space(std::uint32_t index_in_constraints) {
-        return _set_property(kEdsPropID_ColorSpace,
-                             &_properties.color_space,
-                             _properties_constraints.color_space,
-                             index_in_constraints);
+        return _set_by_index<Prop::ColorSpace>(index_in_constraints);
     }
 
     bool EDSDK::Camera::set_drive_mode(std::uint32_t index_in_constraints) {
-        return _set_property(kEdsPropID_DriveMode,
-                             &_properties.drive_mode,
-                             _properties_constraints.drive_mode,
-                             index_in_constraints);
+        return _set_by_index<Prop::DriveMode>(index_in_constraints);
     }
 
     bool EDSDK::Camera::set_metering_mode(std::uint32_t index_in_constraints) {
-        return _set_property(kEdsPropID_MeteringMode,
-                             &_properties.metering_mode,
-                             _properties_constraints.metering_mode,
-                             index_in_constraints);
+        return _set_by_index<Prop::MeteringMode>(index_in_constraints);
     }
 
     bool EDSDK::Camera::set_iso(std::uint32_t index_in_constraints) {
-        return _set_property(kEdsPropID_ISOSpeed,
-                             &_properties.iso,
-                             _properties_constraints.iso,
-                             index_in_constraints);
+        return _set_by_index<Prop::ISO>(index_in_constraints);
     }
 
     bool EDSDK::Camera::set_av(std::uint32_t index_in_constraints) {
-        return _set_property(kEdsPropID_Av,
-                             &_properties.av,
-                             _properties_constraints.av,
-                             index_in_constraints);
+        return _set_by_index<Prop::Av>(index_in_constraints);
     }
 
     bool EDSDK::Camera::set_tv(std::uint32_t index_in_constraints) {
-        return _set_property(kEdsPropID_Tv,
-                             &_properties.tv,
-                             _properties_constraints.tv,
-                             index_in_constraints);
+        return _set_by_index<Prop::Tv>(index_in_constraints);
     }
 
     bool EDSDK::Camera::set_exposure_compensation(std::uint32_t index_in_constraints) {
-        return _set_property(kEdsPropID_ExposureCompensation,
-                             &_properties.exposure_compensation,
-                             _properties_constraints.exposure_compensation,
-                             index_in_constraints);
+        return _set_by_index<Prop::ExposureCompensation>(index_in_constraints);
+    }
+
+    std::optional<std::uint32_t> EDSDK::Camera::get_property_value(EdsPropertyID prop_id) const {
+        constexpr auto value_getters = _make_value_getters(std::make_index_sequence<PROPERTY_COUNT>{});
+
+        auto slot = property_table::slot_of(prop_id);
+        if (!slot) {
+            return std::nullopt;
+        }
+        return (this->*value_getters[*slot])();
+    }
+
+    std::vector<std::uint32_t> EDSDK::Camera::get_property_constraint_values(EdsPropertyID prop_id) const {
+        auto slot = property_table::slot_of(prop_id);
+        return slot ? _properties_constraints[*slot] : std::vector<std::uint32_t>{};
+    }
+
+    const std::vector<std::uint32_t> &EDSDK::Camera::get_property_constraints(EdsPropertyID prop_id) const {
+        static const std::vector<std::uint32_t> none{};
+        auto slot = property_table::slot_of(prop_id);
+        return slot ? _properties_constraints[*slot] : none;
+    }
+
+    bool EDSDK::Camera::set_property(EdsPropertyID prop_id, std::uint32_t index_in_constraints) {
+        constexpr auto index_setters = _make_index_setters(std::make_index_sequence<PROPERTY_COUNT>{});
+
+        auto slot = property_table::slot_of(prop_id);
+        return slot && (this->*index_setters[*slot])(index_in_constraints);
+    }
+
+    bool EDSDK::Camera::wait_for_property(EdsPropertyID prop_id,
+                                          const std::function<bool(std::uint32_t,
+                                                                   const std::vector<std::uint32_t> &)> &predicate,
+                                          std::chrono::milliseconds timeout) {
+        auto slot = property_table::slot_of(prop_id);
+        if (!slot) {
+            return false;
+        }
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+
+        //nobody else delivers events to the thread that pumps them, or before the first pump
+        auto pump_thread = _pump_thread.load(std::memory_order_relaxed);
+        if (pump_thread == std::thread::id{} || pump_thread == std::this_thread::get_id()) {
+            while (!predicate(get_property_value(prop_id).value_or(0), _properties_constraints[*slot])) {
+                if (std::chrono::steady_clock::now() >= deadline) {
+                    return false;
+                }
+                EDSDK::events();
+                std::this_thread::sleep_for(std::chrono::milliseconds{1});
+            }
+            return true;
+        }
+
+        std::unique_lock<std::mutex> lock{_wait_mutex};
+        return _properties_published.wait_until(lock, deadline, [this, &predicate, slot] {
+            return predicate(_published_values[*slot], _published_constraints[*slot]);
+        });
+    }
+
+    bool EDSDK::Camera::wait_for_property(EdsPropertyID prop_id, std::uint32_t value, std::chrono::milliseconds timeout) {
+        return wait_for_property(prop_id, [value](std::uint32_t current, const std::vector<std::uint32_t> &) {
+            return current == value;
+        }, timeout);
+    }
+
+    EDSDK::Camera::PropertyRefreshStats EDSDK::Camera::get_property_refresh_stats() const {
+        return {_property_events.load(std::memory_order_relaxed), _property_fetches, _property_flushes};
+    }
+
+    void EDSDK::Camera::set_property_reconciler(PropertyReconciler *reconciler) {
+        _reconciler = reconciler;
+    }
+
+    void EDSDK::Camera::set_capture_retry_policy(const CaptureRetryPolicy &policy) {
+        _retry_policy = policy;
+    }
+
+    void EDSDK::Camera::set_capture_failure_listener(std::function<void(const CaptureFailure &)> listener) {
+        _capture_failure_listener = std::move(listener);
+    }
+
+    CaptureFailureStats EDSDK::Camera::get_capture_failure_stats() const {
+        return _capture_failures;
     }
 
-    inline bool EDSDK::Camera::_shutter_button_command(EdsInt32 param) {
+    void EDSDK::Camera::set_session_watchdog(SessionWatchdog *watchdog) {
+        _watchdog = watchdog;
+    }
+
+    void EDSDK::Camera::set_property_listener(std::function<void(EdsPropertyID, std::uint32_t)> listener) {
+        _property_listener = std::move(listener);
+    }
+
+    void EDSDK::Camera::set_download_listener(std::function<void(const std::string &, std::uint64_t)> listener) {
+        _download_listener = std::move(listener);
+    }
+
+    inline EdsError EDSDK::Camera::_shutter_button_command(EdsInt32 param) {
         return EdsSendCommand(_camera_ref,
                               kEdsCameraCommand_PressShutterButton,
-                              param) == EDS_ERR_OK;
+                              param);
+    }
+
+    bool EDSDK::Camera::_shoot(std::uint32_t attempt) {
+        auto capture_id = _capture_latency.begin(_device_info.body_id, get<Prop::ImageQuality>(), attempt);
+        _capture_failures.attempts++;
+
+        //a half-press held by a refocus retry turns into the full press, focus is kept
+        auto err = _shutter_button_command(kEdsCameraCommand_ShutterButton_Completely);
+        if (err == EDS_ERR_OK) {
+            //shot is taken, failed release is reported but not retried
+            bool res = shutter_button_release();
+            _capture_latency.mark(capture_id, CaptureLatency::Stage::Returned);
+            if (res) {
+                _journal_append(CaptureJournal::RecordType::Triggered);
+            } else {
+                _capture_latency.finish(capture_id, true);
+            }
+            return res;
+        }
+
+        //button must not stay pressed after refused press
+        shutter_button_release();
+        _capture_latency.mark(capture_id, CaptureLatency::Stage::Returned);
+        _capture_latency.finish(capture_id, true);
+        if (!_on_capture_failure(capture_id, err, false, attempt)) {
+            return false;
+        }
+        _queue_retry(attempt + 1, classify_capture_error(err));
+        return true;
+    }
+
+    bool EDSDK::Camera::_on_capture_failure(std::uint64_t capture_id,
+                                            EdsError error,
+                                            bool reported_by_event,
+                                            std::uint32_t attempt) {
+        auto cause = classify_capture_error(error);
+        const auto &rule = _retry_policy.rule(cause);
+        auto &stats = _capture_failures.causes[static_cast<std::size_t>(cause)];
+
+        stats.failures++;
+        bool retry = rule.action != CaptureRetryPolicy::Action::GiveUp && attempt < rule.max_retries;
+        if (retry) {
+            stats.retries++;
+        } else {
+            stats.given_up++;
+            _capture_failures.given_up++;
+        }
+
+        if (_capture_failure_listener) {
+            _capture_failure_listener({capture_id, error, cause, reported_by_event, attempt, retry});
+        }
+        return retry;
+    }
+
+    void EDSDK::Camera::_queue_retry(std::uint32_t attempt, CaptureFailureCause cause) {
+        const auto &rule = _retry_policy.rule(cause);
+        auto now = std::chrono::steady_clock::now();
+        //refocus half-presses on the next pump and waits the delay from there
+        if (rule.action == CaptureRetryPolicy::Action::Refocus) {
+            _pending_retries.push_back({attempt, cause, now, false});
+        } else {
+            _pending_retries.push_back({attempt, cause, now + rule.delay, false});
+        }
+    }
+
+    void EDSDK::Camera::_run_capture_retries() {
+        if (_pending_retries.empty()) {
+            return;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        std::vector<PendingRetry> due{};
+        for (auto it = _pending_retries.begin(); it != _pending_retries.end();) {
+            if (it->due <= now) {
+                due.push_back(*it);
+                it = _pending_retries.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        for (auto &retry : due) {
+            const auto &rule = _retry_policy.rule(retry.cause);
+            if (rule.action == CaptureRetryPolicy::Action::Refocus && !retry.half_pressed) {
+                //button stays half-pressed until _shoot presses it fully and releases it
+                shutter_button_press_halfway();
+                retry.half_pressed = true;
+                retry.due = std::chrono::steady_clock::now() + rule.delay;
+                _pending_retries.push_back(retry);
+                continue;
+            }
+            _shoot(retry.attempt);
+        }
     }
 
     template <typename T>
-    T EDSDK::Camera::_retrieve_property(EdsUInt32 prop_id) {
+    T EDSDK::Camera::_retrieve_property(EdsUInt32 prop_id, EdsError *error) {
         T value;
         EdsError err = EDS_ERR_OK;
         EdsDataType data_type;
@@ -837,11 +1298,14 @@ namespace edsdk_w {
             err = EdsGetPropertyData(_camera_ref, prop_id, 0, data_size, &value);
         }
 
+        if (error) {
+            *error = err;
+        }
         return err == EDS_ERR_OK ? value : T{};
     }
 
     template <>
-    std::string EDSDK::Camera::_retrieve_property(EdsUInt32 prop_id) {
+    std::string EDSDK::Camera::_retrieve_property(EdsUInt32 prop_id, EdsError *error) {
         char value[EDS_MAX_NAME];
         EdsError err = EDS_ERR_OK;
         EdsDataType data_type;
@@ -852,6 +1316,9 @@ namespace edsdk_w {
             err = EdsGetPropertyData(_camera_ref, prop_id, 0, data_size, &value);
         }
 
+        if (error) {
+            *error = err;
+        }
         return err == EDS_ERR_OK ? std::string(value) : "";
     }
 
@@ -870,11 +1337,96 @@ namespace edsdk_w {
         return res;
     }
 
-    bool EDSDK::Camera::_set_property(EdsUInt32 prop_id,
-                                      std::uint32_t *prop_ptr,
-                                      const std::vector<std::uint32_t> &constraints,
-                                      std::uint32_t value_index) {
-        if (value_index >= constraints.size()) return false;
+    bool EDSDK::Camera::_download(EdsDirectoryItemRef item) {
+        EdsError err = EDS_ERR_OK;
+        EdsStreamRef stream = nullptr;
+        EdsDirectoryItemInfo item_info;
+        std::string path;
+        std::vector<std::uint8_t> data{};
+
+        auto capture_id = _capture_latency.mark_next(CaptureLatency::Stage::TransferStart);
+        err = EdsGetDirectoryItemInfo(item, &item_info);
+        if (err == EDS_ERR_OK) {
+            path = (std::filesystem::path(_download_directory) / item_info.szFileName).string();
+            if (_capture_writer) {
+                err = _download_chunked(item, item_info.size, path, _post_processor ? &data : nullptr);
+            } else if (_post_processor) {
+                data.resize(item_info.size);
+                err = EdsCreateMemoryStreamFromPointer(data.data(), item_info.size, &stream);
+            } else {
+                err = EdsCreateFileStream(path.c_str(),
+                                          kEdsFileCreateDisposition_CreateAlways,
+                                          kEdsAccess_ReadWrite,
+                                          &stream);
+            }
+        }
+        if (err == EDS_ERR_OK && stream) {
+            err = EdsDownload(item, item_info.size, stream);
+        }
+        if (err == EDS_ERR_OK && _post_processor && !_capture_writer) {
+            std::ofstream file{path, std::ios::binary | std::ios::trunc};
+            file.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()));
+            if (!file) {
+                err = EDS_ERR_FILE_WRITE_ERROR;
+            }
+        }
+
+        if (err == EDS_ERR_OK) {
+            err = EdsDownloadComplete(item);
+        } else {
+            EdsDownloadCancel(item);
+        }
+
+        if (stream) {
+            EdsRelease(stream);
+        }
+
+        _capture_latency.mark(capture_id, CaptureLatency::Stage::TransferEnd);
+        _capture_latency.finish_file(capture_id, CaptureLatency::Stage::TransferEnd, err != EDS_ERR_OK);
+
+        if (err == EDS_ERR_OK) {
+            if (_post_processor) {
+                _post_processor->submit(path, std::move(data));
+            }
+            _journal_append(CaptureJournal::RecordType::Downloaded, &item_info);
+            if (_download_listener) {
+                _download_listener(path, item_info.size);
+            }
+        }
+
+        return err == EDS_ERR_OK;
+    }
+
+    void EDSDK::Camera::_journal_append(CaptureJournal::RecordType type, const EdsDirectoryItemInfo *item_info) {
+        if (!_journal) {
+            return;
+        }
+
+        CaptureJournal::Record record{};
+        record.type = type;
+        std::strncpy(record.body_id, _device_info.body_id.c_str(), sizeof(record.body_id) - 1);
+
+        record.image_quality = get<Prop::ImageQuality>();
+        record.ae_mode = get<Prop::AEMode>();
+        record.av = get<Prop::Av>();
+        record.tv = get<Prop::Tv>();
+        record.iso = get<Prop::ISO>();
+        record.exposure_compensation = get<Prop::ExposureCompensation>();
+        record.white_balance = get<Prop::WhiteBalance>();
+        record.drive_mode = get<Prop::DriveMode>();
+
+        if (item_info) {
+            record.file_size = item_info->size;
+            std::strncpy(record.file_name, item_info->szFileName, sizeof(record.file_name) - 1);
+        }
+
+        _journal->append(record);
+    }
+
+    bool EDSDK::Camera::_write_property(EdsPropertyID prop_id,
+                                        std::uint32_t value,
+                                        const std::vector<std::uint32_t> &constraints) {
+        if (std::find(constraints.begin(), constraints.end(), value) == constraints.end()) return false;
 
         EdsError err;
         EdsDataType dataType;
@@ -882,10 +1434,7 @@ namespace edsdk_w {
 
         err = EdsGetPropertySize(_camera_ref, prop_id, 0, &dataType, &dataSize);
         if (err == EDS_ERR_OK) {
-            err = EdsSetPropertyData(_camera_ref, prop_id, 0, dataSize, &constraints[value_index]);
-            if (err == EDS_ERR_OK) {
-                *prop_ptr = constraints[value_index];
-            }
+            err = EdsSetPropertyData(_camera_ref, prop_id, 0, dataSize, &value);
         }
 
         return err == EDS_ERR_OK;
@@ -897,49 +1446,13 @@ namespace edsdk_w {
                                                                    EdsUInt32 param,
                                                                    EdsVoid *ctx) {
         auto camera = static_cast<EDSDK::Camera*>(ctx);
-        switch (prop_id) {
-            case kEdsPropID_WhiteBalance:
-                camera->_properties.white_balance = camera->_retrieve_property<std::uint32_t>(prop_id);
-                break;
-            case kEdsPropID_ColorTemperature:
-                camera->_properties.color_temperature = camera->_retrieve_property<std::uint32_t>(prop_id);
-                break;
-            case kEdsPropID_ColorSpace:
-                camera->_properties.color_space = camera->_retrieve_property<std::uint32_t>(prop_id);
-                break;
-            case kEdsPropID_DriveMode:
-                camera->_properties.drive_mode = camera->_retrieve_property<std::uint32_t>(prop_id);
-                break;
-            case kEdsPropID_MeteringMode:
-                camera->_properties.metering_mode = camera->_retrieve_property<std::uint32_t>(prop_id);
-                break;
-            case kEdsPropID_ISOSpeed:
-                camera->_properties.iso = camera->_retrieve_property<std::uint32_t>(prop_id);
-                break;
-            case kEdsPropID_Av:
-                camera->_properties.av = camera->_retrieve_property<std::uint32_t>(prop_id);
-                break;
-            case kEdsPropID_Tv:
-                camera->_properties.tv = camera->_retrieve_property<std::uint32_t>(prop_id);
-                break;
-            case kEdsPropID_ExposureCompensation:
-                camera->_properties.exposure_compensation = camera->_retrieve_property<std::uint32_t>(prop_id);
-                break;
-            case kEdsPropID_ImageQuality:
-                camera->_properties.image_quality = camera->_retrieve_property<std::uint32_t>(prop_id);
-                break;
-            case kEdsPropID_AEMode:
-                camera->_properties.ae_mode = camera->_retrieve_property<std::uint32_t>(prop_id);
-                break;
-            case kEdsPropID_AFMode:
-                camera->_properties.af_mode = camera->_retrieve_property<std::uint32_t>(prop_id);
-                break;
-            case kEdsPropID_LensName:
-                camera->_properties.lens_name = camera->_retrieve_property<std::string>(prop_id);
-                break;
-            default:
-                return EDS_ERR_INVALID_PARAMETER;
+        camera->_property_events.fetch_add(1, std::memory_order_relaxed);
+
+        auto slot = property_table::slot_of(prop_id);
+        if (!slot) {
+            return EDS_ERR_INVALID_PARAMETER;
         }
+        camera->_dirty_properties.fetch_or(1u << *slot, std::memory_order_release);
         return EDS_ERR_OK;
     }
 
@@ -948,37 +1461,165 @@ namespace edsdk_w {
                                                                    EdsUInt32 param,
                                                                    EdsVoid *ctx) {
         auto camera = static_cast<EDSDK::Camera*>(ctx);
-        std::vector<std::uint32_t> constraints = camera->_retrieve_property_constraints(prop_id);
-        switch (prop_id) {
-            case kEdsPropID_WhiteBalance:
-                camera->_properties_constraints.white_balance = std::move(constraints);
-                break;
-            case kEdsPropID_ColorTemperature:
-                camera->_properties_constraints.color_temperature = std::move(constraints);
-                break;
-            case kEdsPropID_ColorSpace:
-                camera->_properties_constraints.color_space = std::move(constraints);
-                break;
-            case kEdsPropID_DriveMode:
-                camera->_properties_constraints.drive_mode = std::move(constraints);
+        auto slot = property_table::slot_of(prop_id);
+        if (!slot || !property_table::SETTABLE[*slot]) {
+            return EDS_ERR_INVALID_PARAMETER;
+        }
+        camera->_dirty_constraints.fetch_or(1u << *slot, std::memory_order_release);
+        return EDS_ERR_OK;
+    }
+
+    void EDSDK::Camera::_flush_dirty_properties() {
+        constexpr auto refreshers = _make_refreshers(std::make_index_sequence<PROPERTY_COUNT>{});
+
+        auto dirty_constraints = _dirty_constraints.exchange(0, std::memory_order_acquire);
+        auto dirty_properties = _dirty_properties.exchange(0, std::memory_order_acquire);
+        if (!dirty_constraints && !dirty_properties) {
+            return;
+        }
+        _property_flushes++;
+
+        //constraints go first, so listeners see a value together with its current constraints
+        for (std::size_t slot = 0; slot < PROPERTY_COUNT; slot++) {
+            if (dirty_constraints & (1u << slot)) {
+                _properties_constraints[slot] = _retrieve_property_constraints(property_table::IDS[slot]);
+            }
+        }
+
+        auto now = PropertyReconciler::Clock::now();
+        for (std::size_t slot = 0; slot < PROPERTY_COUNT; slot++) {
+            if (!(dirty_properties & (1u << slot))) continue;
+
+            (this->*refreshers[slot])();
+            _property_fetches++;
+            if (_reconciler) {
+                _reconciler->on_event(slot, now);
+            }
+            if (_watchdog) {
+                _watchdog->on_activity(now);
+            }
+
+            if (_property_listener) {
+                auto prop_id = property_table::IDS[slot];
+                _property_listener(prop_id, get_property_value(prop_id).value_or(0));
+            }
+        }
+        _publish_properties(dirty_properties | dirty_constraints);
+    }
+
+    void EDSDK::Camera::_publish_properties(std::uint32_t slots) {
+        {
+            std::lock_guard<std::mutex> lock{_wait_mutex};
+            for (std::size_t slot = 0; slot < PROPERTY_COUNT; slot++) {
+                if (slots & (1u << slot)) {
+                    _published_values[slot] = get_property_value(property_table::IDS[slot]).value_or(0);
+                    _published_constraints[slot] = _properties_constraints[slot];
+                }
+            }
+        }
+        _properties_published.notify_all();
+    }
+
+    bool EDSDK::Camera::_captures_in_flight() {
+        //a lost transfer or item event must not hold off reads for the rest of the session
+        _capture_latency.expire_lost();
+        return _capture_latency.open_captures() > 0;
+    }
+
+    void EDSDK::Camera::_reconcile_properties() {
+        constexpr auto pollers = _make_pollers(std::make_index_sequence<PROPERTY_COUNT>{});
+        if (!_reconciler) {
+            return;
+        }
+
+        //reads wait until captures in flight are transferred
+        auto now = PropertyReconciler::Clock::now();
+        if (_captures_in_flight()) {
+            _reconciler->on_busy(now);
+            return;
+        }
+
+        while (auto slot = _reconciler->next_due(now)) {
+            bool stale = false;
+            bool read = (this->*pollers[*slot])(stale);
+            _reconciler->on_read(*slot, read && stale, now);
+            if (!read || !stale) continue;
+
+            //event for value was lost, the one for its constraints likely too
+            auto prop_id = property_table::IDS[*slot];
+            if (property_table::SETTABLE[*slot]) {
+                _properties_constraints[*slot] = _retrieve_property_constraints(prop_id);
+            }
+            _publish_properties(1u << *slot);
+            if (_property_listener) {
+                _property_listener(prop_id, get_property_value(prop_id).value_or(0));
+            }
+        }
+    }
+
+    void EDSDK::Camera::_watch_session() {
+        //session closed on purpose is left alone, broken one is reopened
+        if (!_watchdog || (!_explicit_session_opened && _watchdog->healthy())) {
+            return;
+        }
+
+        auto now = SessionWatchdog::Clock::now();
+        if (_captures_in_flight()) {
+            _watchdog->on_activity(now);
+            return;
+        }
+
+        switch (_watchdog->next_action(now)) {
+            case SessionWatchdog::Action::Probe: {
+                //battery level is a few bytes and is answered by every body
+                EdsUInt32 level = 0;
+                auto err = EdsGetPropertyData(_camera_ref, kEdsPropID_BatteryLevel, 0, sizeof(level), &level);
+                _watchdog->on_probe(err == EDS_ERR_OK, SessionWatchdog::Clock::now() - now, now);
                 break;
-            case kEdsPropID_MeteringMode:
-                camera->_properties_constraints.metering_mode = std::move(constraints);
+            }
+            case SessionWatchdog::Action::KeepAlive:
+                _watchdog->on_keep_alive(
+                        EdsSendCommand(_camera_ref, kEdsCameraCommand_ExtendShutDownTimer, 0) == EDS_ERR_OK, now);
                 break;
-            case kEdsPropID_ISOSpeed:
-                camera->_properties_constraints.iso = std::move(constraints);
+            case SessionWatchdog::Action::Reopen: {
+                EdsCloseSession(_camera_ref);
+                _explicit_session_opened = false;
+                //new session starts saving to card, captures must keep coming to host
+                bool reopened = open_session() &&
+                                (_download_directory.empty() || set_download_directory(_download_directory));
+                _watchdog->on_reopen(reopened, now);
                 break;
-            case kEdsPropID_Av:
-                camera->_properties_constraints.av = std::move(constraints);
+            }
+            case SessionWatchdog::Action::None:
                 break;
-            case kEdsPropID_Tv:
-                camera->_properties_constraints.tv = std::move(constraints);
+        }
+    }
+
+    EdsError EDSCALLBACK EDSDK::Camera::_object_event_callback(EdsObjectEvent event,
+                                                               EdsBaseRef object,
+                                                               EdsVoid *ctx) {
+        auto camera = static_cast<EDSDK::Camera*>(ctx);
+        switch (event) {
+            case kEdsObjectEvent_DirItemRequestTransfer:
+                camera->_capture_latency.mark_next(CaptureLatency::Stage::ObjectEvent);
+                camera->_download(object);
                 break;
-            case kEdsPropID_ExposureCompensation:
-                camera->_properties_constraints.exposure_compensation = std::move(constraints);
+            case kEdsObjectEvent_DirItemCreated:
+                //capture saved on card ends here
+                if (camera->_download_directory.empty()) {
+                    auto capture_id = camera->_capture_latency.mark_next(CaptureLatency::Stage::ObjectEvent);
+                    camera->_capture_latency.finish_file(capture_id, CaptureLatency::Stage::ObjectEvent);
+                }
+                camera->_storage.on_object_event(event);
                 break;
             default:
-                return EDS_ERR_INVALID_PARAMETER;
+                camera->_storage.on_object_event(event);
+                break;
+        }
+
+        //object is passed with a reference owned by the handler
+        if (object) {
+            EdsRelease(object);
         }
         return EDS_ERR_OK;
     }
@@ -987,14 +1628,25 @@ namespace edsdk_w {
                                                                 EdsUInt32 param,
                                                                 EdsVoid *ctx) {
         auto camera = static_cast<EDSDK::Camera*>(ctx);
-        return EdsSendCommand(camera->_camera_ref, kEdsCameraCommand_ExtendShutDownTimer, 0) == EDS_ERR_OK;
+        bool res = EdsSendCommand(camera->_camera_ref, kEdsCameraCommand_ExtendShutDownTimer, 0) == EDS_ERR_OK;
+        if (camera->_watchdog) {
+            camera->_watchdog->on_keep_alive(res, SessionWatchdog::Clock::now());
+        }
+        return EDS_ERR_OK;
     }
 
     EdsError EDSCALLBACK EDSDK::Camera::_capture_failure_callback(EdsStateEvent event,
                                                           EdsUInt32 param,
                                                           EdsVoid *ctx) {
         auto camera = static_cast<EDSDK::Camera*>(ctx);
-        //TODO: implement some logic, logging mb
+
+        //camera accepted the shot and failed it afterwards, param holds the error
+        auto record = camera->_capture_latency.fail_next();
+        auto attempt = record ? record->attempt : 0;
+        if (camera->_on_capture_failure(record ? record->id : 0, param, true, attempt)) {
+            //no commands from inside the handler, the retry is shot from EDSDK::events()
+            camera->_queue_retry(attempt + 1, classify_capture_error(param));
+        }
         return EDS_ERR_OK;
     }
 
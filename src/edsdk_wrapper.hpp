@@ -1,13 +1,32 @@
 #ifndef EDSDK_WRAPPER_HPP
 #define EDSDK_WRAPPER_HPP
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <thread>
 #include <string>
 #include <vector>
 #include <optional>
 #include <functional>
 #include "EDSDKTypes.h"
+#include "capture_journal.hpp"
+#include "capture_latency.hpp"
+#include "capture_retry.hpp"
+#include "capture_writer.hpp"
+#include "download_postprocessor.hpp"
+#include "property_reconciler.hpp"
+#include "property_traits.hpp"
+#include "session_watchdog.hpp"
+#include "storage_browser.hpp"
 
 namespace edsdk_w {
+    //live view frame buffers and publisher slots, largest bodies stay below 1 MB per frame
+    constexpr std::size_t LIVE_VIEW_FRAME_CAPACITY = 2 * 1024 * 1024;
+
     class EDSDK {
     public:
         class Camera {
@@ -23,6 +42,40 @@ namespace edsdk_w {
             bool lock_ui();
             bool unlock_ui();
 
+            //switches camera to save captures to host, files are downloaded into directory
+            bool set_download_directory(const std::string &directory);
+            [[nodiscard]] std::string get_download_directory() const;
+
+            bool start_live_view();
+            bool stop_live_view();
+
+            //moves focus by one step of given size towards near or far end, live view must be running;
+            //fails while camera is busy with a capture, callers retry
+            bool drive_lens_evf(EdsEvfDriveLens step);
+
+            //downloads current live view jpeg frame
+            bool download_live_view_frame(std::vector<std::uint8_t> &frame);
+
+            //same, but SDK writes the frame straight into caller memory
+            bool download_live_view_frame(std::uint8_t *buffer, std::size_t capacity, std::size_t &size);
+
+            //card contents, valid while camera is set in EDSDK
+            StorageBrowser &storage();
+
+            //downloads existing card item into path, through capture writer when one is set
+            bool download_item(EdsDirectoryItemRef item, std::uint64_t size, const std::string &path);
+
+            //journal is not owned by camera and must outlive it or be detached with nullptr
+            void set_journal(CaptureJournal *journal);
+
+            //with post processor set captures are downloaded into memory, written to download directory
+            //and handed over for checksum and preview extraction; same ownership rules as journal
+            void set_post_processor(DownloadPostProcessor *post_processor);
+
+            //with capture writer set captures are downloaded in chunks of writer buffer size
+            //and written while the rest is still transferring; same ownership rules as journal
+            void set_capture_writer(CaptureWriter *capture_writer);
+
             [[nodiscard]] std::string get_name() const;
             [[nodiscard]] std::string get_current_storage() const;
             [[nodiscard]] std::string get_body_id() const;
@@ -63,22 +116,172 @@ namespace edsdk_w {
             bool set_tv(std::uint32_t index_in_constraints);
             bool set_exposure_compensation(std::uint32_t index_in_constraints);
 
+            //typed access through property traits, resolved at compile time
+            template <Prop P>
+            [[nodiscard]] const typename PropertyTraits<P>::type &get() const {
+                return std::get<property_table::slot(P)>(_properties);
+            }
+
+            template <Prop P>
+            [[nodiscard]] std::string explain() const {
+                return PropertyTraits<P>::explain(get<P>());
+            }
+
+            template <Prop P>
+            [[nodiscard]] const std::vector<std::uint32_t> &get_constraints() const {
+                static_assert(PropertyTraits<P>::settable, "read-only property has no constraints");
+                return _properties_constraints[property_table::slot(P)];
+            }
+
+            //value must be one of current constraints
+            template <Prop P>
+            bool set(typename PropertyTraits<P>::type value) {
+                static_assert(PropertyTraits<P>::settable, "property is read-only");
+                if (!_write_property(PropertyTraits<P>::id, value, get_constraints<P>())) {
+                    return false;
+                }
+                std::get<property_table::slot(P)>(_properties) = value;
+                _publish_properties(1u << property_table::slot(P));
+                return true;
+            }
+
+            //raw access to numeric properties by id, for properties not listed above empty values are returned
+            [[nodiscard]] std::optional<std::uint32_t> get_property_value(EdsPropertyID prop_id) const;
+            [[nodiscard]] std::vector<std::uint32_t> get_property_constraint_values(EdsPropertyID prop_id) const;
+
+            //same without copy, reference is valid until the next EDSDK::events()
+            [[nodiscard]] const std::vector<std::uint32_t> &get_property_constraints(EdsPropertyID prop_id) const;
+
+            bool set_property(EdsPropertyID prop_id, std::uint32_t index_in_constraints);
+
+            //blocks until predicate accepts value and constraints of a numeric property or timeout passes;
+            //other threads sleep on a condition variable until EDSDK::events() applies a change, which is
+            //for hosts pumping on a thread of their own; waits on the pump thread, as in batch runner, daemon
+            //and profiles, cannot sleep on it and still pump and poll every millisecond
+            bool wait_for_property(EdsPropertyID prop_id,
+                                   const std::function<bool(std::uint32_t value,
+                                                            const std::vector<std::uint32_t> &constraints)> &predicate,
+                                   std::chrono::milliseconds timeout);
+
+            bool wait_for_property(EdsPropertyID prop_id, std::uint32_t value, std::chrono::milliseconds timeout);
+
+            //with watchdog set EDSDK::events() probes idle session, keeps camera awake and reopens
+            //session after failed probes; same ownership rules as journal
+            void set_session_watchdog(SessionWatchdog *watchdog);
+
+            //listener is called from EDSDK::events() after the cached value of property is updated
+            void set_property_listener(std::function<void(EdsPropertyID, std::uint32_t)> listener);
+
+            struct PropertyRefreshStats {
+                std::uint64_t events;
+                std::uint64_t fetches;
+                std::uint64_t flushes;
+            };
+
+            //change events vs SDK fetches, a burst of events for one property costs one fetch per flush
+            [[nodiscard]] PropertyRefreshStats get_property_refresh_stats() const;
+
+            //with reconciler set EDSDK::events() re-reads properties it schedules and fixes stale cache
+            //entries, listener is called for them as for events; same ownership rules as journal
+            void set_property_reconciler(PropertyReconciler *reconciler);
+
+            //shutter to file latencies of captures taken with shutter_button()
+            [[nodiscard]] const CaptureLatency &get_capture_latency() const;
+
+            //failed presses of shutter_button() and capture errors reported later are retried as policy says;
+            //retries are shot from EDSDK::events() after the delay, shutter_button() returns true while one is queued
+            void set_capture_retry_policy(const CaptureRetryPolicy &policy);
+
+            //listener is called for every failed attempt, from shutter_button() or EDSDK::events()
+            void set_capture_failure_listener(std::function<void(const CaptureFailure &)> listener);
+
+            [[nodiscard]] CaptureFailureStats get_capture_failure_stats() const;
+
+            //listener is called from EDSDK::events() after a capture is downloaded into download directory
+            void set_download_listener(std::function<void(const std::string &path, std::uint64_t size)> listener);
+
         private:
             explicit Camera(EdsCameraRef camera);
 
             ~Camera();
 
-            inline bool _shutter_button_command(EdsInt32 param);
+            inline EdsError _shutter_button_command(EdsInt32 param);
+
+            //presses shutter, failed presses are queued for retry as policy allows;
+            //returns false once policy gives up
+            bool _shoot(std::uint32_t attempt);
+
+            //counts failure and tells listener, returns whether policy allows another attempt
+            bool _on_capture_failure(std::uint64_t capture_id, EdsError error, bool reported_by_event, std::uint32_t attempt);
+
+            //schedules attempt after the policy delay, never blocks the pumping thread
+            void _queue_retry(std::uint32_t attempt, CaptureFailureCause cause);
+
+            //half-presses for refocus retries and shoots due retries, called from EDSDK::events()
+            void _run_capture_retries();
 
             template <typename T>
-            T _retrieve_property(EdsUInt32 prop_id);
+            T _retrieve_property(EdsUInt32 prop_id, EdsError *error = nullptr);
 
             std::vector<std::uint32_t> _retrieve_property_constraints(EdsUInt32 prop_id);
 
-            bool _set_property(EdsUInt32 prop_id,
-                               std::uint32_t *prop_ptr,
-                               const std::vector<std::uint32_t> &constraints,
-                               std::uint32_t value_index);
+            bool _download(EdsDirectoryItemRef item);
+
+            //copy receives file content for post processor when not null
+            EdsError _download_chunked(EdsDirectoryItemRef item,
+                                       std::uint64_t size,
+                                       const std::string &path,
+                                       std::vector<std::uint8_t> *copy);
+
+            //refreshes properties marked by change callbacks, called from EDSDK::events()
+            void _flush_dirty_properties();
+
+            //copies slots of mask for waiters on other threads and wakes them
+            void _publish_properties(std::uint32_t slots);
+
+            //captures waiting for their files, lost ones are expired first; reconciler and watchdog wait for them
+            bool _captures_in_flight();
+
+            //reads properties due in reconciler, called from EDSDK::events()
+            void _reconcile_properties();
+
+            //runs action due in watchdog, called from EDSDK::events()
+            void _watch_session();
+
+            void _journal_append(CaptureJournal::RecordType type, const EdsDirectoryItemInfo *item_info = nullptr);
+
+            bool _write_property(EdsPropertyID prop_id,
+                                 std::uint32_t value,
+                                 const std::vector<std::uint32_t> &constraints);
+
+            template <Prop P>
+            void _refresh_property();
+
+            template <Prop P>
+            bool _set_by_index(std::uint32_t index_in_constraints);
+
+            //re-reads property, stale tells whether cached value differed; false if read failed
+            template <Prop P>
+            bool _poll_property(bool &stale);
+
+            template <Prop P>
+            [[nodiscard]] std::optional<std::uint32_t> _numeric_value() const;
+
+            template <Prop P>
+            [[nodiscard]] std::vector<std::string> _explain_constraints() const;
+
+            //dispatch tables indexed by property slot
+            template <std::size_t... I>
+            static constexpr auto _make_refreshers(std::index_sequence<I...>);
+
+            template <std::size_t... I>
+            static constexpr auto _make_index_setters(std::index_sequence<I...>);
+
+            template <std::size_t... I>
+            static constexpr auto _make_value_getters(std::index_sequence<I...>);
+
+            template <std::size_t... I>
+            static constexpr auto _make_pollers(std::index_sequence<I...>);
 
             static EdsError EDSCALLBACK _property_changed_callback(EdsPropertyEvent event,
                                                                    EdsPropertyID prop_id,
@@ -90,6 +293,10 @@ namespace edsdk_w {
                                                                    EdsUInt32 param,
                                                                    EdsVoid *ctx);
 
+            static EdsError EDSCALLBACK _object_event_callback(EdsObjectEvent event,
+                                                               EdsBaseRef object,
+                                                               EdsVoid *ctx);
+
             static EdsError EDSCALLBACK _shutdown_notification_callback(EdsPropertyEvent event,
                                                                         EdsUInt32 param,
                                                                         EdsVoid *ctx);
@@ -99,45 +306,57 @@ namespace edsdk_w {
                                                                         EdsVoid *ctx);
 
             struct {
-                //immutable
                 std::string name;
                 std::string current_storage;
                 std::string body_id;
                 std::string firmware_version;
-
-                //read-only
-                std::uint32_t image_quality;
-                std::uint32_t ae_mode;
-                std::uint32_t af_mode;
-                std::string lens_name;
-
-                //settable
-                std::uint32_t white_balance;
-                std::uint32_t color_temperature;
-                std::uint32_t color_space;
-                std::uint32_t drive_mode;
-                std::uint32_t metering_mode;
-                std::uint32_t iso;
-                std::uint32_t av;
-                std::uint32_t tv;
-                std::uint32_t exposure_compensation;
-            } _properties;
-
-            struct {
-                std::vector<std::uint32_t> white_balance;
-                std::vector<std::uint32_t> color_temperature;
-                std::vector<std::uint32_t> color_space;
-                std::vector<std::uint32_t> drive_mode;
-                std::vector<std::uint32_t> metering_mode;
-                std::vector<std::uint32_t> iso;
-                std::vector<std::uint32_t> av;
-                std::vector<std::uint32_t> tv;
-                std::vector<std::uint32_t> exposure_compensation;
-            } _properties_constraints;
+            } _device_info;
+
+            property_table::Storage _properties;
+            std::array<std::vector<std::uint32_t>, PROPERTY_COUNT> _properties_constraints;
+
+            //bit per property slot, set by callbacks and cleared by the flush
+            static_assert(PROPERTY_COUNT <= 32, "dirty masks hold one bit per property slot");
+            std::atomic<std::uint32_t> _dirty_properties;
+            std::atomic<std::uint32_t> _dirty_constraints;
+            std::atomic<std::uint64_t> _property_events;
+            std::uint64_t _property_fetches;
+            std::uint64_t _property_flushes;
+
+            //cache copies read by waiters on other threads, guarded by wait mutex
+            std::mutex _wait_mutex;
+            std::condition_variable _properties_published;
+            std::array<std::uint32_t, PROPERTY_COUNT> _published_values;
+            std::array<std::vector<std::uint32_t>, PROPERTY_COUNT> _published_constraints;
+            std::atomic<std::thread::id> _pump_thread;
+
+            CaptureLatency _capture_latency;
+
+            struct PendingRetry {
+                std::uint32_t attempt;
+                CaptureFailureCause cause;
+                std::chrono::steady_clock::time_point due;
+                bool half_pressed;
+            };
+
+            CaptureRetryPolicy _retry_policy;
+            CaptureFailureStats _capture_failures;
+            std::deque<PendingRetry> _pending_retries;
+            std::function<void(const CaptureFailure &)> _capture_failure_listener;
 
             EdsCameraRef _camera_ref;
+            StorageBrowser _storage;
             bool _explicit_session_opened;
 
+            std::string _download_directory;
+            CaptureJournal *_journal;
+            DownloadPostProcessor *_post_processor;
+            CaptureWriter *_capture_writer;
+            PropertyReconciler *_reconciler;
+            SessionWatchdog *_watchdog;
+            std::function<void(EdsPropertyID, std::uint32_t)> _property_listener;
+            std::function<void(const std::string &, std::uint64_t)> _download_listener;
+
             friend EDSDK;
         };
 
@@ -155,6 +374,9 @@ namespace edsdk_w {
 
         bool reset_camera();
 
+        //bumped by set_camera() and reset_camera(), a new camera may reuse the address of a dropped one
+        [[nodiscard]] std::uint64_t camera_generation() const;
+
         static void events();
 
         static std::string explain_prop_value(std::uint32_t prop_id, std::uint32_t value);
@@ -170,10 +392,11 @@ namespace edsdk_w {
                                                                    EdsVoid *ctx);
 
         Camera *_camera;
+        std::uint64_t _camera_generation;
     };
 
     template <>
-    std::string EDSDK::Camera::_retrieve_property(EdsUInt32 prop_id);
+    std::string EDSDK::Camera::_retrieve_property(EdsUInt32 prop_id, EdsError *error);
 
 } //namespace edsdk_w
 
@@ -0,0 +1,104 @@
+#include "embedded_preview.hpp"
+
+#include <cstring>
+#include "isobmff.hpp"
+#include "tiff_reader.hpp"
+
+namespace edsdk_w {
+    namespace {
+        constexpr std::uint16_t TAG_STRIP_OFFSETS = 0x0111;
+        constexpr std::uint16_t TAG_STRIP_BYTE_COUNTS = 0x0117;
+        constexpr std::uint16_t TAG_JPEG_OFFSET = 0x0201;
+        constexpr std::uint16_t TAG_JPEG_LENGTH = 0x0202;
+
+        //uuid of the CR3 box holding PRVW preview
+        constexpr std::uint8_t CR3_PREVIEW_UUID[16] = {0xea, 0xf4, 0x2b, 0x5e, 0x1c, 0x98, 0x4b, 0x88,
+                                                       0xb9, 0xfb, 0xb7, 0xdc, 0x40, 0x6e, 0x4d, 0x16};
+
+        bool is_jpeg(const std::uint8_t *data, std::size_t size, const EmbeddedPreview &preview) {
+            return preview.size >= 4 && preview.offset <= size && preview.size <= size - preview.offset &&
+                   data[preview.offset] == 0xff && data[preview.offset + 1] == 0xd8;
+        }
+
+        void keep_larger(std::optional<EmbeddedPreview> &best, const EmbeddedPreview &candidate,
+                         const std::uint8_t *data, std::size_t size) {
+            if (is_jpeg(data, size, candidate) && (!best || candidate.size > best->size)) {
+                best = candidate;
+            }
+        }
+
+        //scans ifd for offset/length tag pair, returns offset of next ifd or 0
+        std::uint32_t find_pair(const TiffReader &tiff, std::uint32_t ifd,
+                                std::uint16_t offset_tag, std::uint16_t length_tag,
+                                std::optional<EmbeddedPreview> &res) {
+            std::optional<std::uint32_t> offset{}, length{};
+            auto next = tiff.for_each_entry(ifd, [&](const TiffReader::Entry &entry) {
+                if (entry.count != 1) return; //single strip only
+                if (entry.tag == offset_tag) offset = tiff.integer(entry);
+                if (entry.tag == length_tag) length = tiff.integer(entry);
+            });
+            if (offset && length) {
+                res = EmbeddedPreview{*offset, *length};
+            }
+            return next;
+        }
+
+        //IFD0 strip of CR2 is the full size jpeg, IFD1 holds the small thumbnail
+        std::optional<EmbeddedPreview> find_in_tiff(const std::uint8_t *data, std::size_t size, std::size_t tiff_start) {
+            std::optional<EmbeddedPreview> best{};
+            TiffReader tiff{data + tiff_start, size - tiff_start};
+            if (!tiff.read_header()) {
+                return best;
+            }
+
+            std::optional<EmbeddedPreview> candidate{};
+            auto ifd1 = find_pair(tiff, tiff.first_ifd(), TAG_STRIP_OFFSETS, TAG_STRIP_BYTE_COUNTS, candidate);
+            if (candidate) {
+                keep_larger(best, {candidate->offset + tiff_start, candidate->size}, data, size);
+            }
+            candidate.reset();
+            find_pair(tiff, ifd1, TAG_JPEG_OFFSET, TAG_JPEG_LENGTH, candidate);
+            if (candidate) {
+                keep_larger(best, {candidate->offset + tiff_start, candidate->size}, data, size);
+            }
+            return best;
+        }
+
+        std::optional<EmbeddedPreview> find_in_jpeg(const std::uint8_t *data, std::size_t size) {
+            std::size_t tiff_start = 0, tiff_size = 0;
+            if (!find_jpeg_exif(data, size, tiff_start, tiff_size)) {
+                return std::nullopt;
+            }
+            return find_in_tiff(data, tiff_start + tiff_size, tiff_start);
+        }
+
+        //PRVW box: size, 'PRVW', 4 + 2 unknown bytes, width, height, 2 unknown bytes, jpeg size, jpeg
+        std::optional<EmbeddedPreview> find_in_cr3(const std::uint8_t *data, std::size_t size) {
+            std::optional<EmbeddedPreview> res{};
+            isobmff::for_each_box(data, 0, size, [&](const isobmff::Box &box) {
+                if (!isobmff::is_uuid(data, box, CR3_PREVIEW_UUID)) {
+                    return true;
+                }
+                std::size_t prvw = box.payload + 16 + 8;
+                if (prvw + 24 <= box.end && std::memcmp(data + prvw + 4, "PRVW", 4) == 0) {
+                    EmbeddedPreview preview{prvw + 24, isobmff::read_be32(data + prvw + 20)};
+                    if (is_jpeg(data, size, preview)) {
+                        res = preview;
+                    }
+                }
+                return false;
+            });
+            return res;
+        }
+    }
+
+    std::optional<EmbeddedPreview> find_embedded_preview(const std::uint8_t *data, std::size_t size) {
+        if (size >= 4 && data[0] == 0xff && data[1] == 0xd8) {
+            return find_in_jpeg(data, size);
+        }
+        if (size >= 12 && std::memcmp(data + 4, "ftypcrx ", 8) == 0) {
+            return find_in_cr3(data, size);
+        }
+        return find_in_tiff(data, size, 0);
+    }
+} //namespace edsdk_w
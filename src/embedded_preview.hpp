@@ -0,0 +1,19 @@
+#ifndef EMBEDDED_PREVIEW_HPP
+#define EMBEDDED_PREVIEW_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+namespace edsdk_w {
+    struct EmbeddedPreview {
+        std::size_t offset;
+        std::size_t size;
+    };
+
+    //locates the largest jpeg preview embedded in a capture held in memory:
+    //CR2 full size preview, CR3 PRVW box or EXIF thumbnail of a jpeg
+    std::optional<EmbeddedPreview> find_embedded_preview(const std::uint8_t *data, std::size_t size);
+} //namespace edsdk_w
+
+#endif //EMBEDDED_PREVIEW_HPP
@@ -0,0 +1,119 @@
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "luma_decoder.hpp"
+#include "luma_histogram.hpp"
+
+//single core cost of exposure metering:
+//exposure_bench [directory of recorded live view jpeg frames] [rounds]
+//histogram kernels run on synthetic luma frames, recorded frames add the decode that comes before them
+namespace {
+    using clock = std::chrono::steady_clock;
+    using namespace edsdk_w;
+
+    //noisy gradient, every zone gets pixels
+    std::vector<std::uint8_t> synthetic_frame(std::uint32_t width, std::uint32_t height) {
+        std::vector<std::uint8_t> res(static_cast<std::size_t>(width) * height);
+        std::uint32_t noise = 1;
+        for (std::size_t i = 0; i < res.size(); i++) {
+            noise = noise * 1103515245 + 12345;
+            res[i] = static_cast<std::uint8_t>((i % width) * 255 / width ^ (noise >> 28));
+        }
+        //a clipped band, so the clipped counter is compared too
+        std::fill(res.begin(), res.begin() + static_cast<std::ptrdiff_t>(res.size() / 16), 0xff);
+        return res;
+    }
+
+    LumaHistogram run_kernel(const char *name,
+                             void (*kernel)(const std::uint8_t *, std::size_t, LumaHistogram &),
+                             std::uint32_t width,
+                             std::uint32_t height,
+                             std::size_t rounds) {
+        auto frame = synthetic_frame(width, height);
+        LumaHistogram histogram{};
+        std::uint64_t checksum = 0;
+
+        auto start = clock::now();
+        for (std::size_t r = 0; r < rounds; r++) {
+            kernel(frame.data(), frame.size(), histogram);
+            checksum += histogram.zones[r % LumaHistogram::ZONES];
+        }
+        double seconds = std::chrono::duration<double>(clock::now() - start).count();
+        std::cout << std::fixed << std::setprecision(0) << name << " " << width << "x" << height << ": "
+                  << static_cast<double>(rounds) / seconds << " frames/s, " << std::setprecision(2)
+                  << static_cast<double>(frame.size() * rounds) / seconds / 1e9 << " Gpixel/s (checksum "
+                  << checksum << ")" << std::endl;
+        return histogram;
+    }
+}
+
+int main(int argc, char **argv) {
+    std::size_t rounds = argc > 2 ? std::stoul(argv[2]) : 2000;
+
+    //live view is 960x640 on most bodies, metered at 1/8, 1/4 and full size
+    for (auto [width, height] : {std::pair<std::uint32_t, std::uint32_t>{120, 80}, {240, 160}, {960, 640}}) {
+        auto expected = run_kernel("scalar", luma_histogram_scalar, width, height, rounds);
+        auto actual = run_kernel(luma_histogram_isa(), luma_histogram, width, height, rounds);
+        if (actual.zones != expected.zones || actual.sum != expected.sum || actual.clipped != expected.clipped) {
+            std::cerr << luma_histogram_isa() << " histogram differs from scalar" << std::endl;
+            return 1;
+        }
+    }
+
+    if (argc < 2) {
+        return 0;
+    }
+    if (!LumaDecoder::available()) {
+        std::cerr << "built without jpeg decoder" << std::endl;
+        return 1;
+    }
+
+    std::vector<std::vector<std::uint8_t>> recorded{};
+    for (const auto &entry : std::filesystem::directory_iterator{argv[1]}) {
+        if (entry.is_regular_file()) {
+            std::ifstream file{entry.path(), std::ios::binary};
+            recorded.emplace_back(std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{});
+        }
+    }
+    if (recorded.empty()) {
+        std::cerr << "no frames in " << argv[1] << std::endl;
+        return 1;
+    }
+
+    LumaDecoder decoder{};
+    std::vector<std::uint8_t> luma{};
+    for (std::uint32_t scale : {8u, 4u}) {
+        std::size_t frames = 0, failures = 0;
+        double decode_ms = 0, histogram_ms = 0, mean = 0;
+        for (std::size_t r = 0; r < std::max<std::size_t>(1, rounds / 200); r++) {
+            for (const auto &jpeg : recorded) {
+                std::uint32_t width = 0, height = 0;
+                auto start = clock::now();
+                bool decoded = decoder.decode(jpeg.data(), jpeg.size(), scale, luma, width, height);
+                auto decoded_at = clock::now();
+                decode_ms += std::chrono::duration<double, std::milli>(decoded_at - start).count();
+                frames++;
+                if (!decoded) {
+                    failures++;
+                    continue;
+                }
+                LumaHistogram histogram{};
+                luma_histogram(luma.data(), luma.size(), histogram);
+                histogram_ms += std::chrono::duration<double, std::milli>(clock::now() - decoded_at).count();
+                mean += histogram.mean();
+            }
+        }
+        auto count = static_cast<double>(frames);
+        std::cout << std::fixed << std::setprecision(3) << "decode 1/" << scale << " + histogram: "
+                  << decode_ms / count << " + " << histogram_ms / count << " ms per frame, mean luma "
+                  << std::setprecision(1) << mean / static_cast<double>(std::max<std::size_t>(1, frames - failures))
+                  << ", " << failures << " not decoded" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,192 @@
+#include "exposure_controller.hpp"
+
+#include <EDSDKTypes.h>
+
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+
+namespace edsdk_w {
+    namespace {
+        //a stop doubles linear light but moves sRGB luma only by 2^(1/2.2)
+        constexpr double GAMMA = 2.2;
+
+        //Tv, Av and ISO codes step by 8 per stop, Tv grows with shutter speed
+        constexpr double CODES_PER_STOP = 8;
+        constexpr std::uint32_t TV_FASTEST = 0xa0;
+        constexpr std::uint32_t ISO_LOWEST = 0x28;
+
+        bool usable_tv(std::uint32_t value, const ExposureController::Options &options) {
+            return value >= options.slowest_tv && value <= TV_FASTEST;
+        }
+
+        bool usable_iso(std::uint32_t value, const ExposureController::Options &options) {
+            return value >= ISO_LOWEST && value <= options.highest_iso;
+        }
+    }
+
+    ExposureController::ExposureController(EDSDK::Camera &camera, const Options &options) :
+            _camera{camera},
+            _options{options},
+            _error{0},
+            _settle{0},
+            _running{false},
+            _failed{false},
+            _stats{} {}
+
+    bool ExposureController::start() {
+        if (!LumaDecoder::available() || !_camera.start_live_view()) {
+            _failed = true;
+            return false;
+        }
+
+        _frame.resize(LIVE_VIEW_FRAME_CAPACITY);
+        _stats = {};
+        _stats.converged_ms = -1;
+        _error = 0;
+        //first frames come before live view has adjusted to the current settings
+        _settle = _options.settle_frames;
+        _start = _end = Clock::now();
+        _running = true;
+        _failed = false;
+        return true;
+    }
+
+    bool ExposureController::step() {
+        if (!_running) {
+            return false;
+        }
+        auto now = Clock::now();
+        if (_options.duration.count() > 0 && now - _start >= _options.duration) {
+            return _finish(false);
+        }
+
+        std::size_t size = 0;
+        if (!_camera.download_live_view_frame(_frame.data(), _frame.size(), size)) {
+            return true;
+        }
+        _stats.frames++;
+
+        std::uint32_t width = 0, height = 0;
+        bool decoded = _decoder.decode(_frame.data(), size, _options.scale_denominator, _luma, width, height);
+        auto decoded_at = Clock::now();
+        _stats.decode_ms += std::chrono::duration<double, std::milli>(decoded_at - now).count();
+        if (!decoded) {
+            _stats.decode_failures++;
+            return true;
+        }
+
+        LumaHistogram histogram{};
+        luma_histogram(_luma.data(), _luma.size(), histogram);
+        auto metered_at = Clock::now();
+        _stats.histogram_ms += std::chrono::duration<double, std::milli>(metered_at - decoded_at).count();
+        _stats.last_mean = histogram.mean();
+
+        if (_settle > 0) {
+            _settle--;
+            return true;
+        }
+
+        auto error = exposure_error(histogram, _options);
+        _error = _stats.metered_frames++ == 0 ? error : _error + _options.smoothing * (error - _error);
+        _stats.last_error = _error;
+        if (std::abs(_error) <= _options.deadband) {
+            if (_stats.converged_ms < 0) {
+                _stats.converged_ms = std::chrono::duration<double, std::milli>(metered_at - _start).count();
+            }
+            return true;
+        }
+        return _apply(_error) || _finish(true);
+    }
+
+    bool ExposureController::failed() const {
+        return _failed;
+    }
+
+    ExposureController::Stats ExposureController::stats() const {
+        auto res = _stats;
+        res.elapsed_seconds = std::chrono::duration<double>((_running ? Clock::now() : _end) - _start).count();
+        return res;
+    }
+
+    double ExposureController::exposure_error(const LumaHistogram &histogram, const Options &options) {
+        auto res = GAMMA * std::log2(options.target / std::max(histogram.mean(), 1.0));
+        //clipped highlights (luma 255) win over a dark mean, e.g. sky over a dark foreground
+        if (histogram.clipped_share() > options.highlight_limit) {
+            res = std::min(res, -2 * options.deadband);
+        }
+        return res;
+    }
+
+    std::optional<std::pair<std::size_t, std::size_t>> ExposureController::pick(const std::vector<std::uint32_t> &tv_values,
+                                                                                const std::vector<std::uint32_t> &iso_values,
+                                                                                std::uint32_t tv,
+                                                                                std::uint32_t iso,
+                                                                                double stops,
+                                                                                const Options &options) {
+        stops = std::clamp(stops, -options.max_change, options.max_change);
+        auto light = [](std::uint32_t tv_value, std::uint32_t iso_value) {
+            return static_cast<std::int32_t>(iso_value) - static_cast<std::int32_t>(tv_value);
+        };
+        auto wanted = light(tv, iso) + static_cast<std::int32_t>(std::lround(stops * CODES_PER_STOP));
+
+        //lists hold a few dozen values, all pairs are cheap next to a frame decode
+        std::optional<std::pair<std::size_t, std::size_t>> res{};
+        std::tuple<std::int32_t, std::uint32_t, std::int32_t> best{};
+        for (std::size_t t = 0; t < tv_values.size(); t++) {
+            if (!usable_tv(tv_values[t], options)) {
+                continue;
+            }
+            for (std::size_t i = 0; i < iso_values.size(); i++) {
+                if (!usable_iso(iso_values[i], options)) {
+                    continue;
+                }
+                std::tuple<std::int32_t, std::uint32_t, std::int32_t> rank{
+                        std::abs(light(tv_values[t], iso_values[i]) - wanted),
+                        iso_values[i],
+                        std::abs(static_cast<std::int32_t>(tv_values[t]) - static_cast<std::int32_t>(tv))};
+                if (!res || rank < best) {
+                    res = {t, i};
+                    best = rank;
+                }
+            }
+        }
+        return res;
+    }
+
+    bool ExposureController::_apply(double stops) {
+        auto tv = _camera.get_property_value(kEdsPropID_Tv);
+        auto iso = _camera.get_property_value(kEdsPropID_ISOSpeed);
+        const auto &tv_values = _camera.get_property_constraints(kEdsPropID_Tv);
+        const auto &iso_values = _camera.get_property_constraints(kEdsPropID_ISOSpeed);
+        auto picked = tv && iso ? pick(tv_values, iso_values, *tv, *iso, stops, _options) : std::nullopt;
+        if (!picked) {
+            return false;
+        }
+
+        auto [tv_index, iso_index] = *picked;
+        auto new_tv = tv_values[tv_index], new_iso = iso_values[iso_index];
+        if (new_tv == *tv && new_iso == *iso) {
+            _stats.at_limit++;
+            return true;
+        }
+        if ((new_tv != *tv && !_camera.set_tv(static_cast<std::uint32_t>(tv_index))) ||
+            (new_iso != *iso && !_camera.set_iso(static_cast<std::uint32_t>(iso_index)))) {
+            return false;
+        }
+
+        //the change is expected to remove its share of the running error, metering corrects the rest
+        _error -= (static_cast<double>(new_iso) - *iso - (static_cast<double>(new_tv) - *tv)) / CODES_PER_STOP;
+        _settle = _options.settle_frames;
+        _stats.changes++;
+        return true;
+    }
+
+    bool ExposureController::_finish(bool failed) {
+        _camera.stop_live_view();
+        _running = false;
+        _failed = failed;
+        _end = Clock::now();
+        return false;
+    }
+} //namespace edsdk_w
@@ -0,0 +1,102 @@
+#ifndef EXPOSURE_CONTROLLER_HPP
+#define EXPOSURE_CONTROLLER_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+#include "edsdk_wrapper.hpp"
+#include "luma_decoder.hpp"
+#include "luma_histogram.hpp"
+
+namespace edsdk_w {
+    //keeps live view brightness at a target by stepping Tv and ISO, for timelapses in changing light
+    //
+    //every step meters one live view frame; the error in stops is smoothed over frames and nothing
+    //changes while it stays inside the deadband, which keeps exposure from flickering between two
+    //neighbouring values. a change goes to the shutter first and to ISO only beyond the slowest
+    //allowed shutter speed, Av is left alone as aperture steps are not repeatable between shots.
+    //camera must be in manual exposure with exposure simulation in live view
+    class ExposureController {
+    public:
+        struct Options {
+            std::uint32_t scale_denominator = 8; //metering needs little resolution
+            double target = 118;                 //mean luma, middle grey after sRGB gamma
+            double highlight_limit = 0.02;       //share of clipped pixels that pulls exposure down
+            double smoothing = 0.3;              //weight of the newest frame in the running error
+            double deadband = 1.0 / 3;           //stops of running error tolerated before a change
+            double max_change = 2;               //stops per change, keeps a wrong meter from jumping far
+            std::uint32_t settle_frames = 3;     //frames not metered after a change, live view lags behind
+            std::uint32_t slowest_tv = 0x60;     //1/30
+            std::uint32_t highest_iso = 0x68;    //ISO 1600
+            std::chrono::milliseconds duration{0};
+        };
+
+        struct Stats {
+            std::uint64_t frames;
+            std::uint64_t metered_frames;
+            std::uint64_t decode_failures;
+            std::uint32_t changes;
+            std::uint32_t at_limit;   //frames wanting a change no allowed value gives
+            double converged_ms;      //since start until the running error entered the deadband, -1 if never
+            double decode_ms;         //totals
+            double histogram_ms;
+            double last_mean;
+            double last_error;        //stops, positive when too dark
+            double elapsed_seconds;
+        };
+
+        ExposureController(EDSDK::Camera &camera, const Options &options);
+
+        ExposureController(const ExposureController &) = delete;
+        ExposureController &operator=(const ExposureController &) = delete;
+
+        //turns live view on
+        bool start();
+
+        //meters one frame and applies a new Tv and ISO when needed, returns false when finished or
+        //failed; must be called from the thread pumping EDSDK::events()
+        bool step();
+
+        [[nodiscard]] bool failed() const;
+
+        [[nodiscard]] Stats stats() const;
+
+        //error in stops from mean and clipped pixels, positive when the frame is too dark
+        static double exposure_error(const LumaHistogram &histogram, const Options &options);
+
+        //indices of Tv and ISO in their constraints whose light is closest to current plus change in stops;
+        //lower ISO wins ties, then the smaller shutter move; empty when no allowed value is offered
+        static std::optional<std::pair<std::size_t, std::size_t>> pick(const std::vector<std::uint32_t> &tv_values,
+                                                                        const std::vector<std::uint32_t> &iso_values,
+                                                                        std::uint32_t tv,
+                                                                        std::uint32_t iso,
+                                                                        double stops,
+                                                                        const Options &options);
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        bool _apply(double stops);
+
+        bool _finish(bool failed);
+
+        EDSDK::Camera &_camera;
+        Options _options;
+        LumaDecoder _decoder;
+        std::vector<std::uint8_t> _frame;
+        std::vector<std::uint8_t> _luma;
+
+        double _error;
+        std::uint32_t _settle;
+        bool _running;
+        bool _failed;
+        Clock::time_point _start;
+        Clock::time_point _end;
+        Stats _stats;
+    };
+} //namespace edsdk_w
+
+#endif //EXPOSURE_CONTROLLER_HPP
@@ -0,0 +1,147 @@
+#include "focus_stacker.hpp"
+
+#include "image_quality.hpp"
+
+namespace edsdk_w {
+    namespace {
+        //camera refuses lens commands while it is busy with a capture
+        constexpr std::chrono::milliseconds LENS_TIMEOUT{2000};
+        constexpr std::chrono::milliseconds DRAIN_TIMEOUT{30000};
+
+        double ms_between(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to) {
+            return std::chrono::duration<double, std::milli>(to - from).count();
+        }
+    }
+
+    double FocusStacker::Stats::frames_per_minute() const {
+        return elapsed_seconds > 0 ? frames * 60.0 / elapsed_seconds : 0;
+    }
+
+    FocusStacker::FocusStacker(EDSDK::Camera &camera, const Options &options) :
+            _camera{camera},
+            _options{options},
+            _wait_for_transfers{false},
+            _state{State::Done},
+            _moves_left{0},
+            _files_per_frame{1},
+            _pending_transfers{0},
+            _files_received{0},
+            _next_transfer{0} {}
+
+    bool FocusStacker::start() {
+        if (_options.frames == 0 || !_camera.start_live_view()) {
+            _state = State::Failed;
+            return false;
+        }
+
+        //captures kept on card are never transferred
+        _wait_for_transfers = !_camera.get_download_directory().empty();
+        _files_per_frame = files_per_shot(_camera.get<Prop::ImageQuality>());
+        _moves_left = 0;
+        _pending_transfers = 0;
+        _files_received = 0;
+        _next_transfer = 0;
+        _timings.assign(1, {0, 0, 0, -1});
+        _captured_at.clear();
+        _start = _lens_stopped = _end = Clock::now();
+        _state = State::Capture;
+        return true;
+    }
+
+    bool FocusStacker::step() {
+        auto now = Clock::now();
+
+        switch (_state) {
+            case State::Capture: {
+                if (now < _lens_stopped + _options.settle ||
+                    (_wait_for_transfers &&
+                     _pending_transfers >= _options.max_pending_transfers * _files_per_frame)) {
+                    return true;
+                }
+
+                bool res = _camera.shutter_button();
+                auto captured = Clock::now();
+                _timings.back().wait_ms = ms_between(_lens_stopped, now);
+                _timings.back().capture_ms = ms_between(now, captured);
+                if (!res) {
+                    _state = State::Failed;
+                    _end = captured;
+                    return false;
+                }
+
+                _captured_at.push_back(now);
+                if (_wait_for_transfers) {
+                    _pending_transfers += _files_per_frame;
+                }
+                if (_timings.size() == _options.frames) {
+                    _state = State::Draining;
+                    return true;
+                }
+
+                //camera is writing the frame, lens moves meanwhile
+                _timings.push_back({0, 0, 0, -1});
+                _moves_left = _options.steps_per_frame;
+                _move_start = captured;
+                _state = State::Moving;
+                [[fallthrough]];
+            }
+            case State::Moving:
+                while (_moves_left > 0) {
+                    if (!_camera.drive_lens_evf(_options.step)) {
+                        if (Clock::now() - _move_start >= LENS_TIMEOUT) {
+                            _state = State::Failed;
+                            _end = Clock::now();
+                            return false;
+                        }
+                        return true;
+                    }
+                    _moves_left--;
+                }
+                _lens_stopped = Clock::now();
+                _timings.back().lens_ms = ms_between(_move_start, _lens_stopped);
+                _state = State::Capture;
+                return true;
+            case State::Draining:
+                if (_pending_transfers == 0 || now - _captured_at.back() >= DRAIN_TIMEOUT) {
+                    _state = _pending_transfers == 0 ? State::Done : State::Failed;
+                    _end = now;
+                    return false;
+                }
+                return true;
+            case State::Done:
+            case State::Failed:
+                break;
+        }
+        return false;
+    }
+
+    void FocusStacker::on_downloaded() {
+        if (_pending_transfers == 0) {
+            return;
+        }
+        _pending_transfers--;
+
+        //camera transfers frames in capture order, a RAW+JPEG frame is down with its last file
+        if (++_files_received % _files_per_frame != 0) {
+            return;
+        }
+        if (_next_transfer < _captured_at.size()) {
+            _timings[_next_transfer].transfer_ms = ms_between(_captured_at[_next_transfer], Clock::now());
+        }
+        _next_transfer++;
+    }
+
+    bool FocusStacker::failed() const {
+        return _state == State::Failed;
+    }
+
+    FocusStacker::Stats FocusStacker::stats() const {
+        bool finished = _state == State::Done || _state == State::Failed;
+        return {static_cast<std::uint32_t>(_captured_at.size()),
+                std::chrono::duration<double>((finished ? _end : Clock::now()) - _start).count()};
+    }
+
+    const std::vector<FocusStacker::FrameTiming> &FocusStacker::timings() const {
+        return _timings;
+    }
+} //namespace edsdk_w
@@ -0,0 +1,90 @@
+#ifndef FOCUS_STACKER_HPP
+#define FOCUS_STACKER_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+#include "edsdk_wrapper.hpp"
+
+namespace edsdk_w {
+    //captures a focus bracket, moving lens through live view between frames
+    //
+    //lens is moved for the next frame right after the shutter command, so lens travel and settling
+    //overlap transfer of the previous frame; next shot waits for settle time and for the number of
+    //outstanding transfers to drop under the limit
+    class FocusStacker {
+    public:
+        struct Options {
+            std::uint32_t frames = 10;
+            EdsEvfDriveLens step = kEdsEvfDriveLens_Near1;
+            std::uint32_t steps_per_frame = 1;
+            std::chrono::milliseconds settle{150};
+            std::uint32_t max_pending_transfers = 2; //frames, RAW+JPEG counts both files of a frame as one
+        };
+
+        struct FrameTiming {
+            double lens_ms;     //lens commands before the frame, busy retries included
+            double wait_ms;     //from lens stop to shutter, settling and waiting for transfers
+            double capture_ms;  //shutter command
+            double transfer_ms; //from shutter to last downloaded file of the frame, negative if not downloaded
+        };
+
+        struct Stats {
+            std::uint32_t frames;
+            double elapsed_seconds;
+            [[nodiscard]] double frames_per_minute() const;
+        };
+
+        FocusStacker(EDSDK::Camera &camera, const Options &options);
+
+        FocusStacker(const FocusStacker &) = delete;
+        FocusStacker &operator=(const FocusStacker &) = delete;
+
+        //turns live view on, lens stays where it is for the first frame
+        bool start();
+
+        //advances the sequence without blocking, returns false when finished or failed;
+        //must be called from the thread pumping EDSDK::events()
+        bool step();
+
+        //to be called from camera download listener
+        void on_downloaded();
+
+        [[nodiscard]] bool failed() const;
+
+        [[nodiscard]] Stats stats() const;
+
+        [[nodiscard]] const std::vector<FrameTiming> &timings() const;
+
+    private:
+        enum class State {
+            Capture,
+            Moving,
+            Draining,
+            Done,
+            Failed
+        };
+
+        using Clock = std::chrono::steady_clock;
+
+        EDSDK::Camera &_camera;
+        Options _options;
+        bool _wait_for_transfers;
+
+        State _state;
+        std::uint32_t _moves_left;
+        std::uint32_t _files_per_frame;
+        std::uint32_t _pending_transfers; //files, not frames
+        std::uint32_t _files_received;
+        std::size_t _next_transfer;
+        Clock::time_point _start;
+        Clock::time_point _end;
+        Clock::time_point _move_start;
+        Clock::time_point _lens_stopped;
+
+        std::vector<FrameTiming> _timings;
+        std::vector<Clock::time_point> _captured_at;
+    };
+} //namespace edsdk_w
+
+#endif //FOCUS_STACKER_HPP
@@ -0,0 +1,264 @@
+#include "frame_ring.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <type_traits>
+#include <unistd.h>
+
+namespace edsdk_w::frame_ring {
+    namespace {
+        constexpr std::uint32_t RING_MAGIC = 0x46524E47; //"FRNG"
+        constexpr std::uint32_t RING_VERSION = 1;
+        constexpr int ACQUIRE_ATTEMPTS = 4;
+
+        std::size_t slot_stride(std::uint32_t slot_capacity) {
+            return sizeof(SlotHeader) + (slot_capacity + 63) / 64 * 64;
+        }
+
+        std::size_t ring_size(std::uint32_t slot_count, std::uint32_t slot_capacity) {
+            return sizeof(RingHeader) + slot_count * slot_stride(slot_capacity);
+        }
+
+        template <typename Memory>
+        auto slot_at(Memory *memory, std::uint64_t frame) {
+            auto header = reinterpret_cast<const RingHeader *>(memory);
+            auto offset = sizeof(RingHeader) + (frame % header->slot_count) * slot_stride(header->slot_capacity);
+            using Slot = std::conditional_t<std::is_const_v<Memory>, const SlotHeader, SlotHeader>;
+            return reinterpret_cast<Slot *>(memory + offset);
+        }
+
+        template <typename Slot>
+        auto slot_data(Slot *slot) {
+            using Byte = std::conditional_t<std::is_const_v<Slot>, const std::uint8_t, std::uint8_t>;
+            return reinterpret_cast<Byte *>(slot) + sizeof(SlotHeader);
+        }
+    }
+
+    Writer::~Writer() {
+        close();
+    }
+
+    bool Writer::create(const std::string &name, std::uint32_t slot_count, std::uint32_t slot_capacity) {
+        close();
+        if (slot_count < 2 || slot_capacity == 0) {
+            return false;
+        }
+
+        int fd = shm_open(name.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0644);
+        if (fd < 0) {
+            return false;
+        }
+
+        auto size = ring_size(slot_count, slot_capacity);
+        void *memory = MAP_FAILED;
+        if (ftruncate(fd, static_cast<off_t>(size)) == 0) {
+            memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        ::close(fd);
+
+        if (memory == MAP_FAILED) {
+            shm_unlink(name.c_str());
+            return false;
+        }
+
+        _name = name;
+        _memory = static_cast<std::uint8_t *>(memory);
+        _memory_size = size;
+        _next_frame = 1;
+
+        //header is published last, readers reject the ring until magic is set
+        auto header = reinterpret_cast<RingHeader *>(_memory);
+        header->version = RING_VERSION;
+        header->slot_count = slot_count;
+        header->slot_capacity = slot_capacity;
+        header->latest_frame.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        header->magic = RING_MAGIC;
+
+        return true;
+    }
+
+    void Writer::close() {
+        if (_memory) {
+            munmap(_memory, _memory_size);
+            shm_unlink(_name.c_str());
+            _memory = nullptr;
+            _memory_size = 0;
+            _current = nullptr;
+        }
+    }
+
+    std::uint8_t *Writer::begin_frame() {
+        if (!_memory || _current) {
+            return nullptr;
+        }
+
+        _current = slot_at(_memory, _next_frame);
+        auto sequence = _current->sequence.load(std::memory_order_relaxed);
+        _current->sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        return slot_data(_current);
+    }
+
+    void Writer::commit_frame(std::size_t size) {
+        if (!_current) {
+            return;
+        }
+
+        _current->frame = _next_frame;
+        _current->size = size;
+        _current->timestamp_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        _current->sequence.fetch_add(1, std::memory_order_release);
+
+        reinterpret_cast<RingHeader *>(_memory)->latest_frame.store(_next_frame, std::memory_order_release);
+        _next_frame++;
+        _current = nullptr;
+    }
+
+    void Writer::abort_frame() {
+        if (!_current) {
+            return;
+        }
+
+        //readers locate slots by latest_frame, a zero frame number is never matched
+        _current->frame = 0;
+        _current->sequence.fetch_add(1, std::memory_order_release);
+        _current = nullptr;
+    }
+
+    bool Writer::publish(const std::uint8_t *data, std::size_t size) {
+        if (size > slot_capacity()) {
+            return false;
+        }
+
+        auto slot = begin_frame();
+        if (!slot) {
+            return false;
+        }
+        std::memcpy(slot, data, size);
+        commit_frame(size);
+
+        return true;
+    }
+
+    std::size_t Writer::slot_capacity() const {
+        return _memory ? reinterpret_cast<const RingHeader *>(_memory)->slot_capacity : 0;
+    }
+
+    Reader::~Reader() {
+        close();
+    }
+
+    bool Reader::open(const std::string &name) {
+        close();
+
+        int fd = shm_open(name.c_str(), O_RDONLY, 0);
+        if (fd < 0) {
+            return false;
+        }
+
+        struct stat st{};
+        void *memory = MAP_FAILED;
+        if (fstat(fd, &st) == 0 && static_cast<std::size_t>(st.st_size) >= sizeof(RingHeader)) {
+            memory = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        }
+        ::close(fd);
+
+        if (memory == MAP_FAILED) {
+            return false;
+        }
+
+        _memory = static_cast<const std::uint8_t *>(memory);
+        _memory_size = st.st_size;
+
+        auto header = reinterpret_cast<const RingHeader *>(_memory);
+        bool valid = header->magic == RING_MAGIC &&
+                     header->version == RING_VERSION &&
+                     header->slot_count >= 2 &&
+                     ring_size(header->slot_count, header->slot_capacity) <= _memory_size;
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        if (!valid) {
+            close();
+        }
+        return valid;
+    }
+
+    void Reader::close() {
+        if (_memory) {
+            munmap(const_cast<std::uint8_t *>(_memory), _memory_size);
+            _memory = nullptr;
+            _memory_size = 0;
+        }
+    }
+
+    bool Reader::acquire_latest(FrameView &view, std::uint64_t newer_than) const {
+        if (!_memory) {
+            return false;
+        }
+
+        for (int attempt = 0; attempt < ACQUIRE_ATTEMPTS; attempt++) {
+            auto latest = latest_frame();
+            if (latest == 0 || latest <= newer_than) {
+                return false;
+            }
+
+            auto slot = _slot(latest);
+            auto sequence = slot->sequence.load(std::memory_order_acquire);
+            if (sequence & 1) {
+                continue;
+            }
+
+            FrameView res{slot_data(slot), slot->size, slot->frame, slot->timestamp_ns, sequence};
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot->sequence.load(std::memory_order_relaxed) != sequence || res.frame != latest) {
+                continue;
+            }
+
+            auto capacity = reinterpret_cast<const RingHeader *>(_memory)->slot_capacity;
+            if (res.size > capacity) {
+                return false;
+            }
+
+            view = res;
+            return true;
+        }
+
+        return false;
+    }
+
+    bool Reader::is_valid(const FrameView &view) const {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return _slot(view.frame)->sequence.load(std::memory_order_relaxed) == view.sequence;
+    }
+
+    bool Reader::copy_latest(std::vector<std::uint8_t> &frame, std::uint64_t &frame_number, std::uint64_t newer_than) const {
+        FrameView view{};
+        for (int attempt = 0; attempt < ACQUIRE_ATTEMPTS; attempt++) {
+            if (!acquire_latest(view, newer_than)) {
+                return false;
+            }
+
+            frame.assign(view.data, view.data + view.size);
+            if (is_valid(view)) {
+                frame_number = view.frame;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    std::uint64_t Reader::latest_frame() const {
+        return _memory ? reinterpret_cast<const RingHeader *>(_memory)->latest_frame.load(std::memory_order_acquire) : 0;
+    }
+
+    const SlotHeader *Reader::_slot(std::uint64_t frame) const {
+        return slot_at(_memory, frame);
+    }
+} //namespace edsdk_w::frame_ring
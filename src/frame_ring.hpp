@@ -0,0 +1,103 @@
+#ifndef FRAME_RING_HPP
+#define FRAME_RING_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//ring of frame slots in POSIX shared memory, one writer process and any number of readers,
+//each slot is guarded by a sequence counter, so readers never lock and never copy
+namespace edsdk_w::frame_ring {
+    struct RingHeader {
+        std::uint32_t magic;
+        std::uint32_t version;
+        std::uint32_t slot_count;
+        std::uint32_t slot_capacity;
+        std::atomic<std::uint64_t> latest_frame; //0 until first frame is published
+        std::uint8_t reserved[40];
+    };
+
+    struct SlotHeader {
+        std::atomic<std::uint64_t> sequence; //odd while slot is being written
+        std::uint64_t frame;
+        std::uint64_t size;
+        std::int64_t timestamp_ns;          //steady clock of the writer
+        std::uint8_t reserved[32];
+    };
+
+    static_assert(sizeof(RingHeader) == 64 && sizeof(SlotHeader) == 64, "headers must keep slots cache line aligned");
+
+    struct FrameView {
+        const std::uint8_t *data;
+        std::size_t size;
+        std::uint64_t frame;
+        std::int64_t timestamp_ns;
+        std::uint64_t sequence;
+    };
+
+    class Writer {
+    public:
+        Writer() = default;
+        ~Writer();
+
+        Writer(const Writer &) = delete;
+        Writer &operator=(const Writer &) = delete;
+
+        bool create(const std::string &name, std::uint32_t slot_count, std::uint32_t slot_capacity);
+
+        //removes shared memory object, mapped readers keep working until they close
+        void close();
+
+        //returns slot memory to write frame into directly, commit() or abort() must follow
+        std::uint8_t *begin_frame();
+        void commit_frame(std::size_t size);
+        void abort_frame();
+
+        //copying variant for frames which are not produced in place
+        bool publish(const std::uint8_t *data, std::size_t size);
+
+        [[nodiscard]] std::size_t slot_capacity() const;
+        [[nodiscard]] std::uint64_t frames_published() const { return _next_frame - 1; }
+
+    private:
+        std::string _name;
+        std::uint8_t *_memory = nullptr;
+        std::size_t _memory_size = 0;
+        SlotHeader *_current = nullptr;
+        std::uint64_t _next_frame = 1;
+    };
+
+    class Reader {
+    public:
+        Reader() = default;
+        ~Reader();
+
+        Reader(const Reader &) = delete;
+        Reader &operator=(const Reader &) = delete;
+
+        bool open(const std::string &name);
+        void close();
+
+        //points view to the newest complete frame with number greater than newer_than,
+        //view data stays in shared memory, so it must be checked with is_valid() after being consumed
+        bool acquire_latest(FrameView &view, std::uint64_t newer_than = 0) const;
+
+        //false if writer has started overwriting the slot since the view was acquired
+        [[nodiscard]] bool is_valid(const FrameView &view) const;
+
+        //acquires and copies, retrying when writer overtakes the reader
+        bool copy_latest(std::vector<std::uint8_t> &frame, std::uint64_t &frame_number, std::uint64_t newer_than = 0) const;
+
+        [[nodiscard]] std::uint64_t latest_frame() const;
+
+    private:
+        const SlotHeader *_slot(std::uint64_t frame) const;
+
+        const std::uint8_t *_memory = nullptr;
+        std::size_t _memory_size = 0;
+    };
+} //namespace edsdk_w::frame_ring
+
+#endif //FRAME_RING_HPP
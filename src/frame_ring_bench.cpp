@@ -0,0 +1,119 @@
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include "frame_ring.hpp"
+
+//fan-out benchmark of the live view frame ring, readers are separate processes:
+//frame_ring_bench [readers] [seconds] [frame_size] [fps, 0 = unthrottled]
+namespace {
+    using clock = std::chrono::steady_clock;
+
+    const char *RING_NAME = "/frame_ring_bench";
+
+    int run_reader(int index, int seconds) {
+        edsdk_w::frame_ring::Reader reader{};
+        if (!reader.open(RING_NAME)) {
+            std::cerr << "reader " << index << ": failed to open ring" << std::endl;
+            return 1;
+        }
+
+        std::uint64_t last_frame = 0, frames = 0, skipped = 0, torn = 0, checksum = 0;
+        double latency_us = 0;
+        auto deadline = clock::now() + std::chrono::seconds{seconds};
+
+        while (clock::now() < deadline) {
+            edsdk_w::frame_ring::FrameView view{};
+            if (!reader.acquire_latest(view, last_frame)) {
+                std::this_thread::yield();
+                continue;
+            }
+
+            //consuming frame in place, one byte per cache line
+            for (std::size_t i = 0; i < view.size; i += 64) {
+                checksum += view.data[i];
+            }
+            if (!reader.is_valid(view)) {
+                torn++;
+                continue;
+            }
+
+            auto now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now().time_since_epoch()).count();
+            latency_us += static_cast<double>(now_ns - view.timestamp_ns) / 1000.0;
+            if (last_frame && view.frame > last_frame + 1) {
+                skipped += view.frame - last_frame - 1;
+            }
+            last_frame = view.frame;
+            frames++;
+        }
+
+        std::cout << std::fixed << std::setprecision(1)
+                  << "reader " << index << ": frames " << frames
+                  << ", skipped " << skipped
+                  << ", torn " << torn
+                  << ", avg publish-to-consume latency " << (frames ? latency_us / frames : 0.0) << " us"
+                  << " (checksum " << checksum % 256 << ")" << std::endl;
+        return 0;
+    }
+}
+
+int main(int argc, char **argv) {
+    int readers = argc > 1 ? std::stoi(argv[1]) : 4;
+    int seconds = argc > 2 ? std::stoi(argv[2]) : 5;
+    std::uint32_t frame_size = argc > 3 ? std::stoul(argv[3]) : 300 * 1024;
+    int fps = argc > 4 ? std::stoi(argv[4]) : 30;
+
+    edsdk_w::frame_ring::Writer writer{};
+    if (!writer.create(RING_NAME, 8, frame_size)) {
+        std::cerr << "failed to create ring" << std::endl;
+        return 1;
+    }
+
+    std::vector<pid_t> children{};
+    for (int i = 0; i < readers; i++) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            _exit(run_reader(i, seconds));
+        }
+        children.push_back(pid);
+    }
+
+    auto start = clock::now();
+    auto deadline = start + std::chrono::seconds{seconds};
+    auto frame_interval = fps > 0 ? std::chrono::nanoseconds{1000000000 / fps} : std::chrono::nanoseconds{0};
+    auto next_frame = start;
+    double write_ns = 0;
+
+    while (clock::now() < deadline) {
+        auto write_start = clock::now();
+        auto slot = writer.begin_frame();
+        std::memset(slot, static_cast<int>(writer.frames_published() & 0xff), frame_size);
+        writer.commit_frame(frame_size);
+        write_ns += std::chrono::duration<double, std::nano>(clock::now() - write_start).count();
+
+        if (fps > 0) {
+            next_frame += frame_interval;
+            std::this_thread::sleep_until(next_frame);
+        }
+    }
+    double elapsed = std::chrono::duration<double>(clock::now() - start).count();
+    auto frames = writer.frames_published();
+
+    for (auto pid : children) {
+        waitpid(pid, nullptr, 0);
+    }
+
+    std::cout << std::fixed << std::setprecision(1)
+              << "writer: frames " << frames
+              << ", " << static_cast<double>(frames) / elapsed << " fps"
+              << ", " << static_cast<double>(frames) * frame_size / elapsed / (1024 * 1024) << " MB/s written once"
+              << ", avg write " << write_ns / static_cast<double>(frames) / 1000.0 << " us"
+              << ", readers " << readers << std::endl;
+
+    return 0;
+}
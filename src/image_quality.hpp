@@ -0,0 +1,14 @@
+#ifndef IMAGE_QUALITY_HPP
+#define IMAGE_QUALITY_HPP
+
+#include <cstdint>
+
+namespace edsdk_w {
+    //files a shot produces for a kEdsPropID_ImageQuality value, two for RAW+JPEG and RAW+HEIF;
+    //the secondary image size byte is 0xff when the shot holds a single image
+    inline std::uint32_t files_per_shot(std::uint32_t image_quality) {
+        return image_quality != 0xffffffff && ((image_quality >> 8) & 0xff) != 0xff ? 2 : 1;
+    }
+} //namespace edsdk_w
+
+#endif //IMAGE_QUALITY_HPP
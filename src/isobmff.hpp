@@ -0,0 +1,58 @@
+#ifndef ISOBMFF_HPP
+#define ISOBMFF_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace edsdk_w::isobmff {
+    struct Box {
+        char type[4];
+        //offsets relative to start of the file
+        std::size_t offset;
+        std::size_t payload;
+        std::size_t end;
+
+        [[nodiscard]] bool is(const char *fourcc) const {
+            return std::memcmp(type, fourcc, 4) == 0;
+        }
+    };
+
+    inline std::uint32_t read_be32(const std::uint8_t *p) {
+        return static_cast<std::uint32_t>(p[0]) << 24 | static_cast<std::uint32_t>(p[1]) << 16 |
+               static_cast<std::uint32_t>(p[2]) << 8 | p[3];
+    }
+
+    //calls visitor for each box in [begin, end) until it returns false, malformed sizes stop the walk
+    template <typename Visitor>
+    void for_each_box(const std::uint8_t *data, std::size_t begin, std::size_t end, Visitor &&visitor) {
+        std::size_t pos = begin;
+        while (pos + 8 <= end) {
+            std::uint64_t box_size = read_be32(data + pos);
+            std::size_t header = 8;
+            if (box_size == 1 && pos + 16 <= end) {
+                box_size = static_cast<std::uint64_t>(read_be32(data + pos + 8)) << 32 | read_be32(data + pos + 12);
+                header = 16;
+            } else if (box_size == 0) {
+                box_size = end - pos;
+            }
+            if (box_size < header || box_size > end - pos) {
+                return;
+            }
+
+            Box box{{}, pos, pos + header, pos + static_cast<std::size_t>(box_size)};
+            std::memcpy(box.type, data + pos + 4, 4);
+            if (!visitor(box)) {
+                return;
+            }
+            pos = box.end;
+        }
+    }
+
+    //payload of uuid box starts with 16 byte uuid
+    inline bool is_uuid(const std::uint8_t *data, const Box &box, const std::uint8_t (&uuid)[16]) {
+        return box.is("uuid") && box.payload + 16 <= box.end && std::memcmp(data + box.payload, uuid, 16) == 0;
+    }
+} //namespace edsdk_w::isobmff
+
+#endif //ISOBMFF_HPP
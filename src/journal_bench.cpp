@@ -0,0 +1,59 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include "capture_journal.hpp"
+
+//sustained appends to the capture journal, msync included:
+//journal_bench <journal path> [records] [sync every records] [sync interval ms]
+//journal file is removed first, so the run starts from an empty journal
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        std::cerr << "usage: journal_bench <journal path> [records] [sync every records] [sync interval ms]" << std::endl;
+        return 1;
+    }
+    std::string path = argv[1];
+    std::size_t records = argc > 2 ? std::stoul(argv[2]) : 200000;
+    std::size_t sync_every = argc > 3 ? std::stoul(argv[3]) : 64;
+    std::chrono::milliseconds sync_interval{argc > 4 ? std::stoll(argv[4]) : 1000};
+
+    std::filesystem::remove(path);
+    edsdk_w::CaptureJournal journal{sync_every, sync_interval};
+    if (!journal.open(path)) {
+        std::cerr << "cannot open " << path << std::endl;
+        return 1;
+    }
+
+    //trigger and download pairs, as a burst writes them
+    edsdk_w::CaptureJournal::Record record{};
+    std::strncpy(record.body_id, "bench", sizeof(record.body_id) - 1);
+    record.image_quality = 0x0013ff0f;
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < records; i++) {
+        record.type = i % 2 ? edsdk_w::CaptureJournal::RecordType::Downloaded
+                            : edsdk_w::CaptureJournal::RecordType::Triggered;
+        record.file_size = i;
+        if (!journal.append(record)) {
+            std::cerr << "append failed at record " << i << std::endl;
+            return 1;
+        }
+    }
+    journal.sync();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    journal.close();
+
+    auto stats = journal.stats();
+    auto appends = static_cast<double>(std::max<std::uint64_t>(stats.appends, 1));
+    auto syncs = static_cast<double>(std::max<std::uint64_t>(stats.syncs, 1));
+    std::cout << std::fixed << std::setprecision(1) << records << " appends in " << seconds * 1000 << " ms: "
+              << static_cast<double>(records) / seconds << " appends/s sustained, append mean "
+              << static_cast<double>(stats.append_ns) / appends / 1000 << " us, max "
+              << static_cast<double>(stats.max_append_ns) / 1000 << " us, " << stats.syncs << " msyncs of mean "
+              << static_cast<double>(stats.sync_ns) / syncs / 1000 << " us" << std::endl;
+
+    std::filesystem::remove(path);
+    return 0;
+}
@@ -0,0 +1,61 @@
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include "capture_latency.hpp"
+#include "image_quality.hpp"
+
+//bookkeeping cost of capture latency tracking on the event thread:
+//latency_bench [captures]
+//RAW+JPEG captures go through every stage, a failed download is checked first
+namespace {
+    using edsdk_w::CaptureLatency;
+
+    //RAW + large fine JPEG
+    constexpr std::uint32_t RAW_JPEG = 0x00640013;
+
+    void capture(CaptureLatency &latency, std::uint32_t image_quality, bool fail_download) {
+        auto id = latency.begin("bench", image_quality);
+        latency.mark(id, CaptureLatency::Stage::Returned);
+        for (std::uint32_t file = 0; file < edsdk_w::files_per_shot(image_quality); file++) {
+            latency.mark_next(CaptureLatency::Stage::ObjectEvent);
+            latency.mark_next(CaptureLatency::Stage::TransferStart);
+            auto owner = latency.mark_next(CaptureLatency::Stage::TransferEnd);
+            latency.finish_file(owner, CaptureLatency::Stage::TransferEnd, fail_download && file == 0);
+        }
+    }
+
+    //a capture with a failed file is a failure and stays out of the percentiles
+    bool counts_failed_download() {
+        CaptureLatency latency{};
+        capture(latency, RAW_JPEG, true);
+        auto groups = latency.groups();
+        return groups.size() == 1 && groups[0].captures == 1 && groups[0].failures == 1 &&
+               groups[0].to_file.count == 0 && latency.recent().back().failed && latency.open_captures() == 0;
+    }
+}
+
+int main(int argc, char **argv) {
+    if (!counts_failed_download()) {
+        std::cerr << "failed download is not counted as a failure" << std::endl;
+        return 1;
+    }
+
+    std::size_t captures = argc > 1 ? std::stoul(argv[1]) : 200000;
+    CaptureLatency latency{};
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < captures; i++) {
+        capture(latency, RAW_JPEG, false);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    auto groups = latency.groups();
+    if (groups.size() != 1 || groups[0].failures != 0 || latency.open_captures() != 0) {
+        std::cerr << "captures were not attributed to their files" << std::endl;
+        return 1;
+    }
+    std::cout << std::fixed << std::setprecision(2) << captures << " RAW+JPEG captures: "
+              << seconds * 1e9 / static_cast<double>(captures) << " ns per capture, to file p50 "
+              << groups[0].to_file.p50_us << " us" << std::endl;
+    return 0;
+}
@@ -0,0 +1,45 @@
+#include "live_view_publisher.hpp"
+
+namespace edsdk_w {
+    LiveViewPublisher::LiveViewPublisher(std::chrono::milliseconds frame_interval) :
+            _frame_interval{frame_interval},
+            _live_view_generation{0},
+            _stats{} {}
+
+    bool LiveViewPublisher::open(const std::string &shm_name, std::uint32_t slot_count, std::uint32_t slot_capacity) {
+        return _ring.create(shm_name, slot_count, slot_capacity);
+    }
+
+    bool LiveViewPublisher::publish(EDSDK::Camera &camera) {
+        auto now = std::chrono::steady_clock::now();
+        if (now - _last_frame < _frame_interval) {
+            return false;
+        }
+
+        //a reconnected camera may be allocated at the address of the dropped one
+        auto generation = EDSDK::get_instance().camera_generation();
+        if (_live_view_generation != generation) {
+            if (!camera.start_live_view()) {
+                return false;
+            }
+            _live_view_generation = generation;
+        }
+
+        auto slot = _ring.begin_frame();
+        if (!slot) {
+            return false;
+        }
+
+        std::size_t size = 0;
+        if (!camera.download_live_view_frame(slot, _ring.slot_capacity(), size)) {
+            _ring.abort_frame();
+            _stats.not_ready++;
+            return false;
+        }
+        _ring.commit_frame(size);
+
+        _last_frame = now;
+        _stats.published++;
+        return true;
+    }
+} //namespace edsdk_w
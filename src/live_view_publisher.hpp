@@ -0,0 +1,40 @@
+#ifndef LIVE_VIEW_PUBLISHER_HPP
+#define LIVE_VIEW_PUBLISHER_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include "edsdk_wrapper.hpp"
+#include "frame_ring.hpp"
+
+namespace edsdk_w {
+    //downloads live view frames straight into shared memory ring slots
+    class LiveViewPublisher {
+    public:
+        struct Stats {
+            std::uint64_t published;
+            std::uint64_t not_ready;
+        };
+
+        explicit LiveViewPublisher(std::chrono::milliseconds frame_interval = std::chrono::milliseconds{33});
+
+        bool open(const std::string &shm_name,
+                  std::uint32_t slot_count = 8,
+                  std::uint32_t slot_capacity = LIVE_VIEW_FRAME_CAPACITY);
+
+        //publishes one frame if frame interval has passed since the previous one,
+        //live view is started on the first call for a camera
+        bool publish(EDSDK::Camera &camera);
+
+        [[nodiscard]] Stats stats() const { return _stats; }
+
+    private:
+        frame_ring::Writer _ring;
+        std::chrono::milliseconds _frame_interval;
+        std::chrono::steady_clock::time_point _last_frame;
+        std::uint64_t _live_view_generation; //camera generation live view was started for, 0 before
+        Stats _stats;
+    };
+} //namespace edsdk_w
+
+#endif //LIVE_VIEW_PUBLISHER_HPP
@@ -0,0 +1,351 @@
+#include "live_view_recorder.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <filesystem>
+
+namespace edsdk_w {
+    namespace {
+        //RIFF 'AVI ' with hdrl list (avih, strl with strh and strf) up to the movi list type
+        constexpr std::size_t HEADER_SIZE = 224;
+        constexpr std::size_t MOVI_TYPE_OFFSET = 220;
+        constexpr std::uint32_t AVIF_HASINDEX = 0x10;
+        constexpr std::uint32_t AVIIF_KEYFRAME = 0x10;
+
+        struct SegmentInfo {
+            std::uint32_t frames;
+            std::uint32_t width;
+            std::uint32_t height;
+            std::uint32_t us_per_frame;
+            std::uint32_t max_frame_size;
+            std::uint64_t movi_end;  //file offset after last frame chunk
+            std::uint64_t file_size;
+        };
+
+        void put_le16(std::uint8_t *at, std::uint16_t value) {
+            at[0] = value & 0xff;
+            at[1] = value >> 8;
+        }
+
+        void put_le32(std::uint8_t *at, std::uint32_t value) {
+            for (int i = 0; i < 4; i++) {
+                at[i] = (value >> (8 * i)) & 0xff;
+            }
+        }
+
+        void put_fourcc(std::uint8_t *at, const char *fourcc) {
+            for (int i = 0; i < 4; i++) {
+                at[i] = static_cast<std::uint8_t>(fourcc[i]);
+            }
+        }
+
+        std::array<std::uint8_t, HEADER_SIZE> avi_header(const SegmentInfo &info) {
+            std::array<std::uint8_t, HEADER_SIZE> res{};
+            auto p = res.data();
+
+            put_fourcc(p, "RIFF");
+            put_le32(p + 4, static_cast<std::uint32_t>(info.file_size - 8));
+            put_fourcc(p + 8, "AVI ");
+
+            put_fourcc(p + 12, "LIST");
+            put_le32(p + 16, 192);
+            put_fourcc(p + 20, "hdrl");
+
+            put_fourcc(p + 24, "avih");
+            put_le32(p + 28, 56);
+            auto avih = p + 32;
+            put_le32(avih, info.us_per_frame);
+            put_le32(avih + 12, AVIF_HASINDEX);
+            put_le32(avih + 16, info.frames);
+            put_le32(avih + 24, 1);
+            put_le32(avih + 28, info.max_frame_size);
+            put_le32(avih + 32, info.width);
+            put_le32(avih + 36, info.height);
+
+            put_fourcc(p + 88, "LIST");
+            put_le32(p + 92, 116);
+            put_fourcc(p + 96, "strl");
+
+            put_fourcc(p + 100, "strh");
+            put_le32(p + 104, 56);
+            auto strh = p + 108;
+            put_fourcc(strh, "vids");
+            put_fourcc(strh + 4, "MJPG");
+            put_le32(strh + 20, info.us_per_frame);
+            put_le32(strh + 24, 1000000);
+            put_le32(strh + 32, info.frames);
+            put_le32(strh + 36, info.max_frame_size);
+            put_le32(strh + 40, 0xffffffff);
+            put_le16(strh + 52, static_cast<std::uint16_t>(info.width));
+            put_le16(strh + 54, static_cast<std::uint16_t>(info.height));
+
+            put_fourcc(p + 164, "strf");
+            put_le32(p + 168, 40);
+            auto strf = p + 172;
+            put_le32(strf, 40);
+            put_le32(strf + 4, info.width);
+            put_le32(strf + 8, info.height);
+            put_le16(strf + 12, 1);
+            put_le16(strf + 14, 24);
+            put_fourcc(strf + 16, "MJPG");
+            put_le32(strf + 20, info.width * info.height * 3);
+
+            put_fourcc(p + 212, "LIST");
+            put_le32(p + 216, static_cast<std::uint32_t>(info.movi_end - MOVI_TYPE_OFFSET));
+            put_fourcc(p + 220, "movi");
+            return res;
+        }
+
+        //frame size from the first SOF marker
+        bool jpeg_dimensions(const std::uint8_t *data, std::size_t size, std::uint32_t &width, std::uint32_t &height) {
+            std::size_t pos = 2;
+            while (pos + 4 <= size && data[pos] == 0xff) {
+                auto marker = data[pos + 1];
+                std::size_t length = (data[pos + 2] << 8) | data[pos + 3];
+                bool sof = marker >= 0xc0 && marker <= 0xcf && marker != 0xc4 && marker != 0xc8 && marker != 0xcc;
+                if (sof && pos + 9 <= size) {
+                    height = (data[pos + 5] << 8) | data[pos + 6];
+                    width = (data[pos + 7] << 8) | data[pos + 8];
+                    return true;
+                }
+                pos += 2 + length;
+            }
+            return false;
+        }
+    }
+
+    LiveViewRecorder::LiveViewRecorder(const Options &options) :
+            _options{options},
+            _stopping{false},
+            _live_view_generation{0},
+            _segment_bytes{0},
+            _segment_start_ns{0},
+            _last_timestamp_ns{0},
+            _width{0},
+            _height{0},
+            _stats{} {}
+
+    LiveViewRecorder::~LiveViewRecorder() {
+        stop();
+    }
+
+    bool LiveViewRecorder::start(const std::string &directory) {
+        std::error_code ec;
+        std::filesystem::create_directories(directory, ec);
+        if (ec || _writer.joinable()) {
+            return false;
+        }
+
+        _directory = directory;
+        _pool.clear();
+        _free.clear();
+        for (std::uint32_t i = 0; i < _options.pool_frames; i++) {
+            _pool.push_back(std::make_unique<std::vector<std::uint8_t>>(_options.frame_capacity));
+            _free.push_back(_pool.back().get());
+        }
+        _stats = {};
+        _stopping = false;
+        _writer = std::thread{&LiveViewRecorder::_write_loop, this};
+        return true;
+    }
+
+    bool LiveViewRecorder::record(EDSDK::Camera &camera) {
+        auto now = std::chrono::steady_clock::now();
+        if (!_writer.joinable() || now - _last_frame < _options.frame_interval) {
+            return false;
+        }
+
+        //a reconnected camera may be allocated at the address of the dropped one
+        auto generation = EDSDK::get_instance().camera_generation();
+        if (_live_view_generation != generation) {
+            if (!camera.start_live_view()) {
+                return false;
+            }
+            _live_view_generation = generation;
+        }
+
+        std::vector<std::uint8_t> *buffer = nullptr;
+        {
+            std::lock_guard<std::mutex> lock{_mutex};
+            if (_free.empty()) {
+                _stats.dropped++;
+                return false;
+            }
+            buffer = _free.back();
+            _free.pop_back();
+        }
+
+        std::size_t size = 0;
+        if (!camera.download_live_view_frame(buffer->data(), buffer->size(), size)) {
+            std::lock_guard<std::mutex> lock{_mutex};
+            _free.push_back(buffer);
+            _stats.not_ready++;
+            return false;
+        }
+        auto timestamp_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count();
+
+        {
+            std::lock_guard<std::mutex> lock{_mutex};
+            _queue.push_back({buffer, size, timestamp_ns});
+            _stats.max_queued = std::max(_stats.max_queued, static_cast<std::uint32_t>(_queue.size()));
+        }
+        _queued.notify_one();
+        _last_frame = now;
+        return true;
+    }
+
+    void LiveViewRecorder::stop() {
+        if (!_writer.joinable()) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock{_mutex};
+            _stopping = true;
+        }
+        _queued.notify_one();
+        _writer.join();
+    }
+
+    LiveViewRecorder::Stats LiveViewRecorder::stats() const {
+        std::lock_guard<std::mutex> lock{_mutex};
+        return _stats;
+    }
+
+    void LiveViewRecorder::_write_loop() {
+        //after a failed write frames are only returned to the pool
+        bool failed = false;
+        while (true) {
+            Frame frame{};
+            {
+                std::unique_lock<std::mutex> lock{_mutex};
+                _queued.wait(lock, [this] { return _stopping || !_queue.empty(); });
+                if (_queue.empty()) {
+                    break;
+                }
+                frame = _queue.front();
+                _queue.pop_front();
+            }
+
+            failed = failed || !_write_frame(frame);
+
+            std::lock_guard<std::mutex> lock{_mutex};
+            _free.push_back(frame.buffer);
+            if (failed) {
+                _stats.write_failed = true;
+            } else {
+                _stats.frames++;
+                _stats.bytes += frame.size;
+            }
+        }
+        _close_segment();
+    }
+
+    bool LiveViewRecorder::_open_segment() {
+        char name[32];
+        std::snprintf(name, sizeof(name), "liveview_%04u.avi", _stats.segments + 1);
+        _segment.open(std::filesystem::path{_directory} / name, std::ios::binary | std::ios::trunc);
+
+        //placeholder, real header is written when segment is closed
+        auto header = avi_header({0, 0, 0, 0, 0, HEADER_SIZE, HEADER_SIZE});
+        _segment.write(reinterpret_cast<const char *>(header.data()), header.size());
+        if (!_segment) {
+            _segment.close();
+            return false;
+        }
+
+        _segment_bytes = HEADER_SIZE;
+        _index.clear();
+        _timestamps.clear();
+        std::lock_guard<std::mutex> lock{_mutex};
+        _stats.segments++;
+        return true;
+    }
+
+    bool LiveViewRecorder::_write_frame(const Frame &frame) {
+        //room for the frame chunk and the index and timestamps written at close
+        auto chunk = 8 + frame.size + (frame.size & 1);
+        auto trailer = (_index.size() + 1) * (16 + 8) + 16;
+        bool full = _segment_bytes + chunk + trailer > _options.segment_bytes;
+        bool expired = _options.segment_duration.count() > 0 &&
+                       frame.timestamp_ns - _segment_start_ns >=
+                       std::chrono::duration_cast<std::chrono::nanoseconds>(_options.segment_duration).count();
+        if (_segment.is_open() && !_index.empty() && (full || expired)) {
+            _close_segment();
+        }
+        if (!_segment.is_open() && !_open_segment()) {
+            return false;
+        }
+
+        if (_index.empty()) {
+            _segment_start_ns = frame.timestamp_ns;
+            jpeg_dimensions(frame.buffer->data(), frame.size, _width, _height);
+        }
+
+        std::uint8_t header[8];
+        put_fourcc(header, "00dc");
+        put_le32(header + 4, static_cast<std::uint32_t>(frame.size));
+        _segment.write(reinterpret_cast<const char *>(header), sizeof(header));
+        _segment.write(reinterpret_cast<const char *>(frame.buffer->data()), static_cast<std::streamsize>(frame.size));
+        if (frame.size & 1) {
+            _segment.put('\0');
+        }
+        if (!_segment) {
+            return false;
+        }
+
+        _index.push_back({static_cast<std::uint32_t>(_segment_bytes - MOVI_TYPE_OFFSET), static_cast<std::uint32_t>(frame.size)});
+        _timestamps.push_back(frame.timestamp_ns - _segment_start_ns);
+        _last_timestamp_ns = frame.timestamp_ns;
+        _segment_bytes += chunk;
+        return true;
+    }
+
+    void LiveViewRecorder::_close_segment() {
+        if (!_segment.is_open()) {
+            return;
+        }
+
+        auto frames = static_cast<std::uint32_t>(_index.size());
+        std::vector<std::uint8_t> trailer(8 + frames * 16 + 8 + frames * 8);
+        auto p = trailer.data();
+        std::uint32_t max_frame_size = 0;
+
+        put_fourcc(p, "idx1");
+        put_le32(p + 4, frames * 16);
+        p += 8;
+        for (const auto &entry : _index) {
+            put_fourcc(p, "00dc");
+            put_le32(p + 4, AVIIF_KEYFRAME);
+            put_le32(p + 8, entry.offset);
+            put_le32(p + 12, entry.size);
+            max_frame_size = std::max(max_frame_size, entry.size);
+            p += 16;
+        }
+
+        //steady clock nanoseconds since first frame of segment, players skip unknown chunks
+        put_fourcc(p, "evts");
+        put_le32(p + 4, frames * 8);
+        p += 8;
+        for (auto timestamp : _timestamps) {
+            put_le32(p, static_cast<std::uint32_t>(timestamp));
+            put_le32(p + 4, static_cast<std::uint32_t>(static_cast<std::uint64_t>(timestamp) >> 32));
+            p += 8;
+        }
+        _segment.write(reinterpret_cast<const char *>(trailer.data()), static_cast<std::streamsize>(trailer.size()));
+
+        //nominal rate is the measured average, exact times are in evts
+        auto us_per_frame = frames > 1
+                            ? static_cast<std::uint32_t>((_last_timestamp_ns - _segment_start_ns) / 1000 / (frames - 1))
+                            : static_cast<std::uint32_t>(std::chrono::microseconds{_options.frame_interval}.count());
+        auto header = avi_header({frames, _width, _height, us_per_frame, max_frame_size,
+                                  _segment_bytes, _segment_bytes + trailer.size()});
+        _segment.seekp(0);
+        _segment.write(reinterpret_cast<const char *>(header.data()), header.size());
+        _segment.close();
+        if (!_segment) {
+            std::lock_guard<std::mutex> lock{_mutex};
+            _stats.write_failed = true;
+        }
+    }
+} //namespace edsdk_w
@@ -0,0 +1,110 @@
+#ifndef LIVE_VIEW_RECORDER_HPP
+#define LIVE_VIEW_RECORDER_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "edsdk_wrapper.hpp"
+
+namespace edsdk_w {
+    //records live view into MJPEG AVI segments, frames are stored as the camera sent them
+    //
+    //frames are downloaded straight into pooled buffers on the pump thread and written by a
+    //background thread, so disk stalls only use up free buffers; a segment gets its idx1 index,
+    //frame timestamps and final headers when it is closed at rollover or stop
+    class LiveViewRecorder {
+    public:
+        struct Options {
+            std::chrono::milliseconds frame_interval{33};
+            std::uint32_t pool_frames = 32;
+            std::size_t frame_capacity = LIVE_VIEW_FRAME_CAPACITY;
+            std::uint64_t segment_bytes = 1024ull * 1024 * 1024; //idx1 offsets are 32-bit
+            std::chrono::seconds segment_duration{0};            //0 rolls over by size only
+        };
+
+        struct Stats {
+            std::uint64_t frames;        //written
+            std::uint64_t dropped;       //no free buffer, writer fell behind
+            std::uint64_t not_ready;
+            std::uint64_t bytes;
+            std::uint32_t segments;
+            std::uint32_t max_queued;    //frames waiting for writer at worst
+            bool write_failed;
+        };
+
+        explicit LiveViewRecorder(const Options &options);
+
+        //finishes queued frames and closes segment
+        ~LiveViewRecorder();
+
+        LiveViewRecorder(const LiveViewRecorder &) = delete;
+        LiveViewRecorder &operator=(const LiveViewRecorder &) = delete;
+
+        //segments are written as directory/liveview_0001.avi and so on
+        bool start(const std::string &directory);
+
+        //records one frame if frame interval has passed, live view is started on the first call;
+        //must be called from the thread pumping EDSDK::events()
+        bool record(EDSDK::Camera &camera);
+
+        void stop();
+
+        [[nodiscard]] Stats stats() const;
+
+    private:
+        struct Frame {
+            std::vector<std::uint8_t> *buffer;
+            std::size_t size;
+            std::int64_t timestamp_ns;
+        };
+
+        struct IndexEntry {
+            std::uint32_t offset; //from movi list type, as idx1 wants it
+            std::uint32_t size;
+        };
+
+        void _write_loop();
+
+        bool _open_segment();
+
+        bool _write_frame(const Frame &frame);
+
+        void _close_segment();
+
+        Options _options;
+        std::string _directory;
+
+        std::vector<std::unique_ptr<std::vector<std::uint8_t>>> _pool;
+
+        mutable std::mutex _mutex;
+        std::condition_variable _queued;
+        std::vector<std::vector<std::uint8_t>*> _free;
+        std::deque<Frame> _queue;
+        bool _stopping;
+        std::thread _writer;
+
+        std::chrono::steady_clock::time_point _last_frame;
+        std::uint64_t _live_view_generation; //camera generation live view was started for, 0 before
+
+        //writer thread only
+        std::ofstream _segment;
+        std::uint64_t _segment_bytes;
+        std::int64_t _segment_start_ns;
+        std::int64_t _last_timestamp_ns;
+        std::uint32_t _width;
+        std::uint32_t _height;
+        std::vector<IndexEntry> _index;
+        std::vector<std::int64_t> _timestamps;
+
+        Stats _stats;
+    };
+} //namespace edsdk_w
+
+#endif //LIVE_VIEW_RECORDER_HPP
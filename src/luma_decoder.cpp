@@ -0,0 +1,93 @@
+#include "luma_decoder.hpp"
+
+#ifdef EDSW_HAVE_JPEG
+#include <csetjmp>
+#include <cstdio>
+#include <jpeglib.h>
+#endif
+
+namespace edsdk_w {
+#ifdef EDSW_HAVE_JPEG
+    //libjpeg reports errors through a callback which must not return, it jumps back into decode
+    struct LumaDecoder::State {
+        jpeg_decompress_struct info{};
+        jpeg_error_mgr error{};
+        std::jmp_buf jump{};
+
+        State() {
+            info.err = jpeg_std_error(&error);
+            error.error_exit = [](j_common_ptr common) {
+                std::longjmp(static_cast<State *>(common->client_data)->jump, 1);
+            };
+            error.output_message = [](j_common_ptr) {};
+            jpeg_create_decompress(&info);
+            info.client_data = this;
+        }
+
+        ~State() {
+            jpeg_destroy_decompress(&info);
+        }
+    };
+#else
+    struct LumaDecoder::State {};
+#endif
+
+    LumaDecoder::LumaDecoder() :
+            _state{std::make_unique<State>()} {}
+
+    LumaDecoder::~LumaDecoder() = default;
+
+    bool LumaDecoder::decode(const std::uint8_t *jpeg,
+                             std::size_t size,
+                             std::uint32_t scale_denominator,
+                             std::vector<std::uint8_t> &luma,
+                             std::uint32_t &width,
+                             std::uint32_t &height) {
+#ifdef EDSW_HAVE_JPEG
+        //nothing with a destructor may live between setjmp and the jump
+        auto &info = _state->info;
+        if (setjmp(_state->jump)) {
+            jpeg_abort_decompress(&info);
+            return false;
+        }
+
+        jpeg_mem_src(&info, const_cast<unsigned char *>(jpeg), static_cast<unsigned long>(size));
+        jpeg_read_header(&info, TRUE);
+
+        //scaled IDCT skips most of the work, chroma is never upsampled
+        info.out_color_space = JCS_GRAYSCALE;
+        info.scale_num = 1;
+        info.scale_denom = scale_denominator;
+        info.dct_method = JDCT_IFAST;
+        info.do_fancy_upsampling = FALSE;
+        info.do_block_smoothing = FALSE;
+        jpeg_start_decompress(&info);
+
+        width = info.output_width;
+        height = info.output_height;
+        luma.resize(static_cast<std::size_t>(width) * height);
+        while (info.output_scanline < info.output_height) {
+            JSAMPROW row = luma.data() + static_cast<std::size_t>(info.output_scanline) * width;
+            jpeg_read_scanlines(&info, &row, 1);
+        }
+        jpeg_finish_decompress(&info);
+        return true;
+#else
+        (void) jpeg;
+        (void) size;
+        (void) scale_denominator;
+        (void) luma;
+        (void) width;
+        (void) height;
+        return false;
+#endif
+    }
+
+    bool LumaDecoder::available() {
+#ifdef EDSW_HAVE_JPEG
+        return true;
+#else
+        return false;
+#endif
+    }
+} //namespace edsdk_w
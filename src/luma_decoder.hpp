@@ -0,0 +1,37 @@
+#ifndef LUMA_DECODER_HPP
+#define LUMA_DECODER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace edsdk_w {
+    //decodes live view jpeg frames to luma only at reduced scale, for analysis rather than display
+    class LumaDecoder {
+    public:
+        LumaDecoder();
+        ~LumaDecoder();
+
+        LumaDecoder(const LumaDecoder &) = delete;
+        LumaDecoder &operator=(const LumaDecoder &) = delete;
+
+        //scale denominator of 1, 2, 4 or 8; luma is resized to width * height, false on corrupt data
+        bool decode(const std::uint8_t *jpeg,
+                    std::size_t size,
+                    std::uint32_t scale_denominator,
+                    std::vector<std::uint8_t> &luma,
+                    std::uint32_t &width,
+                    std::uint32_t &height);
+
+        //false when built without libjpeg, decode() fails then
+        static bool available();
+
+    private:
+        struct State;
+
+        std::unique_ptr<State> _state;
+    };
+} //namespace edsdk_w
+
+#endif //LUMA_DECODER_HPP
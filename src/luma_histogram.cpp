@@ -0,0 +1,164 @@
+#include "luma_histogram.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define HISTOGRAM_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#else
+#define HISTOGRAM_X86 0
+#endif
+
+namespace edsdk_w {
+    namespace {
+        constexpr std::size_t ZONES = LumaHistogram::ZONES;
+
+        using Histogram = void (*)(const std::uint8_t *, std::size_t, LumaHistogram &);
+
+        void count_tail(const std::uint8_t *luma, std::size_t from, std::size_t pixels, LumaHistogram &histogram) {
+            for (auto i = from; i < pixels; i++) {
+                histogram.zones[luma[i] >> 4]++;
+                histogram.sum += luma[i];
+                histogram.clipped += luma[i] == 0xff;
+            }
+        }
+
+#if HISTOGRAM_X86
+        //8-bit counter per zone and byte lane, a lane is bumped by subtracting the all-ones compare
+        //result; counters are folded with psadbw before 255 vectors can overflow them, the last zone
+        //is what the others leave; clipped pixels get a counter of their own
+        void luma_histogram_sse2(const std::uint8_t *luma, std::size_t pixels, LumaHistogram &histogram) {
+            histogram = {};
+            const auto zero = _mm_setzero_si128();
+            const auto low_nibble = _mm_set1_epi8(0x0f);
+            const auto white = _mm_set1_epi8(static_cast<char>(0xff));
+            auto sum = zero;
+            std::size_t vector_end = pixels & ~static_cast<std::size_t>(15);
+            std::uint32_t counted = 0;
+
+            for (std::size_t i = 0; i < vector_end;) {
+                auto block_end = std::min(vector_end, i + 255 * 16);
+                __m128i counters[ZONES];
+                std::fill(std::begin(counters), std::end(counters), zero);
+                for (; i < block_end; i += 16) {
+                    auto v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(luma + i));
+                    sum = _mm_add_epi64(sum, _mm_sad_epu8(v, zero));
+                    counters[ZONES - 1] = _mm_sub_epi8(counters[ZONES - 1], _mm_cmpeq_epi8(v, white));
+                    auto zone = _mm_and_si128(_mm_srli_epi16(v, 4), low_nibble);
+                    for (std::size_t z = 0; z < ZONES - 1; z++) {
+                        counters[z] = _mm_sub_epi8(counters[z], _mm_cmpeq_epi8(zone, _mm_set1_epi8(static_cast<char>(z))));
+                    }
+                }
+                for (std::size_t z = 0; z < ZONES; z++) {
+                    auto folded = _mm_sad_epu8(counters[z], zero);
+                    auto count = static_cast<std::uint32_t>(_mm_cvtsi128_si32(folded) + _mm_cvtsi128_si32(_mm_srli_si128(folded, 8)));
+                    if (z == ZONES - 1) {
+                        histogram.clipped += count;
+                    } else {
+                        histogram.zones[z] += count;
+                        counted += count;
+                    }
+                }
+            }
+            histogram.zones[ZONES - 1] = static_cast<std::uint32_t>(vector_end) - counted;
+            histogram.sum = static_cast<std::uint64_t>(_mm_cvtsi128_si64(sum)) +
+                            static_cast<std::uint64_t>(_mm_cvtsi128_si64(_mm_srli_si128(sum, 8)));
+            count_tail(luma, vector_end, pixels, histogram);
+            histogram.pixels = static_cast<std::uint32_t>(pixels);
+        }
+
+#if defined(_MSC_VER)
+        bool detect_avx2() {
+            int info[4];
+            __cpuid(info, 1);
+            bool os_saves_ymm = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 6) == 6;
+            __cpuidex(info, 7, 0);
+            return os_saves_ymm && (info[1] & (1 << 5)) != 0;
+        }
+
+        void luma_histogram_avx2(const std::uint8_t *luma, std::size_t pixels, LumaHistogram &histogram) {
+#else
+        bool detect_avx2() {
+            return __builtin_cpu_supports("avx2");
+        }
+
+        __attribute__((target("avx2")))
+        void luma_histogram_avx2(const std::uint8_t *luma, std::size_t pixels, LumaHistogram &histogram) {
+#endif
+            //same counters as sse2 over 32 pixels
+            histogram = {};
+            const auto zero = _mm256_setzero_si256();
+            const auto low_nibble = _mm256_set1_epi8(0x0f);
+            const auto white = _mm256_set1_epi8(static_cast<char>(0xff));
+            auto sum = zero;
+            std::size_t vector_end = pixels & ~static_cast<std::size_t>(31);
+            std::uint32_t counted = 0;
+
+            for (std::size_t i = 0; i < vector_end;) {
+                auto block_end = std::min(vector_end, i + 255 * 32);
+                __m256i counters[ZONES];
+                std::fill(std::begin(counters), std::end(counters), zero);
+                for (; i < block_end; i += 32) {
+                    auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(luma + i));
+                    sum = _mm256_add_epi64(sum, _mm256_sad_epu8(v, zero));
+                    counters[ZONES - 1] = _mm256_sub_epi8(counters[ZONES - 1], _mm256_cmpeq_epi8(v, white));
+                    auto zone = _mm256_and_si256(_mm256_srli_epi16(v, 4), low_nibble);
+                    for (std::size_t z = 0; z < ZONES - 1; z++) {
+                        counters[z] = _mm256_sub_epi8(counters[z], _mm256_cmpeq_epi8(zone, _mm256_set1_epi8(static_cast<char>(z))));
+                    }
+                }
+                for (std::size_t z = 0; z < ZONES; z++) {
+                    auto folded = _mm256_sad_epu8(counters[z], zero);
+                    auto pair = _mm_add_epi64(_mm256_castsi256_si128(folded), _mm256_extracti128_si256(folded, 1));
+                    auto count = static_cast<std::uint32_t>(_mm_cvtsi128_si32(pair) + _mm_cvtsi128_si32(_mm_srli_si128(pair, 8)));
+                    if (z == ZONES - 1) {
+                        histogram.clipped += count;
+                    } else {
+                        histogram.zones[z] += count;
+                        counted += count;
+                    }
+                }
+            }
+            histogram.zones[ZONES - 1] = static_cast<std::uint32_t>(vector_end) - counted;
+            auto sums = _mm_add_epi64(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+            histogram.sum = static_cast<std::uint64_t>(_mm_cvtsi128_si64(sums)) +
+                            static_cast<std::uint64_t>(_mm_cvtsi128_si64(_mm_srli_si128(sums, 8)));
+            count_tail(luma, vector_end, pixels, histogram);
+            histogram.pixels = static_cast<std::uint32_t>(pixels);
+        }
+
+        const bool AVX2 = detect_avx2();
+        const Histogram HISTOGRAM = AVX2 ? luma_histogram_avx2 : luma_histogram_sse2;
+        const char *const HISTOGRAM_ISA = AVX2 ? "avx2" : "sse2";
+#else
+        const Histogram HISTOGRAM = luma_histogram_scalar;
+        const char *const HISTOGRAM_ISA = "scalar";
+#endif
+    }
+
+    double LumaHistogram::mean() const {
+        return pixels ? static_cast<double>(sum) / pixels : 0;
+    }
+
+    double LumaHistogram::clipped_share() const {
+        return pixels ? static_cast<double>(clipped) / pixels : 0;
+    }
+
+    void luma_histogram(const std::uint8_t *luma, std::size_t pixels, LumaHistogram &histogram) {
+        HISTOGRAM(luma, pixels, histogram);
+    }
+
+    void luma_histogram_scalar(const std::uint8_t *luma, std::size_t pixels, LumaHistogram &histogram) {
+        histogram = {};
+        count_tail(luma, 0, pixels, histogram);
+        histogram.pixels = static_cast<std::uint32_t>(pixels);
+    }
+
+    const char *luma_histogram_isa() {
+        return HISTOGRAM_ISA;
+    }
+} //namespace edsdk_w
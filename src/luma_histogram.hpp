@@ -0,0 +1,33 @@
+#ifndef LUMA_HISTOGRAM_HPP
+#define LUMA_HISTOGRAM_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace edsdk_w {
+    //luma counted in 16 zones of 16 levels each, enough to meter by; sum and clipped count are exact
+    struct LumaHistogram {
+        static constexpr std::size_t ZONES = 16;
+
+        std::array<std::uint32_t, ZONES> zones;
+        std::uint64_t sum;
+        std::uint32_t clipped; //pixels at 255
+        std::uint32_t pixels;
+
+        [[nodiscard]] double mean() const;
+
+        //share of clipped pixels, bright but unclipped sky in the top zone does not count
+        [[nodiscard]] double clipped_share() const;
+    };
+
+    void luma_histogram(const std::uint8_t *luma, std::size_t pixels, LumaHistogram &histogram);
+
+    //portable fallback, exposed for benchmarks
+    void luma_histogram_scalar(const std::uint8_t *luma, std::size_t pixels, LumaHistogram &histogram);
+
+    //instruction set picked by luma_histogram(): "avx2", "sse2" or "scalar"
+    const char *luma_histogram_isa();
+} //namespace edsdk_w
+
+#endif //LUMA_HISTOGRAM_HPP
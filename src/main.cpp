@@ -1,7 +1,91 @@
+#include <fstream>
 #include <iostream>
+#include <string>
+#include "batch_runner.hpp"
 #include "edsdk_wrapper.hpp"
 
-int main() {
-    std::cout << "test message" << std::endl;
-    return 0;
-}
\ No newline at end of file
+#ifdef __linux__
+#include <csignal>
+#include "control_server.hpp"
+#endif
+
+namespace {
+    int run_batch(const std::string &script_path) {
+        std::ifstream script{script_path};
+        if (!script) {
+            std::cerr << "cannot open script " << script_path << std::endl;
+            return 1;
+        }
+
+        edsdk_w::BatchRunner runner{};
+        if (!runner.load(script, std::cerr)) {
+            return 1;
+        }
+
+        bool res = runner.run();
+        runner.report(std::cout);
+        return res ? 0 : 2;
+    }
+
+#ifdef __linux__
+    edsdk_w::ControlServer *running_server = nullptr;
+
+    void stop_server(int) {
+        if (running_server) {
+            running_server->stop();
+        }
+    }
+
+    int run_daemon(const std::string &socket_path, std::uint8_t camera_index, const std::string &evf_shm_name) {
+        edsdk_w::ControlServer server{};
+        if (!server.start(socket_path)) {
+            std::cerr << "failed to listen on " << socket_path << std::endl;
+            return 1;
+        }
+
+        edsdk_w::LiveViewPublisher publisher{};
+        if (!evf_shm_name.empty()) {
+            if (!publisher.open(evf_shm_name)) {
+                std::cerr << "failed to create shared memory " << evf_shm_name << std::endl;
+                return 1;
+            }
+            server.set_live_view_publisher(&publisher);
+        }
+
+        if (!edsdk_w::EDSDK::get_instance().set_camera(camera_index)) {
+            std::cerr << "camera " << int(camera_index) << " is not available, serving without camera" << std::endl;
+        }
+
+        running_server = &server;
+        std::signal(SIGINT, stop_server);
+        std::signal(SIGTERM, stop_server);
+
+        server.run();
+
+        running_server = nullptr;
+        return 0;
+    }
+#endif
+}
+
+int main(int argc, char **argv) {
+#ifdef __linux__
+    //main --daemon <socket_path> [camera_index] [live_view_shm_name]
+    if (argc >= 3 && std::string(argv[1]) == "--daemon") {
+        return run_daemon(argv[2],
+                          argc > 3 ? static_cast<std::uint8_t>(std::stoi(argv[3])) : 0,
+                          argc > 4 ? argv[4] : "");
+    }
+#endif
+
+    //main <script>
+    if (argc == 2) {
+        return run_batch(argv[1]);
+    }
+
+    std::cerr << "usage: " << argv[0] << " <script>" << std::endl;
+#ifdef __linux__
+    std::cerr << "       " << argv[0] << " --daemon <socket_path> [camera_index] [live_view_shm_name]" << std::endl;
+#endif
+    return 1;
+}
@@ -0,0 +1,250 @@
+#include "mapped_file.hpp"
+
+#include <utility>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace utils {
+    MappedFile::~MappedFile() {
+        close();
+    }
+
+    MappedFile::MappedFile(MappedFile &&other) noexcept {
+        *this = std::move(other);
+    }
+
+    MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+        if (this != &other) {
+            close();
+            std::swap(_data, other._data);
+            std::swap(_size, other._size);
+            std::swap(_mode, other._mode);
+#ifdef _WIN32
+            std::swap(_file, other._file);
+            std::swap(_mapping, other._mapping);
+#else
+            std::swap(_fd, other._fd);
+#endif
+        }
+        return *this;
+    }
+
+#ifdef _WIN32
+    bool MappedFile::open(const std::string &path, Mode mode, std::size_t min_size) {
+        close();
+        _mode = mode;
+
+        DWORD access = mode == Mode::ReadWrite ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ;
+        DWORD disposition = mode == Mode::ReadWrite ? OPEN_ALWAYS : OPEN_EXISTING;
+        HANDLE file = CreateFileA(path.c_str(), access, FILE_SHARE_READ, nullptr,
+                                  disposition, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+        _file = file;
+
+        LARGE_INTEGER file_size;
+        if (!GetFileSizeEx(file, &file_size)) {
+            close();
+            return false;
+        }
+        _size = static_cast<std::size_t>(file_size.QuadPart);
+
+        if (mode == Mode::ReadWrite && _size < min_size) {
+            if (!resize(min_size)) {
+                close();
+                return false;
+            }
+            return true;
+        }
+
+        if (!_map()) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void MappedFile::close() {
+        _unmap();
+        if (_file) {
+            CloseHandle(static_cast<HANDLE>(_file));
+            _file = nullptr;
+        }
+        _size = 0;
+    }
+
+    bool MappedFile::resize(std::size_t new_size) {
+        if (!_file || _mode != Mode::ReadWrite) {
+            return false;
+        }
+
+        _unmap();
+
+        LARGE_INTEGER position;
+        position.QuadPart = static_cast<LONGLONG>(new_size);
+        if (!SetFilePointerEx(static_cast<HANDLE>(_file), position, nullptr, FILE_BEGIN) ||
+            !SetEndOfFile(static_cast<HANDLE>(_file))) {
+            return false;
+        }
+        _size = new_size;
+
+        return _map();
+    }
+
+    bool MappedFile::flush(std::size_t offset, std::size_t length, bool wait) {
+        if (!_data || offset >= _size) {
+            return false;
+        }
+        if (offset + length > _size) {
+            length = _size - offset;
+        }
+
+        if (!FlushViewOfFile(_data + offset, length)) {
+            return false;
+        }
+        return !wait || FlushFileBuffers(static_cast<HANDLE>(_file));
+    }
+
+    bool MappedFile::_map() {
+        if (_size == 0) {
+            return true;
+        }
+
+        DWORD protect = _mode == Mode::ReadWrite ? PAGE_READWRITE : PAGE_READONLY;
+        DWORD access = _mode == Mode::ReadWrite ? FILE_MAP_WRITE : FILE_MAP_READ;
+        auto size = static_cast<std::uint64_t>(_size);
+
+        HANDLE mapping = CreateFileMappingA(static_cast<HANDLE>(_file), nullptr, protect,
+                                           static_cast<DWORD>(size >> 32),
+                                           static_cast<DWORD>(size & 0xffffffff),
+                                           nullptr);
+        if (!mapping) {
+            return false;
+        }
+
+        void *view = MapViewOfFile(mapping, access, 0, 0, _size);
+        if (!view) {
+            CloseHandle(mapping);
+            return false;
+        }
+
+        _mapping = mapping;
+        _data = static_cast<std::uint8_t *>(view);
+        return true;
+    }
+
+    void MappedFile::_unmap() {
+        if (_data) {
+            UnmapViewOfFile(_data);
+            _data = nullptr;
+        }
+        if (_mapping) {
+            CloseHandle(static_cast<HANDLE>(_mapping));
+            _mapping = nullptr;
+        }
+    }
+#else
+    bool MappedFile::open(const std::string &path, Mode mode, std::size_t min_size) {
+        close();
+        _mode = mode;
+
+        int flags = mode == Mode::ReadWrite ? O_RDWR | O_CREAT : O_RDONLY;
+        _fd = ::open(path.c_str(), flags | O_CLOEXEC, 0644);
+        if (_fd < 0) {
+            return false;
+        }
+
+        struct stat st{};
+        if (fstat(_fd, &st) != 0) {
+            close();
+            return false;
+        }
+        _size = static_cast<std::size_t>(st.st_size);
+
+        if (mode == Mode::ReadWrite && _size < min_size) {
+            if (!resize(min_size)) {
+                close();
+                return false;
+            }
+            return true;
+        }
+
+        if (!_map()) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void MappedFile::close() {
+        _unmap();
+        if (_fd >= 0) {
+            ::close(_fd);
+            _fd = -1;
+        }
+        _size = 0;
+    }
+
+    bool MappedFile::resize(std::size_t new_size) {
+        if (_fd < 0 || _mode != Mode::ReadWrite) {
+            return false;
+        }
+
+        _unmap();
+
+        if (ftruncate(_fd, static_cast<off_t>(new_size)) != 0) {
+            return false;
+        }
+        _size = new_size;
+
+        return _map();
+    }
+
+    bool MappedFile::flush(std::size_t offset, std::size_t length, bool wait) {
+        if (!_data || offset >= _size) {
+            return false;
+        }
+        if (offset + length > _size) {
+            length = _size - offset;
+        }
+
+        //msync requires page aligned address
+        auto page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+        std::size_t aligned_offset = offset - offset % page;
+        length += offset - aligned_offset;
+
+        return msync(_data + aligned_offset, length, wait ? MS_SYNC : MS_ASYNC) == 0;
+    }
+
+    bool MappedFile::_map() {
+        if (_size == 0) {
+            return true;
+        }
+
+        int protect = _mode == Mode::ReadWrite ? PROT_READ | PROT_WRITE : PROT_READ;
+        void *view = mmap(nullptr, _size, protect, MAP_SHARED, _fd, 0);
+        if (view == MAP_FAILED) {
+            return false;
+        }
+
+        _data = static_cast<std::uint8_t *>(view);
+        return true;
+    }
+
+    void MappedFile::_unmap() {
+        if (_data) {
+            munmap(_data, _size);
+            _data = nullptr;
+        }
+    }
+#endif
+} //namespace utils
@@ -0,0 +1,56 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace utils {
+    class MappedFile {
+    public:
+        enum class Mode {
+            ReadOnly,
+            ReadWrite
+        };
+
+        MappedFile() = default;
+        ~MappedFile();
+
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+
+        MappedFile(MappedFile &&other) noexcept;
+        MappedFile &operator=(MappedFile &&other) noexcept;
+
+        //in ReadWrite mode file is created if missing and extended to min_size
+        bool open(const std::string &path, Mode mode, std::size_t min_size = 0);
+        void close();
+
+        //remaps file with a new size, content of existing part is kept
+        bool resize(std::size_t new_size);
+
+        //writes dirty pages in range back to the file
+        bool flush(std::size_t offset, std::size_t length, bool wait = true);
+
+        [[nodiscard]] bool is_open() const { return _data != nullptr; }
+        [[nodiscard]] std::size_t size() const { return _size; }
+        [[nodiscard]] std::uint8_t *data() { return _data; }
+        [[nodiscard]] const std::uint8_t *data() const { return _data; }
+
+    private:
+        bool _map();
+        void _unmap();
+
+        std::uint8_t *_data = nullptr;
+        std::size_t _size = 0;
+        Mode _mode = Mode::ReadOnly;
+#ifdef _WIN32
+        void *_file = nullptr;
+        void *_mapping = nullptr;
+#else
+        int _fd = -1;
+#endif
+    };
+} //namespace utils
+
+#endif //MAPPED_FILE_HPP
@@ -0,0 +1,113 @@
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "motion_detector.hpp"
+
+//single core throughput of motion detection:
+//motion_bench [directory of recorded live view jpeg frames] [rounds]
+//block difference kernels run on synthetic luma frames, recorded frames add the full decode and detect path
+namespace {
+    using clock = std::chrono::steady_clock;
+    using namespace edsdk_w;
+
+    //gradient with a bright square moving across it
+    std::vector<std::vector<std::uint8_t>> synthetic_frames(std::uint32_t width, std::uint32_t height, std::size_t count) {
+        std::vector<std::vector<std::uint8_t>> res(count, std::vector<std::uint8_t>(static_cast<std::size_t>(width) * height));
+        for (std::size_t f = 0; f < count; f++) {
+            auto &frame = res[f];
+            for (std::uint32_t y = 0; y < height; y++) {
+                for (std::uint32_t x = 0; x < width; x++) {
+                    frame[static_cast<std::size_t>(y) * width + x] = static_cast<std::uint8_t>((x + y + f % 3) / 2);
+                }
+            }
+            auto left = static_cast<std::uint32_t>(f * 4 % (width - 32)), top = height / 3;
+            for (std::uint32_t y = top; y < top + 32; y++) {
+                std::fill_n(frame.begin() + static_cast<std::ptrdiff_t>(y) * width + left, 32, 240);
+            }
+        }
+        return res;
+    }
+
+    void run_kernel(const char *name,
+                    void (*kernel)(const std::uint8_t *, const std::uint8_t *, std::uint32_t, std::uint32_t, std::uint32_t *),
+                    std::uint32_t width,
+                    std::uint32_t height,
+                    std::size_t rounds) {
+        auto frames = synthetic_frames(width, height, 64);
+        std::vector<std::uint32_t> sads((width / MotionDetector::BLOCK_SIZE) * (height / MotionDetector::BLOCK_SIZE));
+        std::uint64_t checksum = 0;
+
+        auto start = clock::now();
+        for (std::size_t r = 0; r < rounds; r++) {
+            for (std::size_t f = 1; f < frames.size(); f++) {
+                kernel(frames[f].data(), frames[f - 1].data(), width, height, sads.data());
+                checksum += sads[sads.size() / 2];
+            }
+        }
+        double seconds = std::chrono::duration<double>(clock::now() - start).count();
+        auto count = static_cast<double>(rounds * (frames.size() - 1));
+        std::cout << std::fixed << std::setprecision(0) << name << " " << width << "x" << height << ": "
+                  << count / seconds << " frames/s (checksum " << checksum << ")" << std::endl;
+    }
+}
+
+int main(int argc, char **argv) {
+    std::size_t rounds = argc > 2 ? std::stoul(argv[2]) : 200;
+
+    //live view is 960x640 on most bodies, decoded at 1/4 and 1/2
+    for (auto [width, height] : {std::pair<std::uint32_t, std::uint32_t>{240, 160}, {480, 320}}) {
+        run_kernel("scalar", block_sads_scalar, width, height, rounds);
+        run_kernel(block_sads_isa(), block_sads, width, height, rounds);
+    }
+
+    if (argc < 2) {
+        return 0;
+    }
+    if (!MotionDetector::decoding_available()) {
+        std::cerr << "built without jpeg decoder" << std::endl;
+        return 1;
+    }
+
+    std::vector<std::vector<std::uint8_t>> recorded{};
+    for (const auto &entry : std::filesystem::directory_iterator{argv[1]}) {
+        if (entry.is_regular_file()) {
+            std::ifstream file{entry.path(), std::ios::binary};
+            recorded.emplace_back(std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{});
+        }
+    }
+    if (recorded.empty()) {
+        std::cerr << "no frames in " << argv[1] << std::endl;
+        return 1;
+    }
+
+    for (std::uint32_t scale : {8u, 4u, 2u}) {
+        MotionDetector::Options options{};
+        options.scale_denominator = scale;
+        MotionDetector detector{options};
+
+        std::size_t frames = 0, failures = 0, motion = 0;
+        auto start = clock::now();
+        for (std::size_t r = 0; r < std::max<std::size_t>(1, rounds / 20); r++) {
+            for (const auto &jpeg : recorded) {
+                MotionDetector::Result result{};
+                if (detector.process(jpeg.data(), jpeg.size(), result)) {
+                    motion += result.motion;
+                } else {
+                    failures++;
+                }
+                frames++;
+            }
+        }
+        double seconds = std::chrono::duration<double>(clock::now() - start).count();
+        std::cout << std::fixed << std::setprecision(0) << "decode 1/" << scale << " + detect: "
+                  << static_cast<double>(frames) / seconds << " frames/s, " << motion << " with motion, "
+                  << failures << " not decoded" << std::endl;
+    }
+    return 0;
+}
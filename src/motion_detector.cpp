@@ -0,0 +1,201 @@
+#include "motion_detector.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define MOTION_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#else
+#define MOTION_X86 0
+#endif
+
+namespace edsdk_w {
+    namespace {
+        constexpr std::uint32_t BLOCK = MotionDetector::BLOCK_SIZE;
+
+        using BlockSads = void (*)(const std::uint8_t *, const std::uint8_t *, std::uint32_t, std::uint32_t, std::uint32_t *);
+
+#if MOTION_X86
+        //SSE2 is part of x86-64, one psadbw covers a block row
+        inline std::uint32_t sad_block_sse2(const std::uint8_t *frame, const std::uint8_t *background, std::uint32_t width) {
+            __m128i acc = _mm_setzero_si128();
+            for (std::uint32_t y = 0; y < BLOCK; y++, frame += width, background += width) {
+                auto a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(frame));
+                auto b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(background));
+                acc = _mm_add_epi64(acc, _mm_sad_epu8(a, b));
+            }
+            return static_cast<std::uint32_t>(_mm_cvtsi128_si32(acc) + _mm_cvtsi128_si32(_mm_srli_si128(acc, 8)));
+        }
+
+        void block_sads_sse2(const std::uint8_t *frame,
+                             const std::uint8_t *background,
+                             std::uint32_t width,
+                             std::uint32_t height,
+                             std::uint32_t *sads) {
+            auto blocks_x = width / BLOCK, blocks_y = height / BLOCK;
+            for (std::uint32_t by = 0; by < blocks_y; by++) {
+                auto row = static_cast<std::size_t>(by) * BLOCK * width;
+                for (std::uint32_t bx = 0; bx < blocks_x; bx++) {
+                    *sads++ = sad_block_sse2(frame + row + bx * BLOCK, background + row + bx * BLOCK, width);
+                }
+            }
+        }
+
+#if defined(_MSC_VER)
+        bool detect_avx2() {
+            int info[4];
+            __cpuid(info, 1);
+            bool os_saves_ymm = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 6) == 6;
+            __cpuidex(info, 7, 0);
+            return os_saves_ymm && (info[1] & (1 << 5)) != 0;
+        }
+
+        void block_sads_avx2(const std::uint8_t *frame,
+                             const std::uint8_t *background,
+                             std::uint32_t width,
+                             std::uint32_t height,
+                             std::uint32_t *sads) {
+#else
+        bool detect_avx2() {
+            return __builtin_cpu_supports("avx2");
+        }
+
+        __attribute__((target("avx2")))
+        void block_sads_avx2(const std::uint8_t *frame,
+                             const std::uint8_t *background,
+                             std::uint32_t width,
+                             std::uint32_t height,
+                             std::uint32_t *sads) {
+#endif
+            //two neighbouring blocks per vpsadbw, each owns two of the four 64-bit sums
+            auto blocks_x = width / BLOCK, blocks_y = height / BLOCK;
+            for (std::uint32_t by = 0; by < blocks_y; by++) {
+                auto row = static_cast<std::size_t>(by) * BLOCK * width;
+                std::uint32_t bx = 0;
+                for (; bx + 2 <= blocks_x; bx += 2) {
+                    auto f = frame + row + bx * BLOCK, b = background + row + bx * BLOCK;
+                    __m256i acc = _mm256_setzero_si256();
+                    for (std::uint32_t y = 0; y < BLOCK; y++, f += width, b += width) {
+                        auto va = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(f));
+                        auto vb = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b));
+                        acc = _mm256_add_epi64(acc, _mm256_sad_epu8(va, vb));
+                    }
+                    auto lo = _mm256_castsi256_si128(acc), hi = _mm256_extracti128_si256(acc, 1);
+                    *sads++ = static_cast<std::uint32_t>(_mm_cvtsi128_si32(lo) + _mm_cvtsi128_si32(_mm_srli_si128(lo, 8)));
+                    *sads++ = static_cast<std::uint32_t>(_mm_cvtsi128_si32(hi) + _mm_cvtsi128_si32(_mm_srli_si128(hi, 8)));
+                }
+                for (; bx < blocks_x; bx++) {
+                    *sads++ = sad_block_sse2(frame + row + bx * BLOCK, background + row + bx * BLOCK, width);
+                }
+            }
+        }
+
+        const bool AVX2 = detect_avx2();
+        const BlockSads BLOCK_SADS = AVX2 ? block_sads_avx2 : block_sads_sse2;
+        const char *const BLOCK_SADS_ISA = AVX2 ? "avx2" : "sse2";
+#else
+        const BlockSads BLOCK_SADS = block_sads_scalar;
+        const char *const BLOCK_SADS_ISA = "scalar";
+#endif
+    }
+
+    MotionDetector::MotionDetector(const Options &options) :
+            _options{options},
+            _width{0},
+            _height{0},
+            _frames{0} {}
+
+    bool MotionDetector::process(const std::uint8_t *jpeg, std::size_t size, Result &result) {
+        std::uint32_t width = 0, height = 0;
+        if (!_decoder.decode(jpeg, size, _options.scale_denominator, _luma, width, height)) {
+            return false;
+        }
+        result = analyze(_luma.data(), width, height);
+        return true;
+    }
+
+    MotionDetector::Result MotionDetector::analyze(const std::uint8_t *luma, std::uint32_t width, std::uint32_t height) {
+        Result res{};
+        auto pixels = static_cast<std::size_t>(width) * height;
+        if (width != _width || height != _height) {
+            _width = width;
+            _height = height;
+            _average.resize(pixels);
+            _background.resize(pixels);
+            _frames = 0;
+        }
+        if (_frames == 0) {
+            std::copy(luma, luma + pixels, _background.begin());
+            for (std::size_t i = 0; i < pixels; i++) {
+                _average[i] = static_cast<std::uint16_t>(luma[i] << 8);
+            }
+        }
+
+        res.blocks = (width / BLOCK_SIZE) * (height / BLOCK_SIZE);
+        _sads.resize(res.blocks);
+        block_sads(luma, _background.data(), width, height, _sads.data());
+
+        auto threshold = _options.block_threshold * BLOCK_SIZE * BLOCK_SIZE;
+        for (auto sad : _sads) {
+            res.changed_blocks += sad > threshold;
+        }
+
+        //plain loop over pixels, compilers vectorize it
+        auto shift = _options.background_shift;
+        for (std::size_t i = 0; i < pixels; i++) {
+            std::int32_t average = _average[i];
+            average += ((static_cast<std::int32_t>(luma[i]) << 8) - average) / (1 << shift);
+            _average[i] = static_cast<std::uint16_t>(average);
+            _background[i] = static_cast<std::uint8_t>((average + 128) >> 8);
+        }
+
+        _frames++;
+        res.motion = _frames > _options.warmup_frames && res.blocks > 0 &&
+                     res.changed_blocks >= _options.trigger_fraction * res.blocks;
+        return res;
+    }
+
+    void MotionDetector::reset() {
+        _frames = 0;
+    }
+
+    bool MotionDetector::decoding_available() {
+        return LumaDecoder::available();
+    }
+
+    void block_sads(const std::uint8_t *frame,
+                    const std::uint8_t *background,
+                    std::uint32_t width,
+                    std::uint32_t height,
+                    std::uint32_t *sads) {
+        BLOCK_SADS(frame, background, width, height, sads);
+    }
+
+    void block_sads_scalar(const std::uint8_t *frame,
+                           const std::uint8_t *background,
+                           std::uint32_t width,
+                           std::uint32_t height,
+                           std::uint32_t *sads) {
+        auto blocks_x = width / BLOCK, blocks_y = height / BLOCK;
+        for (std::uint32_t by = 0; by < blocks_y; by++) {
+            for (std::uint32_t bx = 0; bx < blocks_x; bx++) {
+                std::uint32_t sum = 0;
+                auto offset = static_cast<std::size_t>(by) * BLOCK * width + bx * BLOCK;
+                for (std::uint32_t y = 0; y < BLOCK; y++, offset += width) {
+                    for (std::uint32_t x = 0; x < BLOCK; x++) {
+                        sum += static_cast<std::uint32_t>(std::abs(frame[offset + x] - background[offset + x]));
+                    }
+                }
+                *sads++ = sum;
+            }
+        }
+    }
+
+    const char *block_sads_isa() {
+        return BLOCK_SADS_ISA;
+    }
+} //namespace edsdk_w
@@ -0,0 +1,83 @@
+#ifndef MOTION_DETECTOR_HPP
+#define MOTION_DETECTOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "luma_decoder.hpp"
+
+namespace edsdk_w {
+    //detects motion in live view frames against a slowly adapting background
+    //
+    //frames are decoded to luma at reduced scale and compared in square blocks by sum of absolute
+    //differences, a block is changed when its mean difference per pixel exceeds the threshold;
+    //background follows the scene, so light changes fade in instead of triggering forever
+    class MotionDetector {
+    public:
+        static constexpr std::uint32_t BLOCK_SIZE = 16;
+
+        struct Options {
+            std::uint32_t scale_denominator = 4; //decode at 1/2, 1/4 or 1/8 of live view size
+            std::uint32_t block_threshold = 12;  //mean absolute difference per pixel
+            double trigger_fraction = 0.02;      //share of changed blocks that is motion
+            std::uint32_t background_shift = 5;  //background moves 1/2^shift of the difference per frame
+            std::uint32_t warmup_frames = 10;    //background settles before motion is reported
+        };
+
+        struct Result {
+            bool motion;
+            std::uint32_t changed_blocks;
+            std::uint32_t blocks;
+        };
+
+        explicit MotionDetector(const Options &options);
+
+        MotionDetector(const MotionDetector &) = delete;
+        MotionDetector &operator=(const MotionDetector &) = delete;
+
+        //false if frame could not be decoded, background is kept then
+        bool process(const std::uint8_t *jpeg, std::size_t size, Result &result);
+
+        //analyzes luma frame of width * height bytes, change of size restarts warmup
+        Result analyze(const std::uint8_t *luma, std::uint32_t width, std::uint32_t height);
+
+        void reset();
+
+        //false when built without libjpeg, process() fails then
+        static bool decoding_available();
+
+    private:
+        Options _options;
+        LumaDecoder _decoder;
+
+        std::vector<std::uint8_t> _luma;
+        std::uint32_t _width;
+        std::uint32_t _height;
+
+        //8.8 fixed point running average and its integer part compared with frames
+        std::vector<std::uint16_t> _average;
+        std::vector<std::uint8_t> _background;
+        std::vector<std::uint32_t> _sads;
+        std::uint32_t _frames;
+    };
+
+    //sum of absolute differences per BLOCK_SIZE square, blocks are stored row by row;
+    //partial blocks at right and bottom edges are left out
+    void block_sads(const std::uint8_t *frame,
+                    const std::uint8_t *background,
+                    std::uint32_t width,
+                    std::uint32_t height,
+                    std::uint32_t *sads);
+
+    //portable fallback, exposed for benchmarks
+    void block_sads_scalar(const std::uint8_t *frame,
+                           const std::uint8_t *background,
+                           std::uint32_t width,
+                           std::uint32_t height,
+                           std::uint32_t *sads);
+
+    //instruction set picked by block_sads(): "avx2", "sse2" or "scalar"
+    const char *block_sads_isa();
+} //namespace edsdk_w
+
+#endif //MOTION_DETECTOR_HPP
@@ -0,0 +1,91 @@
+#include "motion_trigger.hpp"
+
+namespace edsdk_w {
+    double MotionTrigger::Stats::frames_per_second() const {
+        return elapsed_seconds > 0 ? static_cast<double>(frames) / elapsed_seconds : 0;
+    }
+
+    MotionTrigger::MotionTrigger(EDSDK::Camera &camera, const Options &options) :
+            _camera{camera},
+            _options{options},
+            _detector{options.detector},
+            _running{false},
+            _failed{false},
+            _stats{} {}
+
+    bool MotionTrigger::start() {
+        if (_options.shots == 0 || !MotionDetector::decoding_available() || !_camera.start_live_view()) {
+            _failed = true;
+            return false;
+        }
+
+        _frame.resize(LIVE_VIEW_FRAME_CAPACITY);
+        _detector.reset();
+        _stats = {};
+        _start = _end = Clock::now();
+        _last_shot = _start - _options.cooldown;
+        _running = true;
+        _failed = false;
+        return true;
+    }
+
+    bool MotionTrigger::step() {
+        if (!_running) {
+            return false;
+        }
+        auto now = Clock::now();
+        if (_options.timeout.count() > 0 && now - _start >= _options.timeout) {
+            return _finish(false);
+        }
+
+        //camera has no frame while it starts live view or comes back from a shot
+        std::size_t size = 0;
+        if (!_camera.download_live_view_frame(_frame.data(), _frame.size(), size)) {
+            return true;
+        }
+
+        _stats.frames++;
+        MotionDetector::Result result{};
+        bool decoded = _detector.process(_frame.data(), size, result);
+        _stats.analyze_ms += std::chrono::duration<double, std::milli>(Clock::now() - now).count();
+        if (!decoded) {
+            _stats.decode_failures++;
+            return true;
+        }
+        if (!result.motion) {
+            return true;
+        }
+
+        _stats.motion_frames++;
+        if (now - _last_shot < _options.cooldown) {
+            return true;
+        }
+        if (!_camera.shutter_button()) {
+            return _finish(true);
+        }
+        _last_shot = Clock::now();
+        _detector.reset();
+        if (++_stats.shots == _options.shots) {
+            return _finish(false);
+        }
+        return true;
+    }
+
+    bool MotionTrigger::failed() const {
+        return _failed;
+    }
+
+    MotionTrigger::Stats MotionTrigger::stats() const {
+        auto res = _stats;
+        res.elapsed_seconds = std::chrono::duration<double>((_running ? Clock::now() : _end) - _start).count();
+        return res;
+    }
+
+    bool MotionTrigger::_finish(bool failed) {
+        _camera.stop_live_view();
+        _running = false;
+        _failed = failed;
+        _end = Clock::now();
+        return false;
+    }
+} //namespace edsdk_w
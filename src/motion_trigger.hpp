@@ -0,0 +1,70 @@
+#ifndef MOTION_TRIGGER_HPP
+#define MOTION_TRIGGER_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+#include "edsdk_wrapper.hpp"
+#include "motion_detector.hpp"
+
+namespace edsdk_w {
+    //fires the shutter when something moves in live view, for camera traps
+    //
+    //every step downloads one live view frame and runs it through the motion detector;
+    //after a shot the detector restarts, so the camera settling back into live view
+    //does not trigger the next one
+    class MotionTrigger {
+    public:
+        struct Options {
+            MotionDetector::Options detector;
+            std::uint32_t shots = 1;
+            std::chrono::milliseconds cooldown{2000};
+            std::chrono::milliseconds timeout{0}; //0 waits for all shots
+        };
+
+        struct Stats {
+            std::uint64_t frames;
+            std::uint64_t decode_failures;
+            std::uint64_t motion_frames;
+            std::uint32_t shots;
+            double analyze_ms;      //decode and detection, total
+            double elapsed_seconds;
+            [[nodiscard]] double frames_per_second() const;
+        };
+
+        MotionTrigger(EDSDK::Camera &camera, const Options &options);
+
+        MotionTrigger(const MotionTrigger &) = delete;
+        MotionTrigger &operator=(const MotionTrigger &) = delete;
+
+        //turns live view on
+        bool start();
+
+        //takes and analyzes one frame, returns false when finished or failed;
+        //must be called from the thread pumping EDSDK::events()
+        bool step();
+
+        [[nodiscard]] bool failed() const;
+
+        [[nodiscard]] Stats stats() const;
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        bool _finish(bool failed);
+
+        EDSDK::Camera &_camera;
+        Options _options;
+        MotionDetector _detector;
+        std::vector<std::uint8_t> _frame;
+
+        bool _running;
+        bool _failed;
+        Clock::time_point _start;
+        Clock::time_point _end;
+        Clock::time_point _last_shot;
+        Stats _stats;
+    };
+} //namespace edsdk_w
+
+#endif //MOTION_TRIGGER_HPP
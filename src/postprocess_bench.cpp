@@ -0,0 +1,153 @@
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "crc32c.hpp"
+#include "download_postprocessor.hpp"
+#include "embedded_preview.hpp"
+
+//throughput of checksum and preview extraction stage:
+//postprocess_bench [threads, 0 = one per cpu] [files...]
+//without files synthetic 24 MB CR2-like captures with a 2 MB embedded preview are used
+namespace {
+    using clock = std::chrono::steady_clock;
+
+    void put_le16(std::vector<std::uint8_t> &data, std::size_t at, std::uint16_t value) {
+        data[at] = value & 0xff;
+        data[at + 1] = value >> 8;
+    }
+
+    void put_le32(std::vector<std::uint8_t> &data, std::size_t at, std::uint32_t value) {
+        for (int i = 0; i < 4; i++) {
+            data[at + i] = (value >> (8 * i)) & 0xff;
+        }
+    }
+
+    //little-endian TIFF with IFD0 strip pointing at a jpeg, as CR2 stores its full size preview
+    std::vector<std::uint8_t> synthetic_capture(std::size_t size, std::size_t preview_size, std::uint8_t seed) {
+        std::vector<std::uint8_t> data(size);
+        for (std::size_t i = 0; i < size; i++) {
+            data[i] = static_cast<std::uint8_t>(i * 131 + seed);
+        }
+
+        const std::size_t ifd = 16, preview = 4096;
+        data[0] = 'I';
+        data[1] = 'I';
+        put_le16(data, 2, 42);
+        put_le32(data, 4, ifd);
+        put_le16(data, ifd, 2);
+        put_le16(data, ifd + 2, 0x0111);
+        put_le16(data, ifd + 4, 4);
+        put_le32(data, ifd + 6, 1);
+        put_le32(data, ifd + 10, preview);
+        put_le16(data, ifd + 14, 0x0117);
+        put_le16(data, ifd + 16, 4);
+        put_le32(data, ifd + 18, 1);
+        put_le32(data, ifd + 22, preview_size);
+        put_le32(data, ifd + 26, 0);
+        data[preview] = 0xff;
+        data[preview + 1] = 0xd8;
+        return data;
+    }
+
+    //headers whose offsets point past the end or wrap when added in 32 bits, none may yield a preview
+    bool rejects_malformed() {
+        const std::uint32_t ifd_offsets[] = {0xfffffffe, 0xffffffff, 0xfffffff0, 12, 8};
+        for (auto ifd : ifd_offsets) {
+            std::vector<std::uint8_t> data(12);
+            data[0] = 'I';
+            data[1] = 'I';
+            put_le16(data, 2, 42);
+            put_le32(data, 4, ifd);
+            //entry count far beyond the data when the ifd lands inside it
+            put_le16(data, 8, 0xffff);
+            if (edsdk_w::find_embedded_preview(data.data(), data.size())) {
+                std::cerr << "malformed TIFF with ifd " << ifd << " yields a preview" << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    double mb_per_s(std::uint64_t bytes, double seconds) {
+        return seconds > 0 ? static_cast<double>(bytes) / (1024 * 1024) / seconds : 0.0;
+    }
+}
+
+int main(int argc, char **argv) {
+    std::size_t threads = argc > 1 ? std::stoul(argv[1]) : 0;
+    if (!rejects_malformed()) {
+        return 1;
+    }
+
+    std::vector<std::pair<std::string, std::vector<std::uint8_t>>> files{};
+    auto directory = std::filesystem::temp_directory_path() / "postprocess_bench";
+    std::filesystem::create_directories(directory);
+
+    if (argc > 2) {
+        for (int i = 2; i < argc; i++) {
+            std::ifstream file{argv[i], std::ios::binary};
+            std::vector<std::uint8_t> data{std::istreambuf_iterator<char>{file}, {}};
+            files.emplace_back((directory / std::filesystem::path(argv[i]).filename()).string(), std::move(data));
+        }
+    } else {
+        for (int i = 0; i < 32; i++) {
+            auto name = "IMG_" + std::to_string(1000 + i) + ".CR2";
+            files.emplace_back((directory / name).string(), synthetic_capture(24 * 1024 * 1024, 2 * 1024 * 1024, i));
+        }
+    }
+
+    std::uint64_t total_bytes = 0;
+    for (const auto &file : files) {
+        total_bytes += file.second.size();
+    }
+
+    //single thread checksum, both implementations
+    std::uint32_t scalar_crc = 0, crc = 0;
+    auto start = clock::now();
+    for (const auto &file : files) {
+        scalar_crc ^= utils::crc32c_scalar(file.second.data(), file.second.size());
+    }
+    double scalar_s = std::chrono::duration<double>(clock::now() - start).count();
+
+    start = clock::now();
+    for (const auto &file : files) {
+        crc ^= utils::crc32c(file.second.data(), file.second.size());
+    }
+    double hardware_s = std::chrono::duration<double>(clock::now() - start).count();
+
+    std::cout << std::fixed << std::setprecision(1)
+              << "crc32c scalar " << mb_per_s(total_bytes, scalar_s) << " MB/s, "
+              << (utils::crc32c_hardware_available() ? "sse4.2 " : "dispatch (no sse4.2) ")
+              << mb_per_s(total_bytes, hardware_s) << " MB/s"
+              << (crc == scalar_crc ? "" : ", RESULTS DIFFER") << std::endl;
+
+    edsdk_w::DownloadPostProcessor processor{threads, static_cast<std::size_t>(-1)};
+    std::uint64_t previews = 0;
+    processor.set_listener([&previews](const edsdk_w::DownloadPostProcessor::Result &result) {
+        previews += !result.preview_path.empty();
+    });
+
+    start = clock::now();
+    for (auto &file : files) {
+        processor.submit(file.first, std::move(file.second));
+    }
+    auto submitted_s = std::chrono::duration<double>(clock::now() - start).count();
+    processor.wait_idle();
+    double elapsed_s = std::chrono::duration<double>(clock::now() - start).count();
+
+    auto stats = processor.stats();
+    std::cout << "stage on " << processor.thread_count() << " threads: " << stats.submitted << " files, "
+              << mb_per_s(total_bytes, elapsed_s) << " MB/s overall, "
+              << "submit " << submitted_s * 1e6 / static_cast<double>(files.size()) << " us per file" << std::endl
+              << "  checksum " << mb_per_s(stats.hash.bytes, static_cast<double>(stats.hash.busy_ns) / 1e9) << " MB/s per thread" << std::endl
+              << "  preview " << mb_per_s(stats.preview.bytes, static_cast<double>(stats.preview.busy_ns) / 1e9) << " MB/s per thread, "
+              << stats.preview.files << " files, " << previews << " previews written" << std::endl
+              << "  avg submit to done " << static_cast<double>(stats.total_ns) / 1e6 / static_cast<double>(stats.submitted) << " ms" << std::endl;
+
+    std::filesystem::remove_all(directory);
+    return 0;
+}
@@ -0,0 +1,144 @@
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "property_traits.hpp"
+
+//cost of routing a property change event to its storage field:
+//property_dispatch_bench [events]
+#if defined(_MSC_VER)
+#define BENCH_NOINLINE __declspec(noinline)
+#else
+#define BENCH_NOINLINE __attribute__((noinline))
+#endif
+
+namespace {
+    using clock = std::chrono::steady_clock;
+    using namespace edsdk_w;
+
+    //stands in for EdsGetPropertyData, kept out of line so both paths pay the same call
+    template <typename T>
+    BENCH_NOINLINE T fetch(EdsPropertyID prop_id) {
+        if constexpr (std::is_same_v<T, std::string>) {
+            return prop_id == kEdsPropID_LensName ? "EF50mm f/1.8 STM" : "";
+        } else {
+            return prop_id * 2654435761u;
+        }
+    }
+
+    //per-property switch the camera wrapper used before property traits
+    struct SwitchStorage {
+        std::uint32_t image_quality, ae_mode, af_mode;
+        std::string lens_name;
+        std::uint32_t white_balance, color_temperature, color_space, drive_mode, metering_mode, iso, av, tv, exposure_compensation;
+
+        bool on_changed(EdsPropertyID prop_id) {
+            switch (prop_id) {
+                case kEdsPropID_ImageQuality: image_quality = fetch<std::uint32_t>(prop_id); break;
+                case kEdsPropID_AEMode: ae_mode = fetch<std::uint32_t>(prop_id); break;
+                case kEdsPropID_AFMode: af_mode = fetch<std::uint32_t>(prop_id); break;
+                case kEdsPropID_LensName: lens_name = fetch<std::string>(prop_id); break;
+                case kEdsPropID_WhiteBalance: white_balance = fetch<std::uint32_t>(prop_id); break;
+                case kEdsPropID_ColorTemperature: color_temperature = fetch<std::uint32_t>(prop_id); break;
+                case kEdsPropID_ColorSpace: color_space = fetch<std::uint32_t>(prop_id); break;
+                case kEdsPropID_DriveMode: drive_mode = fetch<std::uint32_t>(prop_id); break;
+                case kEdsPropID_MeteringMode: metering_mode = fetch<std::uint32_t>(prop_id); break;
+                case kEdsPropID_ISOSpeed: iso = fetch<std::uint32_t>(prop_id); break;
+                case kEdsPropID_Av: av = fetch<std::uint32_t>(prop_id); break;
+                case kEdsPropID_Tv: tv = fetch<std::uint32_t>(prop_id); break;
+                case kEdsPropID_ExposureCompensation: exposure_compensation = fetch<std::uint32_t>(prop_id); break;
+                default: return false;
+            }
+            return true;
+        }
+
+        std::uint32_t sum() const {
+            return image_quality + ae_mode + af_mode + white_balance + color_temperature + color_space +
+                   drive_mode + metering_mode + iso + av + tv + exposure_compensation + lens_name.size();
+        }
+    };
+
+    //slot lookup and a refresher table generated from property traits
+    struct TableStorage {
+        property_table::Storage properties{};
+
+        template <Prop P>
+        void refresh() {
+            std::get<property_table::slot(P)>(properties) = fetch<typename PropertyTraits<P>::type>(PropertyTraits<P>::id);
+        }
+
+        template <std::size_t... I>
+        static constexpr auto make_refreshers(std::index_sequence<I...>) {
+            return std::array<void (TableStorage::*)(), sizeof...(I)>{&TableStorage::refresh<static_cast<Prop>(I)>...};
+        }
+
+        bool on_changed(EdsPropertyID prop_id) {
+            constexpr auto refreshers = make_refreshers(std::make_index_sequence<PROPERTY_COUNT>{});
+
+            auto slot = property_table::slot_of(prop_id);
+            if (!slot) {
+                return false;
+            }
+            (this->*refreshers[*slot])();
+            return true;
+        }
+
+        template <std::size_t... I>
+        std::uint32_t sum(std::index_sequence<I...>) const {
+            std::uint32_t res = 0;
+            ((res += [this] {
+                const auto &value = std::get<I>(properties);
+                if constexpr (std::is_same_v<std::decay_t<decltype(value)>, std::string>) {
+                    return static_cast<std::uint32_t>(value.size());
+                } else {
+                    return value;
+                }
+            }()), ...);
+            return res;
+        }
+    };
+
+    template <typename Storage>
+    void run(const char *name, const std::vector<EdsPropertyID> &events, std::uint32_t (*sum)(const Storage &)) {
+        Storage storage{};
+        std::size_t handled = 0;
+
+        auto start = clock::now();
+        for (auto prop_id : events) {
+            handled += storage.on_changed(prop_id);
+        }
+        double elapsed_ns = std::chrono::duration<double, std::nano>(clock::now() - start).count();
+
+        std::cout << std::fixed << std::setprecision(2)
+                  << name << ": " << elapsed_ns / static_cast<double>(events.size()) << " ns/event"
+                  << ", handled " << handled << "/" << events.size()
+                  << " (checksum " << sum(storage) << ")" << std::endl;
+    }
+}
+
+int main(int argc, char **argv) {
+    std::size_t count = argc > 1 ? std::stoul(argv[1]) : 10000000;
+
+    //two of the picked ids are properties the wrapper does not track
+    std::vector<EdsPropertyID> ids(property_table::IDS.begin(), property_table::IDS.end());
+    ids.push_back(kEdsPropID_BatteryLevel);
+    ids.push_back(kEdsPropID_Evf_Mode);
+
+    std::mt19937 rng{42};
+    std::uniform_int_distribution<std::size_t> pick{0, ids.size() - 1};
+    std::vector<EdsPropertyID> events(count);
+    for (auto &prop_id : events) {
+        prop_id = ids[pick(rng)];
+    }
+
+    for (int round = 0; round < 2; round++) {
+        run<SwitchStorage>("switch", events, [](const SwitchStorage &s) { return s.sum(); });
+        run<TableStorage>("traits table", events, [](const TableStorage &s) {
+            return s.sum(std::make_index_sequence<PROPERTY_COUNT>{});
+        });
+    }
+
+    return 0;
+}
@@ -0,0 +1,70 @@
+#include "property_reconciler.hpp"
+
+#include <algorithm>
+
+namespace edsdk_w {
+    PropertyReconciler::PropertyReconciler(const Options &options) :
+            _options{options},
+            _due{},
+            _tokens{0},
+            _refilled{Clock::now()},
+            _stats{} {
+        _intervals.fill(_options.min_interval);
+        _tokens = std::max<double>(_options.read_cost_bytes, _options.bytes_per_second / 4.0);
+    }
+
+    void PropertyReconciler::on_event(std::size_t slot, Clock::time_point now) {
+        //events work for this property, cache is fresh without reading it
+        _intervals[slot] = std::min(_intervals[slot] * 2, _options.max_interval);
+        _due[slot] = now + _intervals[slot];
+    }
+
+    std::optional<std::size_t> PropertyReconciler::next_due(Clock::time_point now) {
+        _refill(now);
+
+        auto it = std::min_element(_due.begin(), _due.end());
+        if (*it > now) {
+            return std::nullopt;
+        }
+        if (_tokens < _options.read_cost_bytes) {
+            _stats.over_budget++;
+            return std::nullopt;
+        }
+
+        _tokens -= _options.read_cost_bytes;
+        _stats.reads++;
+        return static_cast<std::size_t>(it - _due.begin());
+    }
+
+    void PropertyReconciler::on_read(std::size_t slot, bool stale, Clock::time_point now) {
+        if (stale) {
+            _stats.stale++;
+            _intervals[slot] = _options.min_interval;
+        } else {
+            _intervals[slot] = std::min(_intervals[slot] * 3 / 2, _options.max_interval);
+        }
+        _due[slot] = now + _intervals[slot];
+    }
+
+    void PropertyReconciler::on_busy(Clock::time_point now) {
+        if (*std::min_element(_due.begin(), _due.end()) <= now) {
+            _stats.busy++;
+        }
+    }
+
+    std::chrono::milliseconds PropertyReconciler::interval(std::size_t slot) const {
+        return _intervals[slot];
+    }
+
+    PropertyReconciler::Stats PropertyReconciler::stats() const {
+        return _stats;
+    }
+
+    void PropertyReconciler::_refill(Clock::time_point now) {
+        //bucket holds a quarter second of budget, so reads after idle time come in small bursts
+        auto capacity = std::max<double>(_options.read_cost_bytes, _options.bytes_per_second / 4.0);
+        auto elapsed = std::chrono::duration<double>(now - _refilled).count();
+        _tokens = std::min(capacity, _tokens + elapsed * _options.bytes_per_second);
+        _refilled = now;
+    }
+} //namespace edsdk_w
@@ -0,0 +1,64 @@
+#ifndef PROPERTY_RECONCILER_HPP
+#define PROPERTY_RECONCILER_HPP
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include "property_traits.hpp"
+
+namespace edsdk_w {
+    //schedules re-reads of cached properties for bodies that drop change events
+    //
+    //each property has its own interval: a read that finds the cache stale drops it to minimum,
+    //a read that confirms the cache or an arriving event stretches it; reads are paid for from
+    //a byte budget so polling never takes a noticeable share of USB bandwidth
+    class PropertyReconciler {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        struct Options {
+            std::chrono::milliseconds min_interval{250};
+            std::chrono::milliseconds max_interval{10000};
+            std::uint32_t bytes_per_second = 16 * 1024;
+            std::uint32_t read_cost_bytes = 512; //size and data transactions with their headers
+        };
+
+        struct Stats {
+            std::uint64_t reads;
+            std::uint64_t stale;          //reads that found a change the camera never reported
+            std::uint64_t over_budget;    //due reads postponed by bandwidth budget
+            std::uint64_t busy;           //due reads postponed by captures in flight
+        };
+
+        explicit PropertyReconciler(const Options &options);
+
+        //change event for property arrived and was applied to the cache
+        void on_event(std::size_t slot, Clock::time_point now);
+
+        //slot whose read is due and fits the budget, budget is charged for it
+        std::optional<std::size_t> next_due(Clock::time_point now);
+
+        void on_read(std::size_t slot, bool stale, Clock::time_point now);
+
+        //polling is postponed, e.g. while captures are in flight
+        void on_busy(Clock::time_point now);
+
+        [[nodiscard]] std::chrono::milliseconds interval(std::size_t slot) const;
+
+        [[nodiscard]] Stats stats() const;
+
+    private:
+        void _refill(Clock::time_point now);
+
+        Options _options;
+        std::array<std::chrono::milliseconds, PROPERTY_COUNT> _intervals;
+        std::array<Clock::time_point, PROPERTY_COUNT> _due;
+
+        double _tokens;
+        Clock::time_point _refilled;
+        Stats _stats;
+    };
+} //namespace edsdk_w
+
+#endif //PROPERTY_RECONCILER_HPP
@@ -0,0 +1,173 @@
+#ifndef PROPERTY_TRAITS_HPP
+#define PROPERTY_TRAITS_HPP
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "EDSDKTypes.h"
+
+namespace edsdk_w {
+    namespace utils {
+        std::string explain_prop_value_image_quality(std::uint32_t value);
+        std::string explain_prop_value_white_balance(std::uint32_t value);
+        std::string explain_prop_value_color_temperature(std::uint32_t value);
+        std::string explain_prop_value_color_space(std::uint32_t value);
+        std::string explain_prop_value_ae_mode(std::uint32_t value);
+        std::string explain_prop_value_drive_mode(std::uint32_t value);
+        std::string explain_prop_value_iso_speed(std::uint32_t value);
+        std::string explain_prop_value_metering_mode(std::uint32_t value);
+        std::string explain_prop_value_af_mode(std::uint32_t value);
+        std::string explain_prop_value_av(std::uint32_t value);
+        std::string explain_prop_value_tv(std::uint32_t value);
+        std::string explain_prop_value_exposure_compensation(std::uint32_t value);
+        std::string explain_prop_value_text(std::string value);
+    } //namespace edsdk_w::utils
+
+    //value of enumerator is the slot of property in camera storage
+    enum class Prop : std::size_t {
+        //read-only
+        ImageQuality,
+        AEMode,
+        AFMode,
+        LensName,
+
+        //settable
+        WhiteBalance,
+        ColorTemperature,
+        ColorSpace,
+        DriveMode,
+        MeteringMode,
+        ISO,
+        Av,
+        Tv,
+        ExposureCompensation,
+
+        Count
+    };
+
+    constexpr std::size_t PROPERTY_COUNT = static_cast<std::size_t>(Prop::Count);
+
+    enum class PropertyAccess {
+        ReadOnly,
+        Settable
+    };
+
+    template <EdsPropertyID Id, typename T, PropertyAccess Access, std::string (*Explain)(T)>
+    struct PropertyTraitsBase {
+        static constexpr EdsPropertyID id = Id;
+        using type = T;
+        static constexpr bool settable = Access == PropertyAccess::Settable;
+
+        static std::string explain(const T &value) {
+            return Explain(value);
+        }
+    };
+
+    template <Prop P>
+    struct PropertyTraits;
+
+    template <> struct PropertyTraits<Prop::ImageQuality> : PropertyTraitsBase<kEdsPropID_ImageQuality, std::uint32_t, PropertyAccess::ReadOnly, utils::explain_prop_value_image_quality> {};
+    template <> struct PropertyTraits<Prop::AEMode> : PropertyTraitsBase<kEdsPropID_AEMode, std::uint32_t, PropertyAccess::ReadOnly, utils::explain_prop_value_ae_mode> {};
+    template <> struct PropertyTraits<Prop::AFMode> : PropertyTraitsBase<kEdsPropID_AFMode, std::uint32_t, PropertyAccess::ReadOnly, utils::explain_prop_value_af_mode> {};
+    template <> struct PropertyTraits<Prop::LensName> : PropertyTraitsBase<kEdsPropID_LensName, std::string, PropertyAccess::ReadOnly, utils::explain_prop_value_text> {};
+
+    template <> struct PropertyTraits<Prop::WhiteBalance> : PropertyTraitsBase<kEdsPropID_WhiteBalance, std::uint32_t, PropertyAccess::Settable, utils::explain_prop_value_white_balance> {};
+    template <> struct PropertyTraits<Prop::ColorTemperature> : PropertyTraitsBase<kEdsPropID_ColorTemperature, std::uint32_t, PropertyAccess::Settable, utils::explain_prop_value_color_temperature> {};
+    template <> struct PropertyTraits<Prop::ColorSpace> : PropertyTraitsBase<kEdsPropID_ColorSpace, std::uint32_t, PropertyAccess::Settable, utils::explain_prop_value_color_space> {};
+    template <> struct PropertyTraits<Prop::DriveMode> : PropertyTraitsBase<kEdsPropID_DriveMode, std::uint32_t, PropertyAccess::Settable, utils::explain_prop_value_drive_mode> {};
+    template <> struct PropertyTraits<Prop::MeteringMode> : PropertyTraitsBase<kEdsPropID_MeteringMode, std::uint32_t, PropertyAccess::Settable, utils::explain_prop_value_metering_mode> {};
+    template <> struct PropertyTraits<Prop::ISO> : PropertyTraitsBase<kEdsPropID_ISOSpeed, std::uint32_t, PropertyAccess::Settable, utils::explain_prop_value_iso_speed> {};
+    template <> struct PropertyTraits<Prop::Av> : PropertyTraitsBase<kEdsPropID_Av, std::uint32_t, PropertyAccess::Settable, utils::explain_prop_value_av> {};
+    template <> struct PropertyTraits<Prop::Tv> : PropertyTraitsBase<kEdsPropID_Tv, std::uint32_t, PropertyAccess::Settable, utils::explain_prop_value_tv> {};
+    template <> struct PropertyTraits<Prop::ExposureCompensation> : PropertyTraitsBase<kEdsPropID_ExposureCompensation, std::uint32_t, PropertyAccess::Settable, utils::explain_prop_value_exposure_compensation> {};
+
+    namespace property_table {
+        constexpr std::size_t slot(Prop p) {
+            return static_cast<std::size_t>(p);
+        }
+
+        template <Prop P>
+        constexpr bool is_numeric = std::is_same_v<typename PropertyTraits<P>::type, std::uint32_t>;
+
+        template <std::size_t... I>
+        auto make_storage(std::index_sequence<I...>) -> std::tuple<typename PropertyTraits<static_cast<Prop>(I)>::type...>;
+
+        //one field per property, std::get<slot> compiles to plain member access
+        using Storage = decltype(make_storage(std::make_index_sequence<PROPERTY_COUNT>{}));
+
+        template <std::size_t... I>
+        constexpr std::array<EdsPropertyID, PROPERTY_COUNT> make_ids(std::index_sequence<I...>) {
+            return {PropertyTraits<static_cast<Prop>(I)>::id...};
+        }
+
+        template <std::size_t... I>
+        constexpr std::array<bool, PROPERTY_COUNT> make_settable(std::index_sequence<I...>) {
+            return {PropertyTraits<static_cast<Prop>(I)>::settable...};
+        }
+
+        constexpr auto IDS = make_ids(std::make_index_sequence<PROPERTY_COUNT>{});
+        constexpr auto SETTABLE = make_settable(std::make_index_sequence<PROPERTY_COUNT>{});
+
+        constexpr EdsPropertyID min_id() {
+            EdsPropertyID res = IDS[0];
+            for (auto id : IDS) {
+                res = id < res ? id : res;
+            }
+            return res;
+        }
+
+        constexpr EdsPropertyID max_id() {
+            EdsPropertyID res = IDS[0];
+            for (auto id : IDS) {
+                res = id > res ? id : res;
+            }
+            return res;
+        }
+
+        constexpr EdsPropertyID MIN_ID = min_id();
+        constexpr std::size_t ID_SPAN = max_id() - MIN_ID + 1;
+        constexpr std::uint8_t NO_SLOT = 0xff;
+
+        //tracked ids are clustered in a few hundred values, so id to slot is a single indexed load
+        static_assert(ID_SPAN <= 4096 && PROPERTY_COUNT < NO_SLOT, "property ids are too sparse for a direct slot map");
+
+        constexpr std::array<std::uint8_t, ID_SPAN> make_slot_map() {
+            std::array<std::uint8_t, ID_SPAN> res{};
+            for (auto &slot : res) {
+                slot = NO_SLOT;
+            }
+            for (std::size_t i = 0; i < PROPERTY_COUNT; i++) {
+                res[IDS[i] - MIN_ID] = static_cast<std::uint8_t>(i);
+            }
+            return res;
+        }
+
+        constexpr auto SLOT_MAP = make_slot_map();
+
+        constexpr bool ids_unique() {
+            std::size_t mapped = 0;
+            for (auto slot : SLOT_MAP) {
+                mapped += slot != NO_SLOT;
+            }
+            return mapped == PROPERTY_COUNT;
+        }
+
+        static_assert(ids_unique(), "property id is listed twice in property traits");
+
+        constexpr std::optional<std::size_t> slot_of(EdsPropertyID id) {
+            auto offset = id - MIN_ID;
+            if (offset >= ID_SPAN || SLOT_MAP[offset] == NO_SLOT) {
+                return std::nullopt;
+            }
+            return SLOT_MAP[offset];
+        }
+
+        static_assert(slot_of(kEdsPropID_Tv) == slot(Prop::Tv), "id to slot map is broken");
+    } //namespace edsdk_w::property_table
+} //namespace edsdk_w
+
+#endif //PROPERTY_TRAITS_HPP
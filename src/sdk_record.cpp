@@ -0,0 +1,512 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+#include <dlfcn.h>
+#include <EDSDK.h>
+#include <EDSDKErrors.h>
+#include "sdk_trace.hpp"
+
+//record backend: defines the SDK functions the wrapper calls, forwards them to the real SDK loaded
+//at run time and writes every camera side call and callback into the trace
+namespace {
+    using namespace edsdk_w::sdk_trace;
+    using Clock = std::chrono::steady_clock;
+
+    struct Handler {
+        std::uint32_t camera;
+        EdsPropertyEventHandler property;
+        EdsObjectEventHandler object;
+        EdsStateEventHandler state;
+        EdsVoid *context;
+    };
+
+    struct Recorder {
+        TraceWriter writer;
+        Clock::time_point start = Clock::now();
+        bool keep_frames = false;
+
+        std::mutex mutex;
+        std::unordered_map<EdsBaseRef, std::uint32_t> ids;
+        std::uint32_t next_id = 1;
+        std::unordered_map<EdsBaseRef, EdsStreamRef> evf_streams;
+        std::unordered_map<EdsStreamRef, bool> fixed_streams;
+        //context of trampolines, nodes never move
+        std::map<std::tuple<EdsBaseRef, Op, EdsUInt32>, Handler> handlers;
+    };
+
+    Recorder &recorder() {
+        static Recorder instance{};
+        return instance;
+    }
+
+    void *sdk_library() {
+        //deep binding keeps calls inside the real SDK away from the functions defined here
+        static void *library = [] {
+            auto path = std::getenv("EDSW_SDK_LIBRARY");
+            auto res = dlopen(path ? path : EDSW_SDK_LIBRARY, RTLD_NOW | RTLD_LOCAL | RTLD_DEEPBIND);
+            if (!res) {
+                std::cerr << "sdk record: " << dlerror() << std::endl;
+            }
+            return res;
+        }();
+        return library;
+    }
+
+    template <typename F>
+    F resolve(const char *name) {
+        auto library = sdk_library();
+        auto res = library ? reinterpret_cast<F>(dlsym(library, name)) : nullptr;
+        if (!res) {
+            std::cerr << "sdk record: " << name << " is missing in the real SDK" << std::endl;
+            std::abort();
+        }
+        return res;
+    }
+
+    std::uint64_t elapsed_us(Clock::time_point at) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(at - recorder().start).count();
+    }
+
+    std::uint32_t id_of(EdsBaseRef ref) {
+        if (!ref) {
+            return 0;
+        }
+        auto &rec = recorder();
+        std::lock_guard<std::mutex> lock{rec.mutex};
+        auto [it, inserted] = rec.ids.try_emplace(ref, rec.next_id);
+        if (inserted) {
+            rec.next_id++;
+        }
+        return it->second;
+    }
+
+    //a released address may come back for another object
+    void forget(EdsBaseRef ref) {
+        auto &rec = recorder();
+        std::lock_guard<std::mutex> lock{rec.mutex};
+        rec.ids.erase(ref);
+        rec.evf_streams.erase(ref);
+        rec.fixed_streams.erase(ref);
+    }
+
+    //timing, result and payload are filled when the call has run
+    Record make_record(Op op,
+                       std::uint32_t ref = 0,
+                       std::uint32_t arg0 = 0,
+                       std::uint32_t arg1 = 0,
+                       std::uint32_t out_ref = 0) {
+        Record res{};
+        res.op = op;
+        res.ref = ref;
+        res.arg0 = arg0;
+        res.arg1 = arg1;
+        res.out_ref = out_ref;
+        return res;
+    }
+
+    //runs the real call and fills timing and result of record
+    template <typename Call>
+    EdsError timed(Record &record, Call &&call) {
+        auto begin = Clock::now();
+        EdsError err = call();
+        auto end = Clock::now();
+        record.start_us = elapsed_us(begin);
+        record.duration_us = static_cast<std::uint32_t>(
+                std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count());
+        record.result = err;
+        return err;
+    }
+
+    //out data of a failed call may be uninitialized and is never traced, nor read to build a payload
+    void write(Record record, const void *payload = nullptr, std::size_t size = 0) {
+        record.payload_size = payload && record.result == EDS_ERR_OK ? static_cast<std::uint32_t>(size) : 0;
+        recorder().writer.write(record, payload);
+    }
+
+    void write_callback(Record record) {
+        record.start_us = elapsed_us(Clock::now());
+        recorder().writer.write(record);
+    }
+
+    EdsError EDSCALLBACK property_trampoline(EdsPropertyEvent event,
+                                             EdsPropertyID prop_id,
+                                             EdsUInt32 param,
+                                             EdsVoid *context) {
+        auto handler = static_cast<Handler*>(context);
+        write_callback(make_record(Op::PropertyEvent, handler->camera, event, prop_id, param));
+        return handler->property(event, prop_id, param, handler->context);
+    }
+
+    EdsError EDSCALLBACK object_trampoline(EdsObjectEvent event, EdsBaseRef object, EdsVoid *context) {
+        auto handler = static_cast<Handler*>(context);
+        write_callback(make_record(Op::ObjectEvent, handler->camera, event, 0, id_of(object)));
+        return handler->object(event, object, handler->context);
+    }
+
+    EdsError EDSCALLBACK state_trampoline(EdsStateEvent event, EdsUInt32 data, EdsVoid *context) {
+        auto handler = static_cast<Handler*>(context);
+        write_callback(make_record(Op::StateEvent, handler->camera, event, data));
+        return handler->state(event, data, handler->context);
+    }
+
+    Handler &handler_slot(EdsBaseRef camera, Op op, EdsUInt32 event, EdsVoid *context) {
+        auto &rec = recorder();
+        auto camera_id = id_of(camera);
+        std::lock_guard<std::mutex> lock{rec.mutex};
+        auto &res = rec.handlers[{camera, op, event}];
+        res = {camera_id, nullptr, nullptr, nullptr, context};
+        return res;
+    }
+}
+
+extern "C" {
+EdsError EDSAPI EdsInitializeSDK() {
+    static auto real = resolve<decltype(&EdsInitializeSDK)>("EdsInitializeSDK");
+    auto &rec = recorder();
+    auto path = std::getenv("EDSW_SDK_TRACE");
+    auto frames = std::getenv("EDSW_SDK_FRAMES");
+    rec.keep_frames = frames && std::strcmp(frames, "1") == 0;
+    rec.start = Clock::now();
+    if (!rec.writer.open(path ? path : "edsdk.trace")) {
+        std::cerr << "sdk record: cannot create trace " << (path ? path : "edsdk.trace") << std::endl;
+        return EDS_ERR_INTERNAL_ERROR;
+    }
+
+    auto record = make_record(Op::InitializeSDK);
+    timed(record, real);
+    write(record);
+    return record.result;
+}
+
+EdsError EDSAPI EdsTerminateSDK() {
+    static auto real = resolve<decltype(&EdsTerminateSDK)>("EdsTerminateSDK");
+    auto record = make_record(Op::TerminateSDK);
+    timed(record, real);
+    write(record);
+    recorder().writer.close();
+    return record.result;
+}
+
+EdsUInt32 EDSAPI EdsRelease(EdsBaseRef ref) {
+    static auto real = resolve<decltype(&EdsRelease)>("EdsRelease");
+    auto res = real(ref);
+    if (res == 0) {
+        forget(ref);
+    }
+    return res;
+}
+
+EdsError EDSAPI EdsGetCameraList(EdsCameraListRef *list) {
+    static auto real = resolve<decltype(&EdsGetCameraList)>("EdsGetCameraList");
+    auto record = make_record(Op::GetCameraList);
+    timed(record, [&] { return real(list); });
+    record.out_ref = record.result == EDS_ERR_OK ? id_of(*list) : 0;
+    write(record);
+    return record.result;
+}
+
+EdsError EDSAPI EdsGetChildCount(EdsBaseRef ref, EdsUInt32 *count) {
+    static auto real = resolve<decltype(&EdsGetChildCount)>("EdsGetChildCount");
+    auto record = make_record(Op::GetChildCount, id_of(ref));
+    timed(record, [&] { return real(ref, count); });
+    write(record, count, sizeof(*count));
+    return record.result;
+}
+
+EdsError EDSAPI EdsGetChildAtIndex(EdsBaseRef ref, EdsInt32 index, EdsBaseRef *child) {
+    static auto real = resolve<decltype(&EdsGetChildAtIndex)>("EdsGetChildAtIndex");
+    auto record = make_record(Op::GetChildAtIndex, id_of(ref), static_cast<std::uint32_t>(index));
+    timed(record, [&] { return real(ref, index, child); });
+    record.out_ref = record.result == EDS_ERR_OK ? id_of(*child) : 0;
+    write(record);
+    return record.result;
+}
+
+EdsError EDSAPI EdsGetDeviceInfo(EdsCameraRef camera, EdsDeviceInfo *info) {
+    static auto real = resolve<decltype(&EdsGetDeviceInfo)>("EdsGetDeviceInfo");
+    auto record = make_record(Op::GetDeviceInfo, id_of(camera));
+    timed(record, [&] { return real(camera, info); });
+    write(record, info, sizeof(*info));
+    return record.result;
+}
+
+EdsError EDSAPI EdsGetPropertySize(EdsBaseRef ref,
+                                   EdsPropertyID prop_id,
+                                   EdsInt32 param,
+                                   EdsDataType *data_type,
+                                   EdsUInt32 *size) {
+    static auto real = resolve<decltype(&EdsGetPropertySize)>("EdsGetPropertySize");
+    auto record = make_record(Op::GetPropertySize, id_of(ref), prop_id, static_cast<std::uint32_t>(param));
+    timed(record, [&] { return real(ref, prop_id, param, data_type, size); });
+    if (record.result != EDS_ERR_OK) {
+        write(record);
+        return record.result;
+    }
+    std::uint32_t payload[2] = {static_cast<std::uint32_t>(*data_type), *size};
+    write(record, payload, sizeof(payload));
+    return record.result;
+}
+
+EdsError EDSAPI EdsGetPropertyData(EdsBaseRef ref,
+                                   EdsPropertyID prop_id,
+                                   EdsInt32 param,
+                                   EdsUInt32 size,
+                                   EdsVoid *data) {
+    static auto real = resolve<decltype(&EdsGetPropertyData)>("EdsGetPropertyData");
+    auto record = make_record(Op::GetPropertyData, id_of(ref), prop_id, static_cast<std::uint32_t>(param));
+    timed(record, [&] { return real(ref, prop_id, param, size, data); });
+    write(record, data, size);
+    return record.result;
+}
+
+EdsError EDSAPI EdsSetPropertyData(EdsBaseRef ref,
+                                   EdsPropertyID prop_id,
+                                   EdsInt32 param,
+                                   EdsUInt32 size,
+                                   const EdsVoid *data) {
+    static auto real = resolve<decltype(&EdsSetPropertyData)>("EdsSetPropertyData");
+    auto record = make_record(Op::SetPropertyData, id_of(ref), prop_id, static_cast<std::uint32_t>(param));
+    timed(record, [&] { return real(ref, prop_id, param, size, data); });
+    write(record, data, size);
+    return record.result;
+}
+
+EdsError EDSAPI EdsGetPropertyDesc(EdsBaseRef ref, EdsPropertyID prop_id, EdsPropertyDesc *desc) {
+    static auto real = resolve<decltype(&EdsGetPropertyDesc)>("EdsGetPropertyDesc");
+    auto record = make_record(Op::GetPropertyDesc, id_of(ref), prop_id);
+    timed(record, [&] { return real(ref, prop_id, desc); });
+    write(record, desc, sizeof(*desc));
+    return record.result;
+}
+
+EdsError EDSAPI EdsOpenSession(EdsCameraRef camera) {
+    static auto real = resolve<decltype(&EdsOpenSession)>("EdsOpenSession");
+    auto record = make_record(Op::OpenSession, id_of(camera));
+    timed(record, [&] { return real(camera); });
+    write(record);
+    return record.result;
+}
+
+EdsError EDSAPI EdsCloseSession(EdsCameraRef camera) {
+    static auto real = resolve<decltype(&EdsCloseSession)>("EdsCloseSession");
+    auto record = make_record(Op::CloseSession, id_of(camera));
+    timed(record, [&] { return real(camera); });
+    write(record);
+    return record.result;
+}
+
+EdsError EDSAPI EdsSendCommand(EdsCameraRef camera, EdsCameraCommand command, EdsInt32 param) {
+    static auto real = resolve<decltype(&EdsSendCommand)>("EdsSendCommand");
+    auto record = make_record(Op::SendCommand, id_of(camera), command, static_cast<std::uint32_t>(param));
+    timed(record, [&] { return real(camera, command, param); });
+    write(record);
+    return record.result;
+}
+
+EdsError EDSAPI EdsSendStatusCommand(EdsCameraRef camera, EdsCameraStatusCommand command, EdsInt32 param) {
+    static auto real = resolve<decltype(&EdsSendStatusCommand)>("EdsSendStatusCommand");
+    auto record = make_record(Op::SendStatusCommand, id_of(camera), command, static_cast<std::uint32_t>(param));
+    timed(record, [&] { return real(camera, command, param); });
+    write(record);
+    return record.result;
+}
+
+EdsError EDSAPI EdsSetCapacity(EdsCameraRef camera, EdsCapacity capacity) {
+    static auto real = resolve<decltype(&EdsSetCapacity)>("EdsSetCapacity");
+    auto record = make_record(Op::SetCapacity, id_of(camera));
+    timed(record, [&] { return real(camera, capacity); });
+    write(record, &capacity, sizeof(capacity));
+    return record.result;
+}
+
+EdsError EDSAPI EdsGetVolumeInfo(EdsVolumeRef volume, EdsVolumeInfo *info) {
+    static auto real = resolve<decltype(&EdsGetVolumeInfo)>("EdsGetVolumeInfo");
+    auto record = make_record(Op::GetVolumeInfo, id_of(volume));
+    timed(record, [&] { return real(volume, info); });
+    write(record, info, sizeof(*info));
+    return record.result;
+}
+
+EdsError EDSAPI EdsGetDirectoryItemInfo(EdsDirectoryItemRef item, EdsDirectoryItemInfo *info) {
+    static auto real = resolve<decltype(&EdsGetDirectoryItemInfo)>("EdsGetDirectoryItemInfo");
+    auto record = make_record(Op::GetDirectoryItemInfo, id_of(item));
+    timed(record, [&] { return real(item, info); });
+    write(record, info, sizeof(*info));
+    return record.result;
+}
+
+EdsError EDSAPI EdsDownload(EdsDirectoryItemRef item, EdsUInt64 size, EdsStreamRef stream) {
+    static auto real = resolve<decltype(&EdsDownload)>("EdsDownload");
+    auto record = make_record(Op::Download, id_of(item), static_cast<std::uint32_t>(size), static_cast<std::uint32_t>(size >> 32));
+    timed(record, [&] { return real(item, size, stream); });
+    write(record);
+    return record.result;
+}
+
+EdsError EDSAPI EdsDownloadComplete(EdsDirectoryItemRef item) {
+    static auto real = resolve<decltype(&EdsDownloadComplete)>("EdsDownloadComplete");
+    auto record = make_record(Op::DownloadComplete, id_of(item));
+    timed(record, [&] { return real(item); });
+    write(record);
+    return record.result;
+}
+
+EdsError EDSAPI EdsDownloadCancel(EdsDirectoryItemRef item) {
+    static auto real = resolve<decltype(&EdsDownloadCancel)>("EdsDownloadCancel");
+    auto record = make_record(Op::DownloadCancel, id_of(item));
+    timed(record, [&] { return real(item); });
+    write(record);
+    return record.result;
+}
+
+EdsError EDSAPI EdsCreateFileStream(const EdsChar *path,
+                                    EdsFileCreateDisposition disposition,
+                                    EdsAccess access,
+                                    EdsStreamRef *stream) {
+    static auto real = resolve<decltype(&EdsCreateFileStream)>("EdsCreateFileStream");
+    return real(path, disposition, access, stream);
+}
+
+EdsError EDSAPI EdsCreateMemoryStream(EdsUInt64 size, EdsStreamRef *stream) {
+    static auto real = resolve<decltype(&EdsCreateMemoryStream)>("EdsCreateMemoryStream");
+    return real(size, stream);
+}
+
+EdsError EDSAPI EdsCreateMemoryStreamFromPointer(EdsVoid *buffer, EdsUInt64 size, EdsStreamRef *stream) {
+    static auto real = resolve<decltype(&EdsCreateMemoryStreamFromPointer)>("EdsCreateMemoryStreamFromPointer");
+    auto err = real(buffer, size, stream);
+    if (err == EDS_ERR_OK) {
+        auto &rec = recorder();
+        std::lock_guard<std::mutex> lock{rec.mutex};
+        rec.fixed_streams[*stream] = true;
+    }
+    return err;
+}
+
+EdsError EDSAPI EdsGetPointer(EdsStreamRef stream, EdsVoid **pointer) {
+    static auto real = resolve<decltype(&EdsGetPointer)>("EdsGetPointer");
+    return real(stream, pointer);
+}
+
+EdsError EDSAPI EdsGetPosition(EdsStreamRef stream, EdsUInt64 *position) {
+    static auto real = resolve<decltype(&EdsGetPosition)>("EdsGetPosition");
+    return real(stream, position);
+}
+
+EdsError EDSAPI EdsGetLength(EdsStreamRef stream, EdsUInt64 *length) {
+    static auto real = resolve<decltype(&EdsGetLength)>("EdsGetLength");
+    return real(stream, length);
+}
+
+EdsError EDSAPI EdsCreateEvfImageRef(EdsStreamRef stream, EdsEvfImageRef *evf_image) {
+    static auto real = resolve<decltype(&EdsCreateEvfImageRef)>("EdsCreateEvfImageRef");
+    auto err = real(stream, evf_image);
+    if (err == EDS_ERR_OK) {
+        auto &rec = recorder();
+        std::lock_guard<std::mutex> lock{rec.mutex};
+        rec.evf_streams[*evf_image] = stream;
+    }
+    return err;
+}
+
+EdsError EDSAPI EdsDownloadEvfImage(EdsCameraRef camera, EdsEvfImageRef evf_image) {
+    static auto real = resolve<decltype(&EdsDownloadEvfImage)>("EdsDownloadEvfImage");
+    auto record = make_record(Op::DownloadEvfImage, id_of(camera));
+    timed(record, [&] { return real(camera, evf_image); });
+    if (record.result != EDS_ERR_OK) {
+        write(record);
+        return record.result;
+    }
+
+    //payload is the frame size, followed by the frame when frames are kept
+    EdsStreamRef stream = nullptr;
+    bool fixed = false;
+    {
+        auto &rec = recorder();
+        std::lock_guard<std::mutex> lock{rec.mutex};
+        if (auto it = rec.evf_streams.find(evf_image); it != rec.evf_streams.end()) {
+            stream = it->second;
+            fixed = rec.fixed_streams.count(stream) > 0;
+        }
+    }
+    std::vector<std::uint8_t> payload(sizeof(std::uint64_t));
+    EdsUInt64 size = 0;
+    if (stream) {
+        //a stream on caller memory has its capacity as length
+        if ((fixed ? EdsGetPosition(stream, &size) : EdsGetLength(stream, &size)) != EDS_ERR_OK) {
+            size = 0;
+        }
+        EdsVoid *data = nullptr;
+        if (recorder().keep_frames && size > 0 && EdsGetPointer(stream, &data) == EDS_ERR_OK) {
+            auto bytes = static_cast<const std::uint8_t*>(data);
+            payload.insert(payload.end(), bytes, bytes + size);
+        }
+    }
+    std::memcpy(payload.data(), &size, sizeof(size));
+    write(record, payload.data(), payload.size());
+    return record.result;
+}
+
+EdsError EDSAPI EdsSetPropertyEventHandler(EdsCameraRef camera,
+                                           EdsPropertyEvent event,
+                                           EdsPropertyEventHandler handler,
+                                           EdsVoid *context) {
+    static auto real = resolve<decltype(&EdsSetPropertyEventHandler)>("EdsSetPropertyEventHandler");
+    auto record = make_record(Op::SetPropertyEventHandler, id_of(camera), event, handler != nullptr);
+    if (!handler) {
+        timed(record, [&] { return real(camera, event, nullptr, context); });
+    } else {
+        auto &slot = handler_slot(camera, Op::PropertyEvent, event, context);
+        slot.property = handler;
+        timed(record, [&] { return real(camera, event, property_trampoline, &slot); });
+    }
+    write(record);
+    return record.result;
+}
+
+EdsError EDSAPI EdsSetObjectEventHandler(EdsCameraRef camera,
+                                         EdsObjectEvent event,
+                                         EdsObjectEventHandler handler,
+                                         EdsVoid *context) {
+    static auto real = resolve<decltype(&EdsSetObjectEventHandler)>("EdsSetObjectEventHandler");
+    auto record = make_record(Op::SetObjectEventHandler, id_of(camera), event, handler != nullptr);
+    if (!handler) {
+        timed(record, [&] { return real(camera, event, nullptr, context); });
+    } else {
+        auto &slot = handler_slot(camera, Op::ObjectEvent, event, context);
+        slot.object = handler;
+        timed(record, [&] { return real(camera, event, object_trampoline, &slot); });
+    }
+    write(record);
+    return record.result;
+}
+
+EdsError EDSAPI EdsSetCameraStateEventHandler(EdsCameraRef camera,
+                                              EdsStateEvent event,
+                                              EdsStateEventHandler handler,
+                                              EdsVoid *context) {
+    static auto real = resolve<decltype(&EdsSetCameraStateEventHandler)>("EdsSetCameraStateEventHandler");
+    auto record = make_record(Op::SetCameraStateEventHandler, id_of(camera), event, handler != nullptr);
+    if (!handler) {
+        timed(record, [&] { return real(camera, event, nullptr, context); });
+    } else {
+        auto &slot = handler_slot(camera, Op::StateEvent, event, context);
+        slot.state = handler;
+        timed(record, [&] { return real(camera, event, state_trampoline, &slot); });
+    }
+    write(record);
+    return record.result;
+}
+
+//empty pumps are not traced, callbacks carry their own time
+EdsError EDSAPI EdsGetEvent() {
+    static auto real = resolve<decltype(&EdsGetEvent)>("EdsGetEvent");
+    return real();
+}
+}
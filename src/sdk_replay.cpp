@@ -0,0 +1,612 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+#include <EDSDK.h>
+#include <EDSDKErrors.h>
+#include "sdk_trace.hpp"
+
+//replay backend: defines the SDK functions the wrapper calls and answers them from a recorded trace,
+//no camera and no SDK are needed
+//
+//calls are matched by function, object and scalar arguments in recorded order; reads which run out
+//of records are answered again with their last result, so a build that polls more often still replays.
+//a callback is delivered from EdsGetEvent() once the last command recorded before it has been
+//replayed and the recorded delay after that command has passed, which keeps camera latency relative
+//to what the new build does instead of to the wall clock of the old session
+namespace {
+    using namespace edsdk_w::sdk_trace;
+    using Clock = std::chrono::steady_clock;
+
+    constexpr std::size_t NONE = std::numeric_limits<std::size_t>::max();
+
+    //camera side objects stand for their trace number, streams and live view images are real
+    struct Object {
+        enum class Kind {
+            Remote,
+            Stream,
+            EvfImage
+        };
+
+        Kind kind;
+        std::uint32_t id;
+
+        virtual ~Object() = default;
+    };
+
+    struct Stream : Object {
+        std::vector<std::uint8_t> owned;
+        std::uint8_t *buffer = nullptr; //caller memory, fixed capacity
+        std::uint64_t capacity = 0;
+        std::uint64_t length = 0;
+        std::uint64_t position = 0;
+        std::FILE *file = nullptr;
+
+        ~Stream() override {
+            if (file) {
+                std::fclose(file);
+            }
+        }
+
+        [[nodiscard]] std::uint8_t *data() { return buffer ? buffer : owned.data(); }
+
+        //without data the size is filled with zeros, as much as a download would write
+        bool write(const std::uint8_t *bytes, std::uint64_t size) {
+            if (file) {
+                static const std::uint8_t zeros[64 * 1024] = {};
+                for (std::uint64_t done = 0; done < size;) {
+                    auto chunk = std::min<std::uint64_t>(size - done, sizeof(zeros));
+                    if (std::fwrite(bytes ? bytes + done : zeros, chunk, 1, file) != 1) {
+                        return false;
+                    }
+                    done += chunk;
+                }
+            } else {
+                if (buffer && position + size > capacity) {
+                    return false;
+                }
+                if (!buffer && position + size > owned.size()) {
+                    owned.resize(position + size);
+                }
+                if (bytes) {
+                    std::memcpy(data() + position, bytes, size);
+                } else {
+                    std::memset(data() + position, 0, size);
+                }
+            }
+            position += size;
+            length = std::max(length, position);
+            return true;
+        }
+    };
+
+    struct EvfImage : Object {
+        Stream *stream;
+    };
+
+    struct Handlers {
+        EdsPropertyEventHandler property = nullptr;
+        EdsObjectEventHandler object = nullptr;
+        EdsStateEventHandler state = nullptr;
+        EdsVoid *context = nullptr;
+    };
+
+    struct Served {
+        EdsError result;
+        const Record *record;
+        const std::uint8_t *payload;
+    };
+
+    class Replayer {
+    public:
+        bool load(const std::string &path, double time_scale) {
+            std::lock_guard<std::mutex> lock{_mutex};
+            if (!read_trace(path, _trace)) {
+                return false;
+            }
+            _time_scale = time_scale;
+            _start = Clock::now();
+            _returned_at.assign(_trace.records.size(), std::nullopt);
+
+            std::size_t last_command = NONE;
+            for (std::size_t i = 0; i < _trace.records.size(); i++) {
+                auto op = _trace.records[i].op;
+                if (is_callback(op)) {
+                    _callbacks.push_back({i, last_command});
+                } else {
+                    _pending[_key(_trace.records[i])].push_back(i);
+                    if (!is_read(op)) {
+                        last_command = i;
+                    }
+                }
+            }
+            return true;
+        }
+
+        Served call(Op op, EdsBaseRef ref, std::uint32_t arg0 = 0, std::uint32_t arg1 = 0) {
+            std::size_t index = NONE;
+            bool fresh = false;
+            {
+                std::lock_guard<std::mutex> lock{_mutex};
+                Key key{op, _id_of(ref), arg0, arg1};
+                auto &queue = _pending[key];
+                auto last = _last.find(key);
+                //a read recorded after an event not delivered yet would see the future
+                fresh = !queue.empty() && (!is_read(op) || last == _last.end() || queue.front() < _next_callback_record());
+                if (fresh) {
+                    index = queue.front();
+                    queue.pop_front();
+                    _last[key] = index;
+                    _stats.served++;
+                } else if (last != _last.end()) {
+                    index = last->second;
+                    _stats.answered_again++;
+                } else {
+                    _stats.unmatched++;
+                    return {EDS_ERR_INTERNAL_ERROR, nullptr, nullptr};
+                }
+            }
+
+            const auto &record = _trace.records[index];
+            std::this_thread::sleep_for(_scaled(record.duration_us));
+            if (fresh) {
+                std::lock_guard<std::mutex> lock{_mutex};
+                _returned_at[index] = Clock::now();
+            }
+            return {record.result, &record, _trace.payload(index)};
+        }
+
+        //objects of out refs and object events, one per trace number
+        EdsBaseRef remote(std::uint32_t id) {
+            if (id == 0) {
+                return nullptr;
+            }
+            std::lock_guard<std::mutex> lock{_mutex};
+            auto &object = _remote[id];
+            if (!object) {
+                object = std::make_unique<Object>();
+                object->kind = Object::Kind::Remote;
+                object->id = id;
+            }
+            return reinterpret_cast<EdsBaseRef>(object.get());
+        }
+
+        template <typename T>
+        EdsBaseRef adopt(std::unique_ptr<T> object) {
+            std::lock_guard<std::mutex> lock{_mutex};
+            auto ref = reinterpret_cast<EdsBaseRef>(object.get());
+            _local[object.get()] = std::move(object);
+            return ref;
+        }
+
+        //camera side objects live until EdsTerminateSDK(), the wrapper may see them again
+        void release(EdsBaseRef ref) {
+            std::lock_guard<std::mutex> lock{_mutex};
+            _local.erase(reinterpret_cast<Object*>(ref));
+        }
+
+        void set_handlers(Op op, EdsUInt32 event, const Handlers &handlers) {
+            std::lock_guard<std::mutex> lock{_mutex};
+            _handlers[{op, event}] = handlers;
+        }
+
+        //delivers due callbacks in recorded order, a callback waiting for its command holds back later ones
+        void deliver() {
+            while (true) {
+                std::size_t index;
+                Handlers handlers{};
+                {
+                    std::lock_guard<std::mutex> lock{_mutex};
+                    if (_delivered == _callbacks.size()) {
+                        return;
+                    }
+                    auto [callback, cause] = _callbacks[_delivered];
+                    const auto &record = _trace.records[callback];
+                    Clock::time_point due;
+                    if (cause == NONE) {
+                        due = _start + _scaled(record.start_us);
+                    } else if (_returned_at[cause]) {
+                        const auto &command = _trace.records[cause];
+                        auto command_end = command.start_us + command.duration_us;
+                        due = *_returned_at[cause] + _scaled(record.start_us > command_end ? record.start_us - command_end : 0);
+                    } else {
+                        return;
+                    }
+                    if (Clock::now() < due) {
+                        return;
+                    }
+                    _delivered++;
+                    index = callback;
+                    handlers = _handlers_for(record);
+                }
+
+                const auto &record = _trace.records[index];
+                switch (record.op) {
+                    case Op::PropertyEvent:
+                        if (handlers.property) {
+                            handlers.property(record.arg0, record.arg1, record.result, handlers.context);
+                        }
+                        break;
+                    case Op::ObjectEvent:
+                        if (handlers.object) {
+                            handlers.object(record.arg0, remote(record.out_ref), handlers.context);
+                        }
+                        break;
+                    case Op::StateEvent:
+                        if (handlers.state) {
+                            handlers.state(record.arg0, record.arg1, handlers.context);
+                        }
+                        break;
+                    default:
+                        break;
+                }
+            }
+        }
+
+        void report(std::ostream &out) {
+            std::lock_guard<std::mutex> lock{_mutex};
+            std::uint64_t unused = 0;
+            for (const auto &[key, queue] : _pending) {
+                unused += queue.size();
+            }
+            double trace_s = _trace.records.empty() ? 0 : _trace.records.back().start_us / 1e6;
+            double replay_s = std::chrono::duration<double>(Clock::now() - _start).count();
+            out << "sdk replay: " << _stats.served << " calls replayed, " << _stats.answered_again
+                << " reads answered again, " << _stats.unmatched << " calls without record, " << unused
+                << " records unused, " << _delivered << "/" << _callbacks.size() << " callbacks delivered, trace "
+                << trace_s << " s, replay " << replay_s << " s" << std::endl;
+        }
+
+    private:
+        using Key = std::tuple<Op, std::uint32_t, std::uint32_t, std::uint32_t>;
+
+        struct Stats {
+            std::uint64_t served;
+            std::uint64_t answered_again;
+            std::uint64_t unmatched;
+        };
+
+        static Key _key(const Record &record) {
+            return {record.op, record.ref, record.arg0, record.arg1};
+        }
+
+        static std::uint32_t _id_of(EdsBaseRef ref) {
+            return ref ? reinterpret_cast<Object*>(ref)->id : 0;
+        }
+
+        [[nodiscard]] Clock::duration _scaled(std::uint64_t us) const {
+            return std::chrono::duration_cast<Clock::duration>(
+                    std::chrono::duration<double, std::micro>(static_cast<double>(us) * _time_scale));
+        }
+
+        [[nodiscard]] std::size_t _next_callback_record() const {
+            return _delivered < _callbacks.size() ? _callbacks[_delivered].first : NONE;
+        }
+
+        Handlers _handlers_for(const Record &record) const {
+            EdsUInt32 all = record.op == Op::PropertyEvent ? static_cast<EdsUInt32>(kEdsPropertyEvent_All)
+                          : record.op == Op::ObjectEvent ? static_cast<EdsUInt32>(kEdsObjectEvent_All)
+                          : static_cast<EdsUInt32>(kEdsStateEvent_All);
+            for (auto event : {record.arg0, all}) {
+                if (auto it = _handlers.find({record.op, event}); it != _handlers.end()) {
+                    return it->second;
+                }
+            }
+            return {};
+        }
+
+        std::mutex _mutex;
+        Trace _trace;
+        double _time_scale = 1;
+        Clock::time_point _start;
+
+        std::map<Key, std::deque<std::size_t>> _pending;
+        std::map<Key, std::size_t> _last;
+        std::vector<std::optional<Clock::time_point>> _returned_at;
+        std::vector<std::pair<std::size_t, std::size_t>> _callbacks; //record and the command before it
+        std::size_t _delivered = 0;
+        std::map<std::pair<Op, EdsUInt32>, Handlers> _handlers;
+
+        std::unordered_map<std::uint32_t, std::unique_ptr<Object>> _remote;
+        std::unordered_map<Object*, std::unique_ptr<Object>> _local;
+        Stats _stats{};
+    };
+
+    std::unique_ptr<Replayer> replayer{};
+
+    template <typename T>
+    void copy_payload(const Served &served, T *out) {
+        if (served.result == EDS_ERR_OK && out) {
+            std::memcpy(out, served.payload, std::min<std::size_t>(sizeof(T), served.record->payload_size));
+        }
+    }
+
+    Stream *as_stream(EdsBaseRef ref) {
+        auto object = reinterpret_cast<Object*>(ref);
+        return object && object->kind == Object::Kind::Stream ? static_cast<Stream*>(object) : nullptr;
+    }
+
+    EdsBaseRef make_stream(std::uint8_t *buffer, std::uint64_t capacity, std::FILE *file) {
+        auto stream = std::make_unique<Stream>();
+        stream->kind = Object::Kind::Stream;
+        stream->id = 0;
+        stream->buffer = buffer;
+        stream->capacity = capacity;
+        stream->length = buffer ? capacity : 0;
+        stream->file = file;
+        return replayer->adopt(std::move(stream));
+    }
+}
+
+extern "C" {
+EdsError EDSAPI EdsInitializeSDK() {
+    auto path = std::getenv("EDSW_SDK_TRACE");
+    auto scale = std::getenv("EDSW_SDK_TIME_SCALE");
+    replayer = std::make_unique<Replayer>();
+    if (!replayer->load(path ? path : "edsdk.trace", scale ? std::atof(scale) : 1.0)) {
+        std::cerr << "sdk replay: cannot read trace " << (path ? path : "edsdk.trace") << std::endl;
+        return EDS_ERR_INTERNAL_ERROR;
+    }
+    return replayer->call(Op::InitializeSDK, nullptr).result;
+}
+
+EdsError EDSAPI EdsTerminateSDK() {
+    auto res = replayer->call(Op::TerminateSDK, nullptr).result;
+    replayer->report(std::cerr);
+    replayer.reset();
+    return res;
+}
+
+EdsUInt32 EDSAPI EdsRelease(EdsBaseRef ref) {
+    if (replayer) {
+        replayer->release(ref);
+    }
+    return 0;
+}
+
+EdsError EDSAPI EdsGetCameraList(EdsCameraListRef *list) {
+    auto served = replayer->call(Op::GetCameraList, nullptr);
+    if (served.result == EDS_ERR_OK) {
+        *list = replayer->remote(served.record->out_ref);
+    }
+    return served.result;
+}
+
+EdsError EDSAPI EdsGetChildCount(EdsBaseRef ref, EdsUInt32 *count) {
+    auto served = replayer->call(Op::GetChildCount, ref);
+    copy_payload(served, count);
+    return served.result;
+}
+
+EdsError EDSAPI EdsGetChildAtIndex(EdsBaseRef ref, EdsInt32 index, EdsBaseRef *child) {
+    auto served = replayer->call(Op::GetChildAtIndex, ref, static_cast<std::uint32_t>(index));
+    if (served.result == EDS_ERR_OK) {
+        *child = replayer->remote(served.record->out_ref);
+    }
+    return served.result;
+}
+
+EdsError EDSAPI EdsGetDeviceInfo(EdsCameraRef camera, EdsDeviceInfo *info) {
+    auto served = replayer->call(Op::GetDeviceInfo, camera);
+    copy_payload(served, info);
+    return served.result;
+}
+
+EdsError EDSAPI EdsGetPropertySize(EdsBaseRef ref,
+                                   EdsPropertyID prop_id,
+                                   EdsInt32 param,
+                                   EdsDataType *data_type,
+                                   EdsUInt32 *size) {
+    auto served = replayer->call(Op::GetPropertySize, ref, prop_id, static_cast<std::uint32_t>(param));
+    std::uint32_t payload[2] = {};
+    copy_payload(served, &payload);
+    if (served.result == EDS_ERR_OK) {
+        *data_type = static_cast<EdsDataType>(payload[0]);
+        *size = payload[1];
+    }
+    return served.result;
+}
+
+EdsError EDSAPI EdsGetPropertyData(EdsBaseRef ref,
+                                   EdsPropertyID prop_id,
+                                   EdsInt32 param,
+                                   EdsUInt32 size,
+                                   EdsVoid *data) {
+    auto served = replayer->call(Op::GetPropertyData, ref, prop_id, static_cast<std::uint32_t>(param));
+    if (served.result == EDS_ERR_OK) {
+        std::memset(data, 0, size);
+        std::memcpy(data, served.payload, std::min(size, served.record->payload_size));
+    }
+    return served.result;
+}
+
+EdsError EDSAPI EdsSetPropertyData(EdsBaseRef ref,
+                                   EdsPropertyID prop_id,
+                                   EdsInt32 param,
+                                   EdsUInt32,
+                                   const EdsVoid*) {
+    return replayer->call(Op::SetPropertyData, ref, prop_id, static_cast<std::uint32_t>(param)).result;
+}
+
+EdsError EDSAPI EdsGetPropertyDesc(EdsBaseRef ref, EdsPropertyID prop_id, EdsPropertyDesc *desc) {
+    auto served = replayer->call(Op::GetPropertyDesc, ref, prop_id);
+    copy_payload(served, desc);
+    return served.result;
+}
+
+EdsError EDSAPI EdsOpenSession(EdsCameraRef camera) {
+    return replayer->call(Op::OpenSession, camera).result;
+}
+
+EdsError EDSAPI EdsCloseSession(EdsCameraRef camera) {
+    return replayer->call(Op::CloseSession, camera).result;
+}
+
+EdsError EDSAPI EdsSendCommand(EdsCameraRef camera, EdsCameraCommand command, EdsInt32 param) {
+    return replayer->call(Op::SendCommand, camera, command, static_cast<std::uint32_t>(param)).result;
+}
+
+EdsError EDSAPI EdsSendStatusCommand(EdsCameraRef camera, EdsCameraStatusCommand command, EdsInt32 param) {
+    return replayer->call(Op::SendStatusCommand, camera, command, static_cast<std::uint32_t>(param)).result;
+}
+
+EdsError EDSAPI EdsSetCapacity(EdsCameraRef camera, EdsCapacity) {
+    return replayer->call(Op::SetCapacity, camera).result;
+}
+
+EdsError EDSAPI EdsGetVolumeInfo(EdsVolumeRef volume, EdsVolumeInfo *info) {
+    auto served = replayer->call(Op::GetVolumeInfo, volume);
+    copy_payload(served, info);
+    return served.result;
+}
+
+EdsError EDSAPI EdsGetDirectoryItemInfo(EdsDirectoryItemRef item, EdsDirectoryItemInfo *info) {
+    auto served = replayer->call(Op::GetDirectoryItemInfo, item);
+    copy_payload(served, info);
+    return served.result;
+}
+
+EdsError EDSAPI EdsDownload(EdsDirectoryItemRef item, EdsUInt64 size, EdsStreamRef stream) {
+    auto served = replayer->call(Op::Download, item, static_cast<std::uint32_t>(size), static_cast<std::uint32_t>(size >> 32));
+    auto target = as_stream(stream);
+    if (served.result == EDS_ERR_OK && (!target || !target->write(nullptr, size))) {
+        return EDS_ERR_INTERNAL_ERROR;
+    }
+    return served.result;
+}
+
+EdsError EDSAPI EdsDownloadComplete(EdsDirectoryItemRef item) {
+    return replayer->call(Op::DownloadComplete, item).result;
+}
+
+EdsError EDSAPI EdsDownloadCancel(EdsDirectoryItemRef item) {
+    return replayer->call(Op::DownloadCancel, item).result;
+}
+
+EdsError EDSAPI EdsCreateFileStream(const EdsChar *path, EdsFileCreateDisposition, EdsAccess, EdsStreamRef *stream) {
+    auto file = std::fopen(path, "wb");
+    if (!file) {
+        return EDS_ERR_INTERNAL_ERROR;
+    }
+    *stream = make_stream(nullptr, 0, file);
+    return EDS_ERR_OK;
+}
+
+EdsError EDSAPI EdsCreateMemoryStream(EdsUInt64, EdsStreamRef *stream) {
+    *stream = make_stream(nullptr, 0, nullptr);
+    return EDS_ERR_OK;
+}
+
+EdsError EDSAPI EdsCreateMemoryStreamFromPointer(EdsVoid *buffer, EdsUInt64 size, EdsStreamRef *stream) {
+    *stream = make_stream(static_cast<std::uint8_t*>(buffer), size, nullptr);
+    return EDS_ERR_OK;
+}
+
+EdsError EDSAPI EdsGetPointer(EdsStreamRef stream, EdsVoid **pointer) {
+    auto target = as_stream(stream);
+    if (!target || target->file) {
+        return EDS_ERR_INTERNAL_ERROR;
+    }
+    *pointer = target->data();
+    return EDS_ERR_OK;
+}
+
+EdsError EDSAPI EdsGetPosition(EdsStreamRef stream, EdsUInt64 *position) {
+    auto target = as_stream(stream);
+    if (!target) {
+        return EDS_ERR_INTERNAL_ERROR;
+    }
+    *position = target->position;
+    return EDS_ERR_OK;
+}
+
+EdsError EDSAPI EdsGetLength(EdsStreamRef stream, EdsUInt64 *length) {
+    auto target = as_stream(stream);
+    if (!target) {
+        return EDS_ERR_INTERNAL_ERROR;
+    }
+    *length = target->length;
+    return EDS_ERR_OK;
+}
+
+EdsError EDSAPI EdsCreateEvfImageRef(EdsStreamRef stream, EdsEvfImageRef *evf_image) {
+    auto target = as_stream(stream);
+    if (!target) {
+        return EDS_ERR_INTERNAL_ERROR;
+    }
+    auto image = std::make_unique<EvfImage>();
+    image->kind = Object::Kind::EvfImage;
+    image->id = 0;
+    image->stream = target;
+    *evf_image = replayer->adopt(std::move(image));
+    return EDS_ERR_OK;
+}
+
+EdsError EDSAPI EdsDownloadEvfImage(EdsCameraRef camera, EdsEvfImageRef evf_image) {
+    auto served = replayer->call(Op::DownloadEvfImage, camera);
+    auto image = reinterpret_cast<Object*>(evf_image);
+    if (served.result != EDS_ERR_OK || !image || image->kind != Object::Kind::EvfImage) {
+        return served.result != EDS_ERR_OK ? served.result : EDS_ERR_INTERNAL_ERROR;
+    }
+
+    //frame size, then the frame itself when it was kept
+    std::uint64_t size = 0;
+    if (served.record->payload_size >= sizeof(size)) {
+        std::memcpy(&size, served.payload, sizeof(size));
+    }
+    bool kept = served.record->payload_size == sizeof(size) + size;
+    auto stream = static_cast<EvfImage*>(image)->stream;
+    stream->position = 0;
+    return stream->write(kept ? served.payload + sizeof(size) : nullptr, size) ? EDS_ERR_OK : EDS_ERR_INTERNAL_ERROR;
+}
+
+EdsError EDSAPI EdsSetPropertyEventHandler(EdsCameraRef camera,
+                                           EdsPropertyEvent event,
+                                           EdsPropertyEventHandler handler,
+                                           EdsVoid *context) {
+    Handlers handlers{};
+    handlers.property = handler;
+    handlers.context = context;
+    replayer->set_handlers(Op::PropertyEvent, event, handlers);
+    return replayer->call(Op::SetPropertyEventHandler, camera, event, handler != nullptr).result;
+}
+
+EdsError EDSAPI EdsSetObjectEventHandler(EdsCameraRef camera,
+                                         EdsObjectEvent event,
+                                         EdsObjectEventHandler handler,
+                                         EdsVoid *context) {
+    Handlers handlers{};
+    handlers.object = handler;
+    handlers.context = context;
+    replayer->set_handlers(Op::ObjectEvent, event, handlers);
+    return replayer->call(Op::SetObjectEventHandler, camera, event, handler != nullptr).result;
+}
+
+EdsError EDSAPI EdsSetCameraStateEventHandler(EdsCameraRef camera,
+                                              EdsStateEvent event,
+                                              EdsStateEventHandler handler,
+                                              EdsVoid *context) {
+    Handlers handlers{};
+    handlers.state = handler;
+    handlers.context = context;
+    replayer->set_handlers(Op::StateEvent, event, handlers);
+    return replayer->call(Op::SetCameraStateEventHandler, camera, event, handler != nullptr).result;
+}
+
+EdsError EDSAPI EdsGetEvent() {
+    replayer->deliver();
+    return EDS_ERR_OK;
+}
+}
@@ -0,0 +1,78 @@
+#include "sdk_trace.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+namespace edsdk_w::sdk_trace {
+    TraceWriter::~TraceWriter() {
+        close();
+    }
+
+    bool TraceWriter::open(const std::string &path) {
+        std::lock_guard<std::mutex> lock{_mutex};
+        _file = std::fopen(path.c_str(), "wb");
+        if (!_file) {
+            return false;
+        }
+        //large buffer, records are small and come in bursts while pumping
+        std::setvbuf(_file, nullptr, _IOFBF, 1 << 20);
+        _records = 0;
+        return std::fwrite(MAGIC, sizeof(MAGIC), 1, _file) == 1;
+    }
+
+    void TraceWriter::close() {
+        std::lock_guard<std::mutex> lock{_mutex};
+        if (_file) {
+            std::fclose(_file);
+            _file = nullptr;
+        }
+    }
+
+    void TraceWriter::write(const Record &record, const void *payload) {
+        std::lock_guard<std::mutex> lock{_mutex};
+        if (!_file) {
+            return;
+        }
+        std::fwrite(&record, sizeof(record), 1, _file);
+        if (record.payload_size > 0) {
+            std::fwrite(payload, record.payload_size, 1, _file);
+        }
+        _records++;
+    }
+
+    std::uint64_t TraceWriter::records() const {
+        std::lock_guard<std::mutex> lock{_mutex};
+        return _records;
+    }
+
+    bool read_trace(const std::string &path, Trace &trace) {
+        std::FILE *file = std::fopen(path.c_str(), "rb");
+        if (!file) {
+            return false;
+        }
+
+        trace = {};
+        char magic[sizeof(MAGIC)];
+        bool res = std::fread(magic, sizeof(magic), 1, file) == 1 &&
+                   std::equal(std::begin(magic), std::end(magic), std::begin(MAGIC));
+        Record record{};
+        while (res && std::fread(&record, sizeof(record), 1, file) == 1) {
+            auto offset = trace.payloads.size();
+            trace.payloads.resize(offset + record.payload_size);
+            if (record.payload_size > 0 && std::fread(trace.payloads.data() + offset, record.payload_size, 1, file) != 1) {
+                res = false;
+                break;
+            }
+            //failed calls have no out data, result of a callback is its event parameter
+            if (record.payload_size > 0 && record.result != 0 && !is_callback(record.op)) {
+                res = false;
+                break;
+            }
+            trace.records.push_back(record);
+            trace.payload_offsets.push_back(offset);
+        }
+        res = res && std::feof(file) && !std::ferror(file);
+        std::fclose(file);
+        return res;
+    }
+} //namespace edsdk_w::sdk_trace
@@ -0,0 +1,128 @@
+#ifndef SDK_TRACE_HPP
+#define SDK_TRACE_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace edsdk_w::sdk_trace {
+    //binary trace of SDK calls and callbacks written by the record backend and read by the replay backend,
+    //both stand in for libEDSDK at link time (EDSW_SDK_BACKEND) and are configured by environment:
+    //  EDSW_SDK_TRACE       trace file, edsdk.trace by default
+    //  EDSW_SDK_LIBRARY     real SDK loaded by the record backend
+    //  EDSW_SDK_FRAMES      record backend keeps live view JPEG data when set to 1
+    //  EDSW_SDK_TIME_SCALE  replay multiplies recorded durations and delays, 1 by default, 0 runs flat out
+    //
+    //objects are identified by numbers given in order of first appearance; host side streams are not
+    //traced, downloads only keep their size
+    enum class Op : std::uint32_t {
+        InitializeSDK = 1,
+        TerminateSDK,
+        GetCameraList,
+        GetChildCount,
+        GetChildAtIndex,
+        GetDeviceInfo,
+        GetPropertySize,
+        GetPropertyData,
+        SetPropertyData,
+        GetPropertyDesc,
+        OpenSession,
+        CloseSession,
+        SendCommand,
+        SendStatusCommand,
+        SetCapacity,
+        GetVolumeInfo,
+        GetDirectoryItemInfo,
+        Download,
+        DownloadComplete,
+        DownloadCancel,
+        DownloadEvfImage,
+        SetPropertyEventHandler,
+        SetObjectEventHandler,
+        SetCameraStateEventHandler,
+
+        //delivered by the SDK, in EdsGetEvent() on Linux
+        PropertyEvent = 64,
+        ObjectEvent,
+        StateEvent
+    };
+
+    //reads that may be answered again with the last result when a replayed build calls them more often
+    constexpr bool is_read(Op op) {
+        switch (op) {
+            case Op::GetCameraList:
+            case Op::GetChildCount:
+            case Op::GetChildAtIndex:
+            case Op::GetDeviceInfo:
+            case Op::GetPropertySize:
+            case Op::GetPropertyData:
+            case Op::GetPropertyDesc:
+            case Op::GetVolumeInfo:
+            case Op::GetDirectoryItemInfo:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    constexpr bool is_callback(Op op) {
+        return op >= Op::PropertyEvent;
+    }
+
+    //calls: ref is the target object, args are the scalar inputs, result the EdsError and out ref
+    //an object created by the call; callbacks: ref is the camera, arg0 the event, arg1 the property
+    //or state data, out ref the object of object events, result the property event parameter
+    struct Record {
+        Op op;
+        std::uint32_t ref;
+        std::uint32_t arg0;
+        std::uint32_t arg1;
+        std::uint32_t result;
+        std::uint32_t out_ref;
+        std::uint32_t duration_us;
+        std::uint32_t payload_size; //out data of the call following the record
+        std::uint64_t start_us;     //since EdsInitializeSDK()
+    };
+    static_assert(sizeof(Record) == 40, "record layout is part of the trace format");
+
+    constexpr char MAGIC[8] = {'E', 'D', 'S', 'W', 'T', 'R', 'C', '1'};
+
+    //appends records, calls may come from SDK threads
+    class TraceWriter {
+    public:
+        TraceWriter() = default;
+        ~TraceWriter();
+
+        TraceWriter(const TraceWriter &) = delete;
+        TraceWriter &operator=(const TraceWriter &) = delete;
+
+        bool open(const std::string &path);
+        void close();
+
+        void write(const Record &record, const void *payload = nullptr);
+
+        [[nodiscard]] std::uint64_t records() const;
+
+    private:
+        mutable std::mutex _mutex;
+        std::FILE *_file = nullptr;
+        std::uint64_t _records = 0;
+    };
+
+    struct Trace {
+        std::vector<Record> records;
+        std::vector<std::uint64_t> payload_offsets; //per record, into payloads
+        std::vector<std::uint8_t> payloads;
+
+        [[nodiscard]] const std::uint8_t *payload(std::size_t index) const {
+            return payloads.data() + payload_offsets[index];
+        }
+    };
+
+    //false on missing file, wrong magic, truncated record or payload on a failed call
+    bool read_trace(const std::string &path, Trace &trace);
+} //namespace edsdk_w::sdk_trace
+
+#endif //SDK_TRACE_HPP
@@ -0,0 +1,102 @@
+#include "session_watchdog.hpp"
+
+#include <algorithm>
+
+namespace edsdk_w {
+    namespace {
+        constexpr std::size_t MAX_LATENCIES = 256;
+    }
+
+    SessionWatchdog::SessionWatchdog(const Options &options) :
+            _options{options},
+            _last_activity{Clock::now()},
+            _last_keep_alive{_last_activity},
+            _last_reopen{},
+            _consecutive_failures{0},
+            _next_latency{0},
+            _stats{} {
+        _stats.healthy = true;
+    }
+
+    void SessionWatchdog::on_activity(Clock::time_point now) {
+        _last_activity = now;
+    }
+
+    SessionWatchdog::Action SessionWatchdog::next_action(Clock::time_point now) const {
+        if (_consecutive_failures >= _options.failures_before_reopen) {
+            return now - _last_reopen >= _options.reopen_backoff ? Action::Reopen : Action::None;
+        }
+        if (now - _last_keep_alive >= _options.keep_alive_interval) {
+            return Action::KeepAlive;
+        }
+        if (now - _last_activity >= _options.probe_interval) {
+            return Action::Probe;
+        }
+        return Action::None;
+    }
+
+    void SessionWatchdog::on_probe(bool ok, std::chrono::nanoseconds latency, Clock::time_point now) {
+        _stats.probes++;
+        _last_activity = now;
+        if (!ok) {
+            _stats.failed_probes++;
+            _consecutive_failures++;
+            _stats.healthy = _consecutive_failures < _options.failures_before_reopen;
+            return;
+        }
+
+        _consecutive_failures = 0;
+        _stats.healthy = true;
+        _stats.last_probe_us = static_cast<double>(latency.count()) / 1000;
+        if (_latencies.size() < MAX_LATENCIES) {
+            _latencies.push_back(latency.count());
+        } else {
+            _latencies[_next_latency] = latency.count();
+            _next_latency = (_next_latency + 1) % MAX_LATENCIES;
+        }
+    }
+
+    void SessionWatchdog::on_keep_alive(bool ok, Clock::time_point now) {
+        _stats.keep_alives++;
+        _last_keep_alive = now;
+        if (ok) {
+            _last_activity = now;
+        } else {
+            _consecutive_failures++;
+            _stats.healthy = _consecutive_failures < _options.failures_before_reopen;
+        }
+    }
+
+    void SessionWatchdog::on_reopen(bool ok, Clock::time_point now) {
+        _last_reopen = now;
+        if (!ok) {
+            _stats.failed_reopens++;
+            return;
+        }
+        _stats.reopens++;
+        _stats.healthy = true;
+        _consecutive_failures = 0;
+        _last_activity = _last_keep_alive = now;
+    }
+
+    bool SessionWatchdog::healthy() const {
+        return _stats.healthy;
+    }
+
+    SessionWatchdog::Stats SessionWatchdog::stats() const {
+        auto res = _stats;
+        if (_latencies.empty()) {
+            return res;
+        }
+
+        auto sorted = _latencies;
+        std::sort(sorted.begin(), sorted.end());
+        auto at = [&sorted](double q) {
+            return static_cast<double>(sorted[static_cast<std::size_t>(q * static_cast<double>(sorted.size() - 1) + 0.5)]) / 1000;
+        };
+        res.p50_probe_us = at(0.5);
+        res.p99_probe_us = at(0.99);
+        res.max_probe_us = static_cast<double>(sorted.back()) / 1000;
+        return res;
+    }
+} //namespace edsdk_w
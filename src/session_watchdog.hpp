@@ -0,0 +1,75 @@
+#ifndef SESSION_WATCHDOG_HPP
+#define SESSION_WATCHDOG_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace edsdk_w {
+    //decides when an idle camera session is probed, kept awake or reopened
+    //
+    //probe is a small property read, its round trip time is the health signal; a session is
+    //reopened after consecutive failed probes, so the next real command finds it working
+    class SessionWatchdog {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        enum class Action {
+            None,
+            Probe,
+            KeepAlive,
+            Reopen
+        };
+
+        struct Options {
+            std::chrono::milliseconds probe_interval{5000};      //since last sign of life
+            std::chrono::milliseconds keep_alive_interval{30000}; //auto power off is 1 minute at least
+            std::chrono::milliseconds reopen_backoff{2000};
+            std::uint32_t failures_before_reopen = 2;
+        };
+
+        struct Stats {
+            std::uint64_t probes;
+            std::uint64_t failed_probes;
+            std::uint64_t keep_alives;
+            std::uint64_t reopens;
+            std::uint64_t failed_reopens;
+            double last_probe_us;
+            double p50_probe_us;
+            double p99_probe_us;
+            double max_probe_us;
+            bool healthy;
+        };
+
+        explicit SessionWatchdog(const Options &options);
+
+        //events or command results from camera prove the link, probe is postponed
+        void on_activity(Clock::time_point now);
+
+        [[nodiscard]] Action next_action(Clock::time_point now) const;
+
+        void on_probe(bool ok, std::chrono::nanoseconds latency, Clock::time_point now);
+
+        void on_keep_alive(bool ok, Clock::time_point now);
+
+        void on_reopen(bool ok, Clock::time_point now);
+
+        [[nodiscard]] bool healthy() const;
+
+        [[nodiscard]] Stats stats() const;
+
+    private:
+        Options _options;
+        Clock::time_point _last_activity;
+        Clock::time_point _last_keep_alive;
+        Clock::time_point _last_reopen;
+        std::uint32_t _consecutive_failures;
+
+        //latest probe latencies in nanoseconds, ring buffer
+        std::vector<std::int64_t> _latencies;
+        std::size_t _next_latency;
+        Stats _stats;
+    };
+} //namespace edsdk_w
+
+#endif //SESSION_WATCHDOG_HPP
@@ -0,0 +1,256 @@
+#include "settings_profile.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+namespace edsdk_w {
+    namespace {
+        constexpr std::uint32_t NO_GATE = 0xffffffff;
+        constexpr std::uint32_t WHITE_BALANCE_COLOR_TEMPERATURE = 9;
+
+        struct Dependency {
+            Prop parent;
+            Prop child;
+            std::uint32_t gate; //child applies only with this parent value
+        };
+
+        //constraints of exposure properties change with shooting mode,
+        //color temperature is used only with matching white balance
+        constexpr Dependency DEPENDENCIES[] = {
+                {Prop::AEMode, Prop::Av, NO_GATE},
+                {Prop::AEMode, Prop::Tv, NO_GATE},
+                {Prop::AEMode, Prop::ISO, NO_GATE},
+                {Prop::AEMode, Prop::ExposureCompensation, NO_GATE},
+                {Prop::WhiteBalance, Prop::ColorTemperature, WHITE_BALANCE_COLOR_TEMPERATURE}
+        };
+
+        //file names of properties, text properties are not part of profiles
+        constexpr const char *name_of(Prop p) {
+            switch (p) {
+                case Prop::ImageQuality: return "image_quality";
+                case Prop::AEMode: return "ae_mode";
+                case Prop::AFMode: return "af_mode";
+                case Prop::WhiteBalance: return "white_balance";
+                case Prop::ColorTemperature: return "color_temperature";
+                case Prop::ColorSpace: return "color_space";
+                case Prop::DriveMode: return "drive_mode";
+                case Prop::MeteringMode: return "metering_mode";
+                case Prop::ISO: return "iso";
+                case Prop::Av: return "av";
+                case Prop::Tv: return "tv";
+                case Prop::ExposureCompensation: return "exposure_compensation";
+                default: return nullptr;
+            }
+        }
+
+        constexpr std::size_t depth_of(Prop p) {
+            std::size_t depth = 0;
+            for (const auto &dependency : DEPENDENCIES) {
+                if (dependency.child == p) {
+                    depth = std::max(depth, depth_of(dependency.parent) + 1);
+                }
+            }
+            return depth;
+        }
+
+        constexpr std::array<Prop, PROPERTY_COUNT> make_write_order() {
+            std::array<Prop, PROPERTY_COUNT> res{};
+            for (std::size_t i = 0; i < PROPERTY_COUNT; i++) {
+                res[i] = static_cast<Prop>(i);
+            }
+            //stable insertion sort by depth keeps slot order within a level
+            for (std::size_t i = 1; i < PROPERTY_COUNT; i++) {
+                for (std::size_t j = i; j > 0 && depth_of(res[j - 1]) > depth_of(res[j]); j--) {
+                    auto tmp = res[j];
+                    res[j] = res[j - 1];
+                    res[j - 1] = tmp;
+                }
+            }
+            return res;
+        }
+
+        constexpr auto WRITE_ORDER = make_write_order();
+
+        constexpr bool parents_first() {
+            for (const auto &dependency : DEPENDENCIES) {
+                std::size_t parent = PROPERTY_COUNT, child = PROPERTY_COUNT;
+                for (std::size_t i = 0; i < PROPERTY_COUNT; i++) {
+                    if (WRITE_ORDER[i] == dependency.parent) parent = i;
+                    if (WRITE_ORDER[i] == dependency.child) child = i;
+                }
+                if (parent >= child) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        static_assert(parents_first(), "property dependencies must not form a cycle");
+
+        const Dependency *dependency_of(Prop p) {
+            for (const auto &dependency : DEPENDENCIES) {
+                if (dependency.child == p) {
+                    return &dependency;
+                }
+            }
+            return nullptr;
+        }
+
+        std::optional<Prop> prop_by_name(const std::string &name) {
+            for (std::size_t slot = 0; slot < PROPERTY_COUNT; slot++) {
+                auto p = static_cast<Prop>(slot);
+                if (name_of(p) && name == name_of(p)) {
+                    return p;
+                }
+            }
+            return std::nullopt;
+        }
+    }
+
+    bool load_profiles(const std::string &path, std::vector<SettingsProfile> &profiles) {
+        std::ifstream file{path};
+        if (!file) {
+            return false;
+        }
+
+        profiles.clear();
+        for (std::string line; std::getline(file, line);) {
+            line = line.substr(0, line.find('#'));
+            std::istringstream iss{line};
+            SettingsProfile profile{};
+            if (!(iss >> profile.name)) {
+                continue;
+            }
+
+            for (std::string item; iss >> item;) {
+                auto eq = item.find('=');
+                auto p = eq == std::string::npos ? std::nullopt : prop_by_name(item.substr(0, eq));
+                if (!p) {
+                    return false;
+                }
+                char *end = nullptr;
+                auto value = std::strtoul(item.c_str() + eq + 1, &end, 0);
+                if (end == item.c_str() + eq + 1 || *end != '\0') {
+                    return false;
+                }
+                profile.values[property_table::slot(*p)] = static_cast<std::uint32_t>(value);
+            }
+            profiles.push_back(std::move(profile));
+        }
+        return true;
+    }
+
+    bool save_profiles(const std::string &path, const std::vector<SettingsProfile> &profiles) {
+        std::ofstream file{path, std::ios::trunc};
+        for (const auto &profile : profiles) {
+            file << profile.name;
+            for (std::size_t slot = 0; slot < PROPERTY_COUNT; slot++) {
+                auto name = name_of(static_cast<Prop>(slot));
+                if (name && profile.values[slot]) {
+                    file << ' ' << name << "=0x" << std::hex << *profile.values[slot] << std::dec;
+                }
+            }
+            file << '\n';
+        }
+        return static_cast<bool>(file);
+    }
+
+    SettingsProfile snapshot_profile(const EDSDK::Camera &camera, const std::string &name) {
+        SettingsProfile res{};
+        res.name = name;
+        for (std::size_t slot = 0; slot < PROPERTY_COUNT; slot++) {
+            if (name_of(static_cast<Prop>(slot))) {
+                res.values[slot] = camera.get_property_value(property_table::IDS[slot]);
+            }
+        }
+        return res;
+    }
+
+    ProfileEngine::ProfileEngine(EDSDK::Camera &camera, std::chrono::milliseconds constraint_timeout) :
+            _camera{camera},
+            _constraint_timeout{constraint_timeout} {}
+
+    ProfileEngine::Result ProfileEngine::apply(const SettingsProfile &profile) {
+        auto start = std::chrono::steady_clock::now();
+        Result res{};
+        res.ok = true;
+
+        auto target_of = [this, &profile](Prop p) {
+            auto slot = property_table::slot(p);
+            return profile.values[slot] ? profile.values[slot] : _camera.get_property_value(property_table::IDS[slot]);
+        };
+
+        //conditions first, nothing is written for a camera in wrong state
+        for (std::size_t slot = 0; slot < PROPERTY_COUNT && res.ok; slot++) {
+            auto prop_id = property_table::IDS[slot];
+            auto target = profile.values[slot];
+            if (property_table::SETTABLE[slot] || !target) {
+                continue;
+            }
+            auto current = _camera.get_property_value(prop_id);
+            if (current != target) {
+                res.ok = false;
+                res.error = std::string{name_of(static_cast<Prop>(slot))} + " is " +
+                            EDSDK::explain_prop_value(prop_id, current.value_or(0)) + ", profile needs " +
+                            EDSDK::explain_prop_value(prop_id, *target);
+            } else {
+                res.unchanged++;
+            }
+        }
+
+        for (auto p : WRITE_ORDER) {
+            auto slot = property_table::slot(p);
+            auto prop_id = property_table::IDS[slot];
+            auto target = profile.values[slot];
+            if (!res.ok || !property_table::SETTABLE[slot] || !target) {
+                continue;
+            }
+
+            auto dependency = dependency_of(p);
+            if (dependency && dependency->gate != NO_GATE && target_of(dependency->parent) != dependency->gate) {
+                res.gated++;
+                continue;
+            }
+            if (_camera.get_property_value(prop_id) == target) {
+                res.unchanged++;
+                continue;
+            }
+
+            //constraints of a dependent property arrive with a change event after parent is written
+            auto constraints = _camera.get_property_constraint_values(prop_id);
+            if (std::find(constraints.begin(), constraints.end(), *target) == constraints.end() &&
+                (dependency || constraints.empty())) {
+                res.constraint_waits++;
+                _wait_for_constraint(prop_id, *target);
+                constraints = _camera.get_property_constraint_values(prop_id);
+            }
+
+            auto it = std::find(constraints.begin(), constraints.end(), *target);
+            if (it == constraints.end()) {
+                res.ok = false;
+                res.error = std::string{name_of(p)} + " " + EDSDK::explain_prop_value(prop_id, *target) +
+                            " is not allowed now";
+            } else if (!_camera.set_property(prop_id, static_cast<std::uint32_t>(it - constraints.begin()))) {
+                res.ok = false;
+                res.error = std::string{name_of(p)} + " was rejected by camera";
+            } else {
+                res.writes++;
+            }
+        }
+
+        res.apply_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return res;
+    }
+
+    const std::array<Prop, PROPERTY_COUNT> &ProfileEngine::write_order() {
+        return WRITE_ORDER;
+    }
+
+    bool ProfileEngine::_wait_for_constraint(EdsPropertyID prop_id, std::uint32_t value) {
+        return _camera.wait_for_property(prop_id, [value](std::uint32_t, const std::vector<std::uint32_t> &constraints) {
+            return std::find(constraints.begin(), constraints.end(), value) != constraints.end();
+        }, _constraint_timeout);
+    }
+} //namespace edsdk_w
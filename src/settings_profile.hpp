@@ -0,0 +1,59 @@
+#ifndef SETTINGS_PROFILE_HPP
+#define SETTINGS_PROFILE_HPP
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+#include "edsdk_wrapper.hpp"
+#include "property_traits.hpp"
+
+namespace edsdk_w {
+    //named set of numeric property values, properties without value are left as they are;
+    //read-only ones are conditions the camera has to meet, e.g. position of the mode dial
+    struct SettingsProfile {
+        std::string name;
+        std::array<std::optional<std::uint32_t>, PROPERTY_COUNT> values;
+    };
+
+    //one profile per line: "<name> <property>=<raw value> ...", '#' starts a comment
+    bool load_profiles(const std::string &path, std::vector<SettingsProfile> &profiles);
+    bool save_profiles(const std::string &path, const std::vector<SettingsProfile> &profiles);
+
+    //current values of all numeric properties
+    SettingsProfile snapshot_profile(const EDSDK::Camera &camera, const std::string &name);
+
+    //applies profiles writing only properties that differ, parents before properties depending on them
+    class ProfileEngine {
+    public:
+        struct Result {
+            bool ok;
+            std::string error;
+            std::uint32_t writes;
+            std::uint32_t unchanged;
+            std::uint32_t gated;            //not applicable with target value of parent
+            std::uint32_t constraint_waits; //waits for constraints to follow a parent
+            double apply_ms;
+        };
+
+        explicit ProfileEngine(EDSDK::Camera &camera,
+                               std::chrono::milliseconds constraint_timeout = std::chrono::milliseconds{1000});
+
+        //must be called from the thread pumping EDSDK::events(), constraints are awaited with wait_for_property()
+        Result apply(const SettingsProfile &profile);
+
+        //every property comes after the ones it depends on
+        static const std::array<Prop, PROPERTY_COUNT> &write_order();
+
+    private:
+        //waits until value shows up in constraints of property
+        bool _wait_for_constraint(EdsPropertyID prop_id, std::uint32_t value);
+
+        EDSDK::Camera &_camera;
+        std::chrono::milliseconds _constraint_timeout;
+    };
+} //namespace edsdk_w
+
+#endif //SETTINGS_PROFILE_HPP
@@ -0,0 +1,296 @@
+#include "storage_browser.hpp"
+
+#include <EDSDK.h>
+#include <EDSDKErrors.h>
+
+#include <cstring>
+#include <sstream>
+
+namespace edsdk_w {
+    namespace {
+        //SDK names are not terminated when they fill the whole array
+        template<std::size_t N>
+        std::string sdk_name(const EdsChar (&src)[N]) {
+            return {src, strnlen(src, N)};
+        }
+    }
+
+    StorageBrowser::StorageBrowser(EdsCameraRef camera) : _created_generation{0},
+                                                           _changed_generation{0},
+                                                           _stats{} {
+        //root node holds camera reference, which is owned by camera wrapper
+        Node root{};
+        root.ref = camera;
+        root.parent = NONE;
+        root.folder = true;
+        root.alive = true;
+        root.child_count = -1;
+        _nodes.push_back(root);
+    }
+
+    StorageBrowser::~StorageBrowser() {
+        clear();
+    }
+
+    bool StorageBrowser::list(const std::string &path,
+                              std::size_t offset,
+                              std::size_t limit,
+                              std::vector<StorageEntry> &page,
+                              std::size_t *total) {
+        page.clear();
+        auto folder = _resolve(path);
+        if (folder == NONE || !_nodes[folder].folder || !_expand(folder)) {
+            return false;
+        }
+
+        auto count = static_cast<std::size_t>(_nodes[folder].child_count);
+        if (total) {
+            *total = count;
+        }
+        for (auto i = offset; i < count && page.size() < limit; i++) {
+            auto child = _child(folder, i);
+            if (child != NONE) {
+                page.push_back(_entry(child));
+            }
+        }
+        return true;
+    }
+
+    bool StorageBrowser::newest_files(std::size_t offset, std::size_t limit, std::vector<StorageEntry> &page) {
+        page.clear();
+        if (!_expand(ROOT)) {
+            return false;
+        }
+        if (limit == 0) {
+            return true;
+        }
+
+        //DCF numbering keeps newest folder and newest file last, volumes are walked in camera order
+        std::size_t skipped = 0;
+        for (std::size_t v = 0; v < static_cast<std::size_t>(_nodes[ROOT].child_count); v++) {
+            auto volume = _child(ROOT, v);
+            auto dcim = volume == NONE ? NONE : _find_child(volume, "DCIM");
+            if (dcim == NONE || !_expand(dcim)) continue;
+
+            for (auto f = _nodes[dcim].child_count - 1; f >= 0; f--) {
+                auto folder = _child(dcim, static_cast<std::size_t>(f));
+                if (folder == NONE || !_nodes[folder].folder || !_expand(folder)) continue;
+
+                for (auto i = _nodes[folder].child_count - 1; i >= 0; i--) {
+                    auto file = _child(folder, static_cast<std::size_t>(i));
+                    if (file == NONE || _nodes[file].folder) continue;
+
+                    if (skipped < offset) {
+                        skipped++;
+                        continue;
+                    }
+                    page.push_back(_entry(file));
+                    if (page.size() >= limit) {
+                        return true;
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+    void StorageBrowser::on_object_event(EdsObjectEvent event) {
+        switch (event) {
+            case kEdsObjectEvent_DirItemCreated:
+                //new captures are appended, cached items keep their positions
+                _created_generation++;
+                break;
+            case kEdsObjectEvent_DirItemRemoved:
+            case kEdsObjectEvent_DirItemInfoChanged:
+            case kEdsObjectEvent_DirItemContentChanged:
+            case kEdsObjectEvent_FolderUpdateItems:
+                _changed_generation++;
+                break;
+            case kEdsObjectEvent_VolumeInfoChanged:
+            case kEdsObjectEvent_VolumeUpdateItems:
+                clear();
+                break;
+            default:
+                return;
+        }
+        _stats.invalidations++;
+    }
+
+    void StorageBrowser::clear() {
+        for (std::size_t i = ROOT + 1; i < _nodes.size(); i++) {
+            if (_nodes[i].alive) {
+                EdsRelease(_nodes[i].ref);
+            }
+        }
+        _nodes.resize(ROOT + 1);
+        _nodes[ROOT].children.clear();
+        _nodes[ROOT].child_count = -1;
+        _free_nodes.clear();
+    }
+
+    EdsDirectoryItemRef StorageBrowser::item(const std::string &path) {
+        auto node = _resolve(path);
+        if (node == NONE || _nodes[node].folder) {
+            return nullptr;
+        }
+        return _nodes[node].ref;
+    }
+
+    StorageBrowser::Stats StorageBrowser::stats() const {
+        auto res = _stats;
+        res.cached_items = _nodes.size() - 1 - _free_nodes.size();
+        return res;
+    }
+
+    bool StorageBrowser::_expand(std::uint32_t folder) {
+        auto &node = _nodes[folder];
+        if (node.child_count >= 0) {
+            if (node.changed_generation != _changed_generation) {
+                _drop_children(folder);
+            } else if (node.created_generation != _created_generation) {
+                EdsUInt32 count = 0;
+                if (EdsGetChildCount(node.ref, &count) != EDS_ERR_OK) {
+                    return false;
+                }
+                _stats.sdk_fetches++;
+                if (count < node.children.size()) {
+                    _drop_children(folder);
+                } else {
+                    node.children.resize(count, NONE);
+                    node.child_count = count;
+                    node.created_generation = _created_generation;
+                    return true;
+                }
+            } else {
+                _stats.cache_hits++;
+                return true;
+            }
+        }
+
+        EdsUInt32 count = 0;
+        if (EdsGetChildCount(node.ref, &count) != EDS_ERR_OK) {
+            return false;
+        }
+        _stats.sdk_fetches++;
+        node.child_count = count;
+        node.children.assign(count, NONE);
+        node.created_generation = _created_generation;
+        node.changed_generation = _changed_generation;
+        return true;
+    }
+
+    std::uint32_t StorageBrowser::_child(std::uint32_t folder, std::size_t index) {
+        if (index >= _nodes[folder].children.size()) {
+            return NONE;
+        }
+        if (_nodes[folder].children[index] != NONE) {
+            _stats.cache_hits++;
+            return _nodes[folder].children[index];
+        }
+
+        EdsBaseRef ref = nullptr;
+        if (EdsGetChildAtIndex(_nodes[folder].ref, static_cast<EdsInt32>(index), &ref) != EDS_ERR_OK) {
+            return NONE;
+        }
+
+        Node child{};
+        child.ref = ref;
+        child.parent = folder;
+        child.alive = true;
+        child.child_count = -1;
+
+        EdsError err = EDS_ERR_OK;
+        if (folder == ROOT) {
+            EdsVolumeInfo info;
+            err = EdsGetVolumeInfo(ref, &info);
+            if (err == EDS_ERR_OK) {
+                child.folder = true;
+                child.size = info.maxCapacity;
+                child.name = sdk_name(info.szVolumeLabel);
+            }
+        } else {
+            EdsDirectoryItemInfo info;
+            err = EdsGetDirectoryItemInfo(ref, &info);
+            if (err == EDS_ERR_OK) {
+                child.folder = info.isFolder;
+                child.size = info.size;
+                child.date_time = info.dateTime;
+                child.format = info.format;
+                child.name = sdk_name(info.szFileName);
+            }
+        }
+        if (err != EDS_ERR_OK) {
+            EdsRelease(ref);
+            return NONE;
+        }
+        _stats.sdk_fetches++;
+
+        auto node = _allocate();
+        _nodes[node] = std::move(child);
+        _nodes[folder].children[index] = node;
+        return node;
+    }
+
+    std::uint32_t StorageBrowser::_find_child(std::uint32_t folder, const std::string &name) {
+        if (!_expand(folder)) {
+            return NONE;
+        }
+        for (std::size_t i = 0; i < static_cast<std::size_t>(_nodes[folder].child_count); i++) {
+            auto child = _child(folder, i);
+            if (child != NONE && name == _nodes[child].name) {
+                return child;
+            }
+        }
+        return NONE;
+    }
+
+    std::uint32_t StorageBrowser::_resolve(const std::string &path) {
+        auto node = ROOT;
+        std::istringstream iss{path};
+        std::string component;
+        while (node != NONE && std::getline(iss, component, '/')) {
+            if (component.empty()) continue;
+            if (!_nodes[node].folder) return NONE;
+            node = _find_child(node, component);
+        }
+        return node;
+    }
+
+    std::string StorageBrowser::_path(std::uint32_t node) const {
+        std::string res{};
+        for (; node != ROOT && node != NONE; node = _nodes[node].parent) {
+            res = res.empty() ? _nodes[node].name : _nodes[node].name + "/" + res;
+        }
+        return res;
+    }
+
+    StorageEntry StorageBrowser::_entry(std::uint32_t node) const {
+        const auto &n = _nodes[node];
+        return {_path(node), n.size, n.date_time, n.format, n.folder};
+    }
+
+    std::uint32_t StorageBrowser::_allocate() {
+        if (!_free_nodes.empty()) {
+            auto node = _free_nodes.back();
+            _free_nodes.pop_back();
+            return node;
+        }
+        _nodes.emplace_back();
+        return static_cast<std::uint32_t>(_nodes.size() - 1);
+    }
+
+    void StorageBrowser::_drop_children(std::uint32_t folder) {
+        auto children = std::move(_nodes[folder].children);
+        for (auto child : children) {
+            if (child == NONE) continue;
+            if (_nodes[child].folder) {
+                _drop_children(child);
+            }
+            EdsRelease(_nodes[child].ref);
+            _nodes[child].alive = false;
+            _free_nodes.push_back(child);
+        }
+        _nodes[folder].children.clear();
+        _nodes[folder].child_count = -1;
+    }
+} //namespace edsdk_w
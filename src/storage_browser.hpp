@@ -0,0 +1,107 @@
+#ifndef STORAGE_BROWSER_HPP
+#define STORAGE_BROWSER_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "EDSDKTypes.h"
+
+namespace edsdk_w {
+    struct StorageEntry {
+        //"<volume label>/DCIM/100CANON/IMG_0001.CR3"
+        std::string path;
+        std::uint64_t size;
+        std::uint32_t date_time;
+        std::uint32_t format;
+        bool folder;
+    };
+
+    //browses camera card lazily: a folder is expanded when first listed, item info is fetched
+    //only for the page that is asked for and kept in an index invalidated by object events
+    class StorageBrowser {
+    public:
+        struct Stats {
+            std::uint64_t sdk_fetches;
+            std::uint64_t cache_hits;
+            std::uint64_t invalidations;
+            std::size_t cached_items;
+        };
+
+        explicit StorageBrowser(EdsCameraRef camera);
+        ~StorageBrowser();
+
+        StorageBrowser(const StorageBrowser &) = delete;
+        StorageBrowser &operator=(const StorageBrowser &) = delete;
+
+        //empty path lists volumes; total receives number of items in folder
+        bool list(const std::string &path,
+                  std::size_t offset,
+                  std::size_t limit,
+                  std::vector<StorageEntry> &page,
+                  std::size_t *total = nullptr);
+
+        //files of DCIM folders, newest first, without expanding older folders than needed
+        bool newest_files(std::size_t offset, std::size_t limit, std::vector<StorageEntry> &page);
+
+        //directory item of file, owned by browser and valid until next object event
+        EdsDirectoryItemRef item(const std::string &path);
+
+        //called from camera object event handler
+        void on_object_event(EdsObjectEvent event);
+
+        //drops whole index
+        void clear();
+
+        [[nodiscard]] Stats stats() const;
+
+    private:
+        static constexpr std::uint32_t NONE = 0xffffffff;
+        static constexpr std::uint32_t ROOT = 0;
+
+        struct Node {
+            EdsBaseRef ref;
+            std::uint32_t parent;
+            std::uint64_t size;
+            std::uint32_t date_time;
+            std::uint32_t format;
+            bool folder;
+            bool alive;
+            std::string name; //file name or volume label
+
+            //folder state, child_count < 0 until expanded
+            std::int64_t child_count;
+            std::uint64_t created_generation;
+            std::uint64_t changed_generation;
+            std::vector<std::uint32_t> children;
+        };
+
+        //brings child count of folder up to date with object events seen since it was expanded
+        bool _expand(std::uint32_t folder);
+
+        //node of child at index, fetching its info on first access
+        std::uint32_t _child(std::uint32_t folder, std::size_t index);
+
+        std::uint32_t _find_child(std::uint32_t folder, const std::string &name);
+
+        std::uint32_t _resolve(const std::string &path);
+
+        std::string _path(std::uint32_t node) const;
+
+        StorageEntry _entry(std::uint32_t node) const;
+
+        std::uint32_t _allocate();
+
+        void _drop_children(std::uint32_t folder);
+
+        std::vector<Node> _nodes;
+        std::vector<std::uint32_t> _free_nodes;
+
+        //bumped by object events, folders compare them with generations seen at expansion
+        std::uint64_t _created_generation;
+        std::uint64_t _changed_generation;
+
+        Stats _stats;
+    };
+} //namespace edsdk_w
+
+#endif //STORAGE_BROWSER_HPP
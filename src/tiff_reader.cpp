@@ -0,0 +1,103 @@
+#include "tiff_reader.hpp"
+
+#include <cstring>
+
+namespace edsdk_w {
+    TiffReader::TiffReader(const std::uint8_t *base, std::size_t size) : _base{base},
+                                                                          _size{size},
+                                                                          _little_endian{true},
+                                                                          _first_ifd{0} {}
+
+    bool TiffReader::read_header() {
+        if (_size < 8) return false;
+        if (_base[0] == 'I' && _base[1] == 'I') {
+            _little_endian = true;
+        } else if (_base[0] == 'M' && _base[1] == 'M') {
+            _little_endian = false;
+        } else {
+            return false;
+        }
+        if (u16(2) != 42) return false;
+        _first_ifd = u32(4);
+        return true;
+    }
+
+    std::optional<std::uint32_t> TiffReader::integer(const Entry &entry) const {
+        if (entry.count == 0 || entry.value_offset + _value_size(entry) > _size) return std::nullopt;
+        switch (entry.type) {
+            case Short: return u16(entry.value_offset);
+            case Long: return u32(entry.value_offset);
+            default: return std::nullopt;
+        }
+    }
+
+    std::optional<double> TiffReader::rational(const Entry &entry) const {
+        if (entry.count == 0 || entry.value_offset + 8 > _size) return std::nullopt;
+        if (entry.type != Rational && entry.type != SRational) return std::nullopt;
+
+        auto numerator = u32(entry.value_offset);
+        auto denominator = u32(entry.value_offset + 4);
+        if (denominator == 0) return std::nullopt;
+        if (entry.type == SRational) {
+            return static_cast<double>(static_cast<std::int32_t>(numerator)) / static_cast<std::int32_t>(denominator);
+        }
+        return static_cast<double>(numerator) / denominator;
+    }
+
+    std::string TiffReader::text(const Entry &entry) const {
+        if (entry.type != Ascii || entry.value_offset + entry.count > _size) return {};
+
+        std::string res(reinterpret_cast<const char *>(_base + entry.value_offset), entry.count);
+        while (!res.empty() && (res.back() == '\0' || res.back() == ' ')) {
+            res.pop_back();
+        }
+        auto end = res.find('\0');
+        return end == std::string::npos ? res : res.substr(0, end);
+    }
+
+    std::uint16_t TiffReader::u16(std::size_t at) const {
+        auto p = _base + at;
+        return _little_endian ? static_cast<std::uint16_t>(p[0] | p[1] << 8)
+                              : static_cast<std::uint16_t>(p[0] << 8 | p[1]);
+    }
+
+    std::uint32_t TiffReader::u32(std::size_t at) const {
+        auto p = _base + at;
+        auto b0 = static_cast<std::uint32_t>(p[0]), b1 = static_cast<std::uint32_t>(p[1]);
+        auto b2 = static_cast<std::uint32_t>(p[2]), b3 = static_cast<std::uint32_t>(p[3]);
+        return _little_endian ? b0 | b1 << 8 | b2 << 16 | b3 << 24
+                              : b0 << 24 | b1 << 16 | b2 << 8 | b3;
+    }
+
+    std::size_t TiffReader::_value_size(const Entry &entry) const {
+        std::size_t unit = 1;
+        switch (entry.type) {
+            case Short: unit = 2; break;
+            case Long: unit = 4; break;
+            case Rational:
+            case SRational: unit = 8; break;
+            default: break;
+        }
+        return unit * entry.count;
+    }
+
+    bool find_jpeg_exif(const std::uint8_t *data, std::size_t size, std::size_t &tiff_offset, std::size_t &tiff_size) {
+        if (size < 4 || data[0] != 0xff || data[1] != 0xd8) return false;
+
+        std::size_t pos = 2;
+        while (pos + 4 <= size && data[pos] == 0xff) {
+            auto marker = data[pos + 1];
+            std::size_t length = static_cast<std::size_t>(data[pos + 2]) << 8 | data[pos + 3];
+            if (marker == 0xda || length < 2) break; //start of scan, no more metadata
+
+            if (marker == 0xe1 && length >= 8 && pos + 2 + length <= size &&
+                std::memcmp(data + pos + 4, "Exif\0\0", 6) == 0) {
+                tiff_offset = pos + 10;
+                tiff_size = length - 8;
+                return true;
+            }
+            pos += 2 + length;
+        }
+        return false;
+    }
+} //namespace edsdk_w
@@ -0,0 +1,83 @@
+#ifndef TIFF_READER_HPP
+#define TIFF_READER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace edsdk_w {
+    //bounds checked reader of a TIFF structure held in memory, used for CR2, EXIF and CR3 CMT boxes
+    class TiffReader {
+    public:
+        enum Type : std::uint16_t {
+            Byte = 1,
+            Ascii = 2,
+            Short = 3,
+            Long = 4,
+            Rational = 5,
+            Undefined = 7,
+            SRational = 10
+        };
+
+        struct Entry {
+            std::uint16_t tag;
+            std::uint16_t type;
+            std::uint32_t count;
+            //offset of value or of inline value field, relative to TIFF start
+            std::size_t value_offset;
+        };
+
+        TiffReader(const std::uint8_t *base, std::size_t size);
+
+        //parses byte order mark, returns false if data is not TIFF
+        bool read_header();
+
+        [[nodiscard]] std::uint32_t first_ifd() const { return _first_ifd; }
+
+        //calls visitor for every entry of ifd, returns offset of next ifd or 0
+        template <typename Visitor>
+        std::uint32_t for_each_entry(std::uint32_t ifd, Visitor &&visitor) const {
+            //offsets come from the file, widened before adding so 0xfffffffe cannot wrap past the check
+            std::size_t start = ifd;
+            if (start == 0 || start + 2 > _size) return 0;
+            std::size_t count = u16(start);
+            if (start + 2 + count * 12 + 4 > _size) return 0;
+
+            for (std::size_t i = 0; i < count; i++) {
+                std::size_t at = start + 2 + i * 12;
+                Entry entry{u16(at), u16(at + 2), u32(at + 4), at + 8};
+                if (_value_size(entry) > 4) {
+                    entry.value_offset = u32(at + 8);
+                }
+                visitor(entry);
+            }
+            return u32(start + 2 + count * 12);
+        }
+
+        //first value of a Short or Long entry
+        [[nodiscard]] std::optional<std::uint32_t> integer(const Entry &entry) const;
+
+        //first value of a Rational or SRational entry
+        [[nodiscard]] std::optional<double> rational(const Entry &entry) const;
+
+        //Ascii entry without trailing zeros and spaces
+        [[nodiscard]] std::string text(const Entry &entry) const;
+
+        [[nodiscard]] std::uint16_t u16(std::size_t at) const;
+        [[nodiscard]] std::uint32_t u32(std::size_t at) const;
+
+    private:
+        [[nodiscard]] std::size_t _value_size(const Entry &entry) const;
+
+        const std::uint8_t *_base;
+        std::size_t _size;
+        bool _little_endian;
+        std::uint32_t _first_ifd;
+    };
+
+    //locates TIFF structure of EXIF APP1 segment in a jpeg file
+    bool find_jpeg_exif(const std::uint8_t *data, std::size_t size, std::size_t &tiff_offset, std::size_t &tiff_size);
+} //namespace edsdk_w
+
+#endif //TIFF_READER_HPP
@@ -0,0 +1,127 @@
+#include "work_stealing_pool.hpp"
+
+#include <algorithm>
+
+namespace utils {
+    namespace {
+        thread_local const WorkStealingPool *current_pool = nullptr;
+        thread_local std::size_t current_index = 0;
+    }
+
+    WorkStealingPool::WorkStealingPool(std::size_t threads) : _queued{0},
+                                                              _unfinished{0},
+                                                              _stopping{false},
+                                                              _next_queue{0},
+                                                              _executed{0},
+                                                              _stolen{0} {
+        if (threads == 0) {
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        for (std::size_t i = 0; i < threads; i++) {
+            _queues.push_back(std::make_unique<Queue>());
+        }
+        for (std::size_t i = 0; i < threads; i++) {
+            _threads.emplace_back(&WorkStealingPool::_worker, this, i);
+        }
+    }
+
+    WorkStealingPool::~WorkStealingPool() {
+        wait_idle();
+        {
+            std::lock_guard lock{_mutex};
+            _stopping = true;
+        }
+        _wake.notify_all();
+
+        for (auto &thread : _threads) {
+            thread.join();
+        }
+    }
+
+    void WorkStealingPool::submit(std::function<void()> task) {
+        auto index = current_pool == this ? current_index : _next_queue++ % _queues.size();
+        {
+            std::lock_guard lock{_queues[index]->mutex};
+            _queues[index]->tasks.push_back(std::move(task));
+        }
+        {
+            std::lock_guard lock{_mutex};
+            _queued++;
+            _unfinished++;
+        }
+        _wake.notify_one();
+    }
+
+    void WorkStealingPool::wait_idle() {
+        std::unique_lock lock{_mutex};
+        _idle.wait(lock, [this] { return _unfinished == 0; });
+    }
+
+    std::size_t WorkStealingPool::thread_count() const {
+        return _threads.size();
+    }
+
+    WorkStealingPool::Stats WorkStealingPool::stats() const {
+        return {_executed.load(std::memory_order_relaxed), _stolen.load(std::memory_order_relaxed)};
+    }
+
+    void WorkStealingPool::_worker(std::size_t index) {
+        current_pool = this;
+        current_index = index;
+
+        std::function<void()> task{};
+        while (true) {
+            {
+                std::unique_lock lock{_mutex};
+                _wake.wait(lock, [this] { return _queued > 0 || _stopping; });
+                if (_queued == 0) {
+                    return;
+                }
+                //claiming a task here guarantees one of the deques holds it
+                _queued--;
+            }
+
+            while (!_take(index, task)) {
+                std::this_thread::yield();
+            }
+            task();
+            task = nullptr;
+            _executed.fetch_add(1, std::memory_order_relaxed);
+
+            bool idle;
+            {
+                std::lock_guard lock{_mutex};
+                idle = --_unfinished == 0;
+            }
+            if (idle) {
+                _idle.notify_all();
+            }
+        }
+    }
+
+    bool WorkStealingPool::_take(std::size_t index, std::function<void()> &task) {
+        {
+            auto &own = *_queues[index];
+            std::lock_guard lock{own.mutex};
+            if (!own.tasks.empty()) {
+                task = std::move(own.tasks.back());
+                own.tasks.pop_back();
+                return true;
+            }
+        }
+
+        for (std::size_t i = 1; i < _queues.size(); i++) {
+            auto &victim = *_queues[(index + i) % _queues.size()];
+            std::lock_guard lock{victim.mutex};
+            if (!victim.tasks.empty()) {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                _stolen.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+
+        return false;
+    }
+} //namespace utils
@@ -0,0 +1,69 @@
+#ifndef WORK_STEALING_POOL_HPP
+#define WORK_STEALING_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace utils {
+    //thread pool with a task deque per worker, a worker runs its own tasks newest first
+    //and steals the oldest task of another worker when its deque is empty
+    class WorkStealingPool {
+    public:
+        struct Stats {
+            std::uint64_t executed;
+            std::uint64_t stolen;
+        };
+
+        //0 threads means one per hardware thread
+        explicit WorkStealingPool(std::size_t threads = 0);
+
+        //runs remaining tasks before joining workers
+        ~WorkStealingPool();
+
+        WorkStealingPool(const WorkStealingPool &) = delete;
+        WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+        //tasks submitted from a worker go to its own deque, others are spread round-robin
+        void submit(std::function<void()> task);
+
+        //blocks until every submitted task has finished
+        void wait_idle();
+
+        [[nodiscard]] std::size_t thread_count() const;
+
+        [[nodiscard]] Stats stats() const;
+
+    private:
+        struct Queue {
+            std::mutex mutex;
+            std::deque<std::function<void()>> tasks;
+        };
+
+        void _worker(std::size_t index);
+
+        bool _take(std::size_t index, std::function<void()> &task);
+
+        std::vector<std::unique_ptr<Queue>> _queues;
+        std::vector<std::thread> _threads;
+
+        std::mutex _mutex;
+        std::condition_variable _wake;
+        std::condition_variable _idle;
+        std::size_t _queued;
+        std::size_t _unfinished;
+        bool _stopping;
+
+        std::atomic<std::size_t> _next_queue;
+        std::atomic<std::uint64_t> _executed;
+        std::atomic<std::uint64_t> _stolen;
+    };
+} //namespace utils
+
+#endif //WORK_STEALING_POOL_HPP